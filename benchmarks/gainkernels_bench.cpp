@@ -0,0 +1,81 @@
+// ゲイン処理のマイクロベンチマーク (サンプル/秒)
+// - 以前の amplifyEffect のループ (S16 を1サンプルずつ float で掛けて分岐でクリップ) と GainKernels を比べる
+// - バッファは出力デバイスと同じ大きさ (2048 フレーム × 2ch) を使い回す
+// ビルド: cmake -DQSV_BUILD_BENCHMARKS=ON
+#include "gainkernels.h"
+#include <QElapsedTimer>
+#include <QVector>
+#include <QtGlobal>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+const int FRAMES = 2048;
+const int CHANNELS = 2;
+const int SAMPLES = FRAMES * CHANNELS;
+const int ITERATIONS = 20000;
+
+// 以前の実装 (比較用にそのまま残す)
+void legacyApplyS16(qint16 *samples, int count, float gain)
+{
+    for (int i = 0; i < count; ++i) {
+        float amplifiedSample = samples[i] * gain;
+        if (amplifiedSample > 32767) amplifiedSample = 32767;
+        else if (amplifiedSample < -32768) amplifiedSample = -32768;
+        samples[i] = static_cast<qint16>(amplifiedSample);
+    }
+}
+
+template <typename T>
+QVector<T> makeBuffer(T scale)
+{
+    QVector<T> buffer(SAMPLES);
+    std::srand(1);
+    for (int i = 0; i < SAMPLES; ++i) buffer[i] = T((std::rand() / double(RAND_MAX) * 2.0 - 1.0) * scale);
+    return buffer;
+}
+
+// 毎回元のバッファから始めるとコピーの時間が混ざるので、ゲインを上下させて値が潰れないようにする
+template <typename Apply>
+double measure(const char *name, Apply apply)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (int n = 0; n < ITERATIONS; ++n) apply(n);
+    const double seconds = timer.nsecsElapsed() / 1e9;
+    const double rate = double(SAMPLES) * ITERATIONS / seconds;
+    std::printf("%-24s %8.1f Msamples/s\n", name, rate / 1e6);
+    return rate;
+}
+}
+
+int main()
+{
+    QVector<qint16> s16 = makeBuffer<qint16>(32767);
+    QVector<qint32> s32 = makeBuffer<qint32>(2147483000);
+    QVector<float> f32 = makeBuffer<float>(1.0f);
+    const float gains[2] = { 0.5f, 2.0f };
+
+    const double legacy = measure("legacy S16 loop", [&](int n) {
+        legacyApplyS16(s16.data(), SAMPLES, gains[n & 1]);
+    });
+    const double s16Rate = measure("GainKernels S16", [&](int n) {
+        GainKernels::applyS16(s16.data(), SAMPLES, CHANNELS, gains[n & 1], gains[n & 1]);
+    });
+    measure("GainKernels S16 (ramp)", [&](int n) {
+        GainKernels::applyS16(s16.data(), SAMPLES, CHANNELS, gains[n & 1], gains[(n + 1) & 1]);
+    });
+    measure("GainKernels S32", [&](int n) {
+        GainKernels::applyS32(s32.data(), SAMPLES, CHANNELS, gains[n & 1], gains[n & 1]);
+    });
+    measure("GainKernels F32", [&](int n) {
+        GainKernels::applyF32(f32.data(), SAMPLES, CHANNELS, gains[n & 1], gains[n & 1]);
+    });
+    std::printf("S16 speedup vs legacy: %.2fx\n", s16Rate / legacy);
+
+    // 最適化で処理が消されないように結果を使う
+    long long checksum = 0;
+    for (int i = 0; i < SAMPLES; ++i) checksum += s16[i] + (s32[i] >> 16) + int(f32[i] * 1000);
+    std::printf("checksum: %lld\n", checksum);
+    return 0;
+}
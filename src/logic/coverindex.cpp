@@ -0,0 +1,134 @@
+#include "coverindex.h"
+#include "filesorter.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+const quint32 INDEX_MAGIC = 0x58444943; // "CIDX"
+const quint32 INDEX_VERSION = 1;
+}
+
+CoverIndex::CoverIndex()
+    : m_dirty(false)
+{
+    m_filePath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/covers.idx";
+    load();
+}
+
+CoverIndex::~CoverIndex()
+{
+    save();
+}
+
+QString CoverIndex::makeKey(const QString &dirPath, SortMode mode, bool ascending)
+{
+    // ソート順が違えば表紙も違う
+    return QDir::cleanPath(QDir(dirPath).absolutePath())
+           + QString("|%1%2").arg(int(mode)).arg(ascending ? 'a' : 'd');
+}
+
+bool CoverIndex::lookup(const QString &dirPath, const QDateTime &dirModified, SortMode mode, bool ascending, Cover *cover)
+{
+    // シャッフルは毎回違う表紙で良いので記録しない
+    if (mode == SortShuffle) return false;
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_records.constFind(makeKey(dirPath, mode, ascending));
+    if (it == m_records.constEnd() || it->dirModified != dirModified) return false;
+
+    if (cover) *cover = it->cover;
+    return true;
+}
+
+void CoverIndex::store(const QString &dirPath, const QDateTime &dirModified, SortMode mode, bool ascending, const Cover &cover)
+{
+    if (mode == SortShuffle || !dirModified.isValid()) return;
+
+    QMutexLocker locker(&m_mutex);
+    // 上限を超えたら作り直す (古い記録の寿命管理まではしない)
+    if (m_records.size() >= MAX_RECORDS) m_records.clear();
+
+    m_records.insert(makeKey(dirPath, mode, ascending), {dirModified, cover});
+    m_dirty = true;
+}
+
+void CoverIndex::load()
+{
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    QDataStream in(&file);
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if (magic != INDEX_MAGIC || version != INDEX_VERSION) return;
+
+    qint32 count = 0;
+    in >> count;
+    m_records.reserve(count);
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString key;
+        Record record;
+        in >> key >> record.dirModified >> record.cover.path >> record.cover.lastModified >> record.cover.size;
+        m_records.insert(key, record);
+    }
+    if (in.status() != QDataStream::Ok) {
+        qDebug() << "CoverIndex: broken index file, ignored" << m_filePath;
+        m_records.clear();
+    }
+}
+
+void CoverIndex::save()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_dirty) return;
+
+    QDir().mkpath(QFileInfo(m_filePath).absolutePath());
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "CoverIndex: failed to save" << m_filePath << file.errorString();
+        return;
+    }
+
+    QDataStream out(&file);
+    out << INDEX_MAGIC << INDEX_VERSION << qint32(m_records.size());
+    for (auto it = m_records.constBegin(); it != m_records.constEnd(); ++it) {
+        out << it.key() << it->dirModified << it->cover.path << it->cover.lastModified << it->cover.size;
+    }
+    if (file.commit()) m_dirty = false;
+}
+
+CoverIndex::Cover CoverIndex::discover(const QString &dirPath, const QStringList &nameFilters, SortMode mode, bool ascending)
+{
+    Cover cover;
+    QDirIterator it(dirPath, nameFilters, QDir::Files);
+
+    // シャッフルならどれが先頭でも良いので、最初に見つかった画像で打ち切る
+    if (mode == SortShuffle) {
+        if (it.hasNext()) {
+            it.next();
+            const QFileInfo info = it.fileInfo();
+            cover = {info.absoluteFilePath(), info.lastModified(), info.size()};
+        }
+        return cover;
+    }
+
+    // それ以外は1回の走査で最小要素だけを追う (全件のリスト化・ソートはしない)
+    const QCollator collator = FileSorter::createCollator();
+    QFileInfo best;
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        if (best.filePath().isEmpty() || FileSorter::lessThan(info, best, mode, ascending, collator)) {
+            best = info;
+        }
+    }
+    if (!best.filePath().isEmpty()) {
+        cover = {best.absoluteFilePath(), best.lastModified(), best.size()};
+    }
+    return cover;
+}
@@ -0,0 +1,53 @@
+#ifndef COVERINDEX_H
+#define COVERINDEX_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+#include "utils/common_types.h"
+
+// フォルダの表紙 (ソート順で先頭の画像) の索引
+// - フォルダの更新日時が変わらない限り、前回見つけた表紙をそのまま使う (再起動後も有効)
+// - 画像のないフォルダも「表紙なし」として記録し、毎回の走査を省く
+// ※ スレッドセーフ (ワーカースレッドからも呼んでよい)
+class CoverIndex
+{
+public:
+    struct Cover {
+        QString path;           // 空なら画像なし
+        QDateTime lastModified; // 表紙画像の更新日時 (サムネイルストアのキー用)
+        qint64 size = 0;
+    };
+
+    CoverIndex();
+    ~CoverIndex();
+
+    // 記録があり、フォルダの更新日時が一致すれば true
+    bool lookup(const QString &dirPath, const QDateTime &dirModified, SortMode mode, bool ascending, Cover *cover);
+    void store(const QString &dirPath, const QDateTime &dirModified, SortMode mode, bool ascending, const Cover &cover);
+    void save();
+
+    // ディレクトリを1回だけ走査して表紙を探す (一覧の作成・ソートはしない)
+    static Cover discover(const QString &dirPath, const QStringList &nameFilters, SortMode mode, bool ascending);
+
+private:
+    struct Record {
+        QDateTime dirModified;
+        Cover cover;
+    };
+
+    void load();
+    static QString makeKey(const QString &dirPath, SortMode mode, bool ascending);
+
+    QMutex m_mutex;
+    QString m_filePath;
+    QHash<QString, Record> m_records;
+    bool m_dirty;
+
+    static const int MAX_RECORDS = 20000;
+};
+
+#endif // COVERINDEX_H
@@ -0,0 +1,196 @@
+#include "directorysnapshotcache.h"
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QTimer>
+#include <QtConcurrent>
+
+DirectorySnapshotCache::DirectorySnapshotCache(QObject *parent)
+    : QObject(parent)
+{
+    m_watcher = new QFileSystemWatcher(this);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &DirectorySnapshotCache::onDirectoryChanged);
+
+    // ファイルコピー中などは変更通知が連続するので、まとめてから再スキャンする
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setSingleShot(true);
+    m_refreshTimer->setInterval(REFRESH_DEBOUNCE_INTERVAL);
+    connect(m_refreshTimer, &QTimer::timeout, this, &DirectorySnapshotCache::refreshPendingDirectories);
+}
+
+void DirectorySnapshotCache::setImageExtensions(const QStringList &extensions)
+{
+    QStringList filters;
+    for (const QString &ext : extensions) filters << "*." + ext;
+    if (filters == m_nameFilters) return;
+
+    m_nameFilters = filters;
+
+    // フィルタが変わったらキャッシュは使えない
+    if (!m_recentPaths.isEmpty()) m_watcher->removePaths(m_recentPaths);
+    m_snapshots.clear();
+    m_recentPaths.clear();
+    m_pendingRefresh.clear();
+}
+
+QString DirectorySnapshotCache::normalizedPath(const QString &dirPath)
+{
+    return QDir::cleanPath(QDir(QDir::fromNativeSeparators(dirPath)).absolutePath());
+}
+
+bool DirectorySnapshotCache::contains(const QString &dirPath) const
+{
+    return m_snapshots.contains(normalizedPath(dirPath));
+}
+
+DirectorySnapshotCache::Snapshot DirectorySnapshotCache::snapshot(const QString &dirPath) const
+{
+    return m_snapshots.value(normalizedPath(dirPath));
+}
+
+void DirectorySnapshotCache::store(const QString &dirPath, const Snapshot &snapshot)
+{
+    const QString key = normalizedPath(dirPath);
+    const bool isNew = !m_snapshots.contains(key);
+    m_snapshots.insert(key, snapshot);
+    touch(key);
+
+    if (isNew) {
+        if (!m_watcher->addPath(key)) {
+            qDebug() << "[DirCache] Failed to watch:" << key;
+        }
+    }
+
+    // 古いものから捨てる (監視数にも上限があるため)
+    while (m_recentPaths.size() > MAX_CACHED_DIRECTORIES) {
+        evict(m_recentPaths.last());
+    }
+}
+
+void DirectorySnapshotCache::touch(const QString &dirPath)
+{
+    m_recentPaths.removeOne(dirPath);
+    m_recentPaths.prepend(dirPath);
+}
+
+void DirectorySnapshotCache::evict(const QString &dirPath)
+{
+    m_recentPaths.removeOne(dirPath);
+    m_snapshots.remove(dirPath);
+    m_pendingRefresh.remove(dirPath);
+    m_watcher->removePath(dirPath);
+}
+
+DirectorySnapshotCache::Snapshot DirectorySnapshotCache::scan(const QString &dirPath, const QStringList &nameFilters,
+                                                              const std::function<bool()> &isCancelled)
+{
+    Snapshot result;
+    int scanned = 0;
+
+    QDirIterator dirIt(dirPath, QDir::Dirs | QDir::NoDotAndDotDot);
+    while (dirIt.hasNext()) {
+        dirIt.next();
+        result.subDirs << dirIt.fileInfo();
+        if ((++scanned & 0xFF) == 0 && isCancelled && isCancelled()) return Snapshot();
+    }
+
+    QDirIterator fileIt(dirPath, nameFilters, QDir::Files);
+    while (fileIt.hasNext()) {
+        fileIt.next();
+        result.imageFiles << fileIt.fileInfo();
+        if ((++scanned & 0xFF) == 0 && isCancelled && isCancelled()) return Snapshot();
+    }
+
+    return result;
+}
+
+void DirectorySnapshotCache::onDirectoryChanged(const QString &dirPath)
+{
+    const QString key = normalizedPath(dirPath);
+    if (!m_snapshots.contains(key)) return;
+
+    m_pendingRefresh.insert(key);
+    m_refreshTimer->start();
+}
+
+void DirectorySnapshotCache::refreshPendingDirectories()
+{
+    const QSet<QString> pending = m_pendingRefresh;
+    m_pendingRefresh.clear();
+
+    for (const QString &dirPath : pending) {
+        // 同じディレクトリの再スキャン中なら、終わった後にもう一度
+        if (m_refreshInFlight.contains(dirPath)) {
+            m_pendingRefresh.insert(dirPath);
+            m_refreshTimer->start();
+            continue;
+        }
+
+        if (!QDir(dirPath).exists()) {
+            // ディレクトリごと消えた場合は全件削除として通知
+            const Snapshot old = m_snapshots.value(dirPath);
+            evict(dirPath);
+            QStringList removedFiles, removedDirs;
+            for (const QFileInfo &fi : old.imageFiles) removedFiles << fi.absoluteFilePath();
+            for (const QFileInfo &fi : old.subDirs) removedDirs << fi.absoluteFilePath();
+            emit directoryUpdated(dirPath, QFileInfoList(), removedFiles, QFileInfoList(), removedDirs);
+            continue;
+        }
+
+        m_refreshInFlight.insert(dirPath);
+        const QStringList filters = m_nameFilters;
+        auto *watcher = new QFutureWatcher<Snapshot>(this);
+        connect(watcher, &QFutureWatcher<Snapshot>::finished, this, [this, watcher, dirPath]() {
+            m_refreshInFlight.remove(dirPath);
+            applyRescan(dirPath, watcher->result());
+            watcher->deleteLater();
+        });
+        watcher->setFuture(QtConcurrent::run([dirPath, filters]() {
+            return DirectorySnapshotCache::scan(dirPath, filters);
+        }));
+    }
+}
+
+void DirectorySnapshotCache::applyRescan(const QString &dirPath, const Snapshot &fresh)
+{
+    // 再スキャン中に追い出された場合は何もしない
+    if (!m_snapshots.contains(dirPath)) return;
+
+    const Snapshot old = m_snapshots.value(dirPath);
+
+    // パスで差分を取る (更新日時やサイズの変化は別エントリとして扱わない)
+    auto diff = [](const QFileInfoList &before, const QFileInfoList &after,
+                   QFileInfoList *added, QStringList *removed) {
+        QSet<QString> beforePaths;
+        beforePaths.reserve(before.size());
+        for (const QFileInfo &fi : before) beforePaths.insert(fi.absoluteFilePath());
+
+        QSet<QString> afterPaths;
+        afterPaths.reserve(after.size());
+        for (const QFileInfo &fi : after) {
+            const QString path = fi.absoluteFilePath();
+            afterPaths.insert(path);
+            if (!beforePaths.contains(path)) *added << fi;
+        }
+        for (const QFileInfo &fi : before) {
+            if (!afterPaths.contains(fi.absoluteFilePath())) *removed << fi.absoluteFilePath();
+        }
+    };
+
+    QFileInfoList addedFiles, addedDirs;
+    QStringList removedFiles, removedDirs;
+    diff(old.imageFiles, fresh.imageFiles, &addedFiles, &removedFiles);
+    diff(old.subDirs, fresh.subDirs, &addedDirs, &removedDirs);
+
+    m_snapshots.insert(dirPath, fresh);
+
+    if (addedFiles.isEmpty() && removedFiles.isEmpty() && addedDirs.isEmpty() && removedDirs.isEmpty()) return;
+
+    qDebug() << "[DirCache] Updated:" << dirPath
+             << "+files" << addedFiles.size() << "-files" << removedFiles.size()
+             << "+dirs" << addedDirs.size() << "-dirs" << removedDirs.size();
+
+    emit directoryUpdated(dirPath, addedFiles, removedFiles, addedDirs, removedDirs);
+}
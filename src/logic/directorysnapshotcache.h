@@ -0,0 +1,68 @@
+#ifndef DIRECTORYSNAPSHOTCACHE_H
+#define DIRECTORYSNAPSHOTCACHE_H
+
+#include <QObject>
+#include <QFileInfo>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <functional>
+
+class QFileSystemWatcher;
+class QTimer;
+
+// ディレクトリ一覧のキャッシュ
+// - 一度読んだディレクトリの一覧 (サブフォルダ + 画像ファイル) を保持し、履歴移動時の再読込を省く
+// - QFileSystemWatcher で監視し、変更があれば再スキャンして差分 (追加/削除) だけを通知する
+// ※ GUIスレッド専用。scan() のみワーカースレッドから呼んでよい
+class DirectorySnapshotCache : public QObject
+{
+    Q_OBJECT
+public:
+    struct Snapshot {
+        QFileInfoList subDirs;
+        QFileInfoList imageFiles;
+    };
+
+    explicit DirectorySnapshotCache(QObject *parent = nullptr);
+
+    void setImageExtensions(const QStringList &extensions);
+    QStringList nameFilters() const { return m_nameFilters; }
+
+    bool contains(const QString &dirPath) const;
+    Snapshot snapshot(const QString &dirPath) const;
+    void store(const QString &dirPath, const Snapshot &snapshot);
+
+    // ディスクから一覧を取得 (ソートはしない)
+    static Snapshot scan(const QString &dirPath, const QStringList &nameFilters,
+                         const std::function<bool()> &isCancelled = std::function<bool()>());
+    static QString normalizedPath(const QString &dirPath);
+
+signals:
+    // 監視中のディレクトリの内容が変わった (パスは normalizedPath 済み)
+    void directoryUpdated(const QString &dirPath,
+                          const QFileInfoList &addedFiles, const QStringList &removedFiles,
+                          const QFileInfoList &addedDirs, const QStringList &removedDirs);
+
+private slots:
+    void onDirectoryChanged(const QString &dirPath);
+    void refreshPendingDirectories();
+
+private:
+    void applyRescan(const QString &dirPath, const Snapshot &fresh);
+    void touch(const QString &dirPath);
+    void evict(const QString &dirPath);
+
+    QFileSystemWatcher *m_watcher;
+    QTimer *m_refreshTimer;
+    QSet<QString> m_pendingRefresh;
+    QSet<QString> m_refreshInFlight;
+    QHash<QString, Snapshot> m_snapshots;
+    QStringList m_recentPaths; // LRU (先頭が最新)
+    QStringList m_nameFilters;
+
+    static const int MAX_CACHED_DIRECTORIES = 64;
+    static const int REFRESH_DEBOUNCE_INTERVAL = 300;
+};
+
+#endif // DIRECTORYSNAPSHOTCACHE_H
@@ -0,0 +1,143 @@
+#include "imagelistindex.h"
+#include <QAbstractItemModel>
+#include <QListWidget>
+
+ImageListIndex::ImageListIndex(QObject *parent)
+    : QObject(parent)
+    , m_usesListWidget(false)
+    , m_dirty(true)
+    , m_builtRowCount(-1)
+{
+}
+
+void ImageListIndex::setListWidget(QListWidget *listWidget)
+{
+    for (const QMetaObject::Connection &c : std::as_const(m_connections)) {
+        disconnect(c);
+    }
+    m_connections.clear();
+
+    m_listWidget = listWidget;
+    m_usesListWidget = (listWidget != nullptr);
+    m_files.clear();
+    m_indexByPath.clear();
+    m_rowByPath.clear();
+    m_builtRowCount = -1;
+    m_dirty = true;
+
+    if (!listWidget) return;
+
+    // モデルの構造・データが変わったら無効化するだけ (再構築は次回アクセス時)
+    QAbstractItemModel *model = listWidget->model();
+    m_connections << connect(model, &QAbstractItemModel::rowsInserted, this, &ImageListIndex::invalidate);
+    m_connections << connect(model, &QAbstractItemModel::rowsRemoved, this, &ImageListIndex::invalidate);
+    m_connections << connect(model, &QAbstractItemModel::rowsMoved, this, &ImageListIndex::invalidate);
+    m_connections << connect(model, &QAbstractItemModel::modelReset, this, &ImageListIndex::invalidate);
+    m_connections << connect(model, &QAbstractItemModel::layoutChanged, this, &ImageListIndex::invalidate);
+    m_connections << connect(model, &QAbstractItemModel::dataChanged, this, &ImageListIndex::onDataChanged);
+}
+
+void ImageListIndex::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles)
+{
+    Q_UNUSED(topLeft);
+    Q_UNUSED(bottomRight);
+    // ★ 索引が使うのはパス (UserRole) と除外フラグ (UserRole + 1) だけ。
+    //    ハイライト (IsActiveRole) などは送り操作のたびに変わるので、ここで作り直させない
+    if (roles.isEmpty() || roles.contains(Qt::UserRole) || roles.contains(Qt::UserRole + 1)) invalidate();
+}
+
+void ImageListIndex::setFiles(const QStringList &files)
+{
+    setListWidget(nullptr);
+    m_files = files;
+    // ファイル一覧はそのまま使い、ハッシュだけ作り直す
+    m_indexByPath.clear();
+    m_indexByPath.reserve(m_files.size());
+    for (int i = 0; i < m_files.size(); ++i) {
+        if (!m_indexByPath.contains(m_files.at(i))) m_indexByPath.insert(m_files.at(i), i);
+    }
+    m_rowByPath.clear();
+    m_dirty = false;
+}
+
+void ImageListIndex::invalidate()
+{
+    // ファイル一覧ソースは setFiles でしか変わらない
+    if (m_usesListWidget) m_dirty = true;
+}
+
+void ImageListIndex::ensureBuilt() const
+{
+    if (!m_usesListWidget) return;
+
+    if (!m_listWidget) {
+        // リストが破棄された場合は空として扱う
+        m_files.clear();
+        m_indexByPath.clear();
+        m_rowByPath.clear();
+        m_builtRowCount = -1;
+        m_dirty = false;
+        return;
+    }
+
+    // シグナルを経由しない変更の保険として行数も比較する
+    const int rowCount = m_listWidget->count();
+    if (!m_dirty && rowCount == m_builtRowCount) return;
+
+    QStringList files;
+    files.reserve(rowCount);
+    m_indexByPath.clear();
+    m_indexByPath.reserve(rowCount);
+    m_rowByPath.clear();
+    m_rowByPath.reserve(rowCount);
+
+    for (int row = 0; row < rowCount; ++row) {
+        QListWidgetItem *item = m_listWidget->item(row);
+        if (!item) continue;
+        const QString path = item->data(Qt::UserRole).toString();
+        if (!m_rowByPath.contains(path)) m_rowByPath.insert(path, row);
+        if (item->data(Qt::UserRole + 1).toBool()) continue;
+        if (!m_indexByPath.contains(path)) m_indexByPath.insert(path, files.size());
+        files << path;
+    }
+
+    m_files = files;
+    m_builtRowCount = rowCount;
+    m_dirty = false;
+}
+
+QStringList ImageListIndex::files() const
+{
+    ensureBuilt();
+    return m_files;
+}
+
+int ImageListIndex::count() const
+{
+    ensureBuilt();
+    return m_files.size();
+}
+
+int ImageListIndex::indexOf(const QString &path) const
+{
+    ensureBuilt();
+    return m_indexByPath.value(path, -1);
+}
+
+QListWidgetItem *ImageListIndex::itemForPath(const QString &path) const
+{
+    if (!m_listWidget || path.isEmpty()) return nullptr;
+    ensureBuilt();
+
+    const int row = m_rowByPath.value(path, -1);
+    if (row < 0) return nullptr;
+
+    QListWidgetItem *item = m_listWidget->item(row);
+    if (item && item->data(Qt::UserRole).toString() == path) return item;
+
+    // 索引が古かった場合 (通知なしの並べ替え等) は作り直して一度だけ引き直す
+    m_dirty = true;
+    ensureBuilt();
+    item = m_listWidget->item(m_rowByPath.value(path, -1));
+    return (item && item->data(Qt::UserRole).toString() == path) ? item : nullptr;
+}
@@ -0,0 +1,57 @@
+#ifndef IMAGELISTINDEX_H
+#define IMAGELISTINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <QStringList>
+
+class QListWidget;
+class QListWidgetItem;
+class QModelIndex;
+
+// 画像リスト (スライドショーリスト or ディレクトリ一覧) の索引
+// - files() は暗黙共有の QStringList スナップショットなので、何度呼んでもコピーは発生しない
+// - パス→インデックス / パス→行 をハッシュで保持し、O(1) で引ける
+// - QListWidget のモデル変更シグナルで無効化され、次回アクセス時に一度だけ作り直す
+class ImageListIndex : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ImageListIndex(QObject *parent = nullptr);
+
+    // ソース設定 (リスト or ファイル一覧のどちらか)
+    void setListWidget(QListWidget *listWidget);
+    void setFiles(const QStringList &files);
+
+    // シグナルが届かない編集 (blockSignals 中の削除など) の後に呼ぶ
+    void invalidate();
+
+    // 有効な画像パスのスナップショット (UserRole + 1 が true の項目は除外)
+    QStringList files() const;
+    int count() const;
+
+    // 有効リスト内のインデックス (見つからなければ -1)
+    int indexOf(const QString &path) const;
+
+    // パスに対応する QListWidget のアイテム (リストソースのみ / 除外項目も含む)
+    QListWidgetItem *itemForPath(const QString &path) const;
+
+private:
+    void ensureBuilt() const;
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles);
+
+    QPointer<QListWidget> m_listWidget;
+    QList<QMetaObject::Connection> m_connections;
+
+    bool m_usesListWidget;
+
+    // --- キャッシュ (const アクセス時に遅延構築) ---
+    mutable bool m_dirty;
+    mutable int m_builtRowCount;
+    mutable QStringList m_files;
+    mutable QHash<QString, int> m_indexByPath; // パス→有効リスト内インデックス
+    mutable QHash<QString, int> m_rowByPath;   // パス→QListWidget の行
+};
+
+#endif // IMAGELISTINDEX_H
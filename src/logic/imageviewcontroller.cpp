@@ -1,9 +1,12 @@
 #include "imageviewcontroller.h"
 #include "panoramaview.h"
+#include "filesorter.h"
+#include "exifpreview.h"
 
 #include <QApplication>
 #include <QDebug>
 #include <QDir>
+#include <QDirIterator>
 #include <QDoubleSpinBox>
 #include <QFileInfo>
 #include <QGraphicsView>
@@ -16,6 +19,7 @@
 #include <QProgressBar>
 #include <QPropertyAnimation>
 #include <QRandomGenerator> // ★ 追加: シャッフル用
+#include <QScreen>
 #include <QScrollBar>
 #include <QSlider>
 #include <QSpinBox>
@@ -25,6 +29,7 @@
 #include <QtMath>
 
 #include <algorithm>
+#include <utility>
 
 ImageViewController::ImageViewController(
     QGraphicsView *view,
@@ -66,7 +71,6 @@ ImageViewController::ImageViewController(
     , m_sortAscending(true)
     , m_currentMovie(nullptr)
     , m_logicalTargetIndex(-1)
-    , m_currentScrollAnim(nullptr)
 {
     // --- mediaView 関連の初期化 ---
     currentImageItem = new PixmapObject();
@@ -92,12 +96,19 @@ ImageViewController::ImageViewController(
     m_emptyDirectoryLabel->setFixedSize(m_emptyDirectoryLabel->width() + 40, m_emptyDirectoryLabel->height() + 20);
     m_emptyDirectoryLabel->hide();
 
-    m_collator.setNumericMode(true);
-    m_collator.setCaseSensitivity(Qt::CaseInsensitive);
+    m_collator = FileSorter::createCollator();
+
+    // --- 画像リストの索引 ---
+    m_slideshowListIndex = new ImageListIndex(this);
+    m_directoryIndex = new ImageListIndex(this);
+    m_browseGeneration = QSharedPointer<QAtomicInt>::create(0);
+    m_latestDisplayRequest = QSharedPointer<QAtomicInteger<quint64>>::create(0);
+    m_fullDecodePool.setMaxThreadCount(1);
 
     // --- タイマーの初期化 ---
     m_slideshowInterval = m_intervalSpinBox->value(); // ui->slideshowIntervalSpinBox -> m_intervalSpinBox
     slideshowTimer = new QTimer(this);
+    slideshowTimer->setTimerType(Qt::PreciseTimer); // 連続スクロールではフレームの駆動に使う
     connect(slideshowTimer, &QTimer::timeout, this, [this](){ this->showNextSlide(); });
 
     slideshowProgressTimer = new QTimer(this);
@@ -108,6 +119,11 @@ ImageViewController::ImageViewController(
     m_scrollIndexUpdateTimer->setSingleShot(true);
     connect(m_scrollIndexUpdateTimer, &QTimer::timeout, this, &ImageViewController::updateSlideshowIndexFromScroll);
 
+    // フレーム同期のスクロール駆動 (間隔は開始時に画面のリフレッシュレートから決める)
+    m_scrollFrameTimer = new QTimer(this);
+    m_scrollFrameTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_scrollFrameTimer, &QTimer::timeout, this, &ImageViewController::onScrollFrame);
+
     m_resizeTimer = new QTimer(this);
     m_resizeTimer->setInterval(RESIZE_DEBOUNCE_INTERVAL);
     m_resizeTimer->setSingleShot(true);
@@ -131,6 +147,7 @@ ImageViewController::ImageViewController(
 
 ImageViewController::~ImageViewController()
 {
+    m_fullDecodePool.clear(); // 待っている本体デコードは始めない
     stopCurrentMovie();
 
     for (auto movie : m_panoramaMovies) {
@@ -168,6 +185,9 @@ void ImageViewController::displayMedia(const QString &filePath, bool updateLineE
 
     // 1. 古いムービーを停止・破棄
     stopCurrentMovie();
+    m_currentDisplayedFilePath = filePath;
+    ++m_displayRequestId; // 実行中の本体デコードの結果は捨てる
+    m_latestDisplayRequest->storeRelease(m_displayRequestId); // 待っているものは始めずに終わる
 
     if (updateLineEdit) {
         m_filenameEdit->setText(QFileInfo(filePath).fileName());
@@ -233,6 +253,25 @@ void ImageViewController::displayMedia(const QString &filePath, bool updateLineE
     if (!isMovie) {
         // --- B. 通常の静止画の場合 ---
         qDebug() << "[IVC] Loading as static image.";
+
+        // ★ 隣のフォルダの先読みでデコード済みならそれを使う
+        if (m_prefetchedImages.contains(filePath)) {
+            showStaticPixmap(filePath, QPixmap::fromImage(m_prefetchedImages.take(filePath)));
+            updateZoomState();
+            return;
+        }
+
+        // ★ 大きなファイルは埋め込みプレビューを先に表示し、本体はワーカーでデコードする
+        if (QFileInfo(filePath).size() >= PREVIEW_PLACEHOLDER_MIN_BYTES) {
+            const QImage preview = ExifPreview::read(filePath, PREVIEW_PLACEHOLDER_MIN_EDGE);
+            if (!preview.isNull()) {
+                showStaticPixmap(filePath, QPixmap::fromImage(preview));
+                decodeFullImageAsync(filePath);
+                updateZoomState();
+                return;
+            }
+        }
+
         QImageReader reader(filePath);
         reader.setAutoTransform(true);
         QPixmap pixmap = QPixmap::fromImageReader(&reader);
@@ -246,216 +285,298 @@ void ImageViewController::displayMedia(const QString &filePath, bool updateLineE
                 m_emptyDirectoryLabel->hide();
             }
         } else {
-            m_emptyDirectoryLabel->hide();
+            showStaticPixmap(filePath, pixmap);
+        }
+    }
 
-            emit setItemHighlighted(m_currentlyDisplayedSlideItem, false);
-            m_currentlyDisplayedSlideItem = nullptr;
+    updateZoomState();
+}
 
-            const QStringList& allFiles = getActiveImageList();
-            int itemIndex = allFiles.indexOf(filePath);
+void ImageViewController::showStaticPixmap(const QString &filePath, const QPixmap &pixmap)
+{
+    m_emptyDirectoryLabel->hide();
 
-            // リスト内アイテムの特定
-            if (m_viewMode == ModeSlideshowList && m_currentSlideshowList) {
-                for (int i = 0; i < m_currentSlideshowList->count(); ++i) {
-                    QListWidgetItem* item = m_currentSlideshowList->item(i);
-                    if (item && item->data(Qt::UserRole).toString() == filePath) {
-                        m_currentlyDisplayedSlideItem = item;
-                        break;
-                    }
-                }
-            }
+    emit setItemHighlighted(m_currentlyDisplayedSlideItem, false);
+    m_currentlyDisplayedSlideItem = nullptr;
 
-            emit setItemHighlighted(m_currentlyDisplayedSlideItem, true);
-            currentImageItem->setPixmap(pixmap);
-            currentImageItem->show();
+    const QStringList& allFiles = getActiveImageList();
+    int itemIndex = indexOfActiveImage(filePath);
 
-            QTimer::singleShot(0, this, &ImageViewController::applyFitMode);
+    // リスト内アイテムの特定
+    if (m_viewMode == ModeSlideshowList && m_currentSlideshowList) {
+        m_currentlyDisplayedSlideItem = m_slideshowListIndex->itemForPath(filePath);
+    }
 
-            if (itemIndex != -1) {
-                updateViewControlSliderState(itemIndex, allFiles.count());
-            }
+    emit setItemHighlighted(m_currentlyDisplayedSlideItem, true);
+    currentImageItem->setPixmap(pixmap);
+    currentImageItem->show();
 
-            if (!filePath.isEmpty()) {
-                emit currentImageChanged(filePath);
-            }
-        }
+    QTimer::singleShot(0, this, &ImageViewController::applyFitMode);
+
+    if (itemIndex != -1) {
+        updateViewControlSliderState(itemIndex, allFiles.count());
     }
 
-    updateZoomState();
+    if (!filePath.isEmpty()) {
+        emit currentImageChanged(filePath);
+    }
 }
 
-void ImageViewController::setupPictureScroll(const QStringList& files)
+void ImageViewController::decodeFullImageAsync(const QString &filePath)
 {
-    QRect viewRect = m_view->viewport()->rect();
+    const quint64 requestId = m_displayRequestId;
+
+    auto watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, filePath, requestId]() {
+        watcher->deleteLater();
+        // 別のファイルへ移動済み / パノラマに切り替え済みなら捨てる
+        if (requestId != m_displayRequestId || m_slideshowMode == ModePictureScroll) return;
+
+        const QImage image = watcher->result();
+        if (image.isNull()) {
+            // 本体が読めなくてもプレビューは表示したままにする
+            qDebug() << "[IVC] Full decode failed, keeping preview:" << filePath;
+            return;
+        }
+        currentImageItem->setPixmap(QPixmap::fromImage(image));
+        QTimer::singleShot(0, this, &ImageViewController::applyFitMode);
+        updateZoomState();
+    });
+    // ★ 専用のプールで1つずつ。速くページを送ったときは、始める時点で古くなったものを読まずに捨てる
+    QSharedPointer<QAtomicInteger<quint64>> latestRequest = m_latestDisplayRequest;
+    watcher->setFuture(QtConcurrent::run(&m_fullDecodePool, [filePath, requestId, latestRequest]() {
+        if (latestRequest->loadAcquire() != requestId) return QImage();
+        QImageReader reader(filePath);
+        reader.setAutoTransform(true);
+        return reader.read();
+    }));
+}
 
+void ImageViewController::setupPictureScroll(const QStringList& files)
+{
     qDebug() << "\n=== [DEBUG] setupPictureScroll Start ===";
-    qDebug() << "Viewport Rect:" << viewRect;
     qDebug() << "Direction:" << (m_slideDirection == DirectionHorizontal ? "Horizontal" : "Vertical");
     qDebug() << "Layout:" << (m_layoutDirection == LayoutDirection::Forward ? "Forward" : "Backward");
 
-    if (viewRect.isEmpty()) {
-        qDebug() << "Viewport rect is empty. Aborting.";
-        return;
+    // クリーンアップ
+    clearPanoramaSlides();
+
+    // 1. サイズ取得フェーズ
+    // ★ 元画像のサイズはキャッシュから取得し、未知のファイルだけヘッダを読む。
+    //    読めないファイルもインデックスを揃えるため、サイズ 0 のスライドとして保持する。
+    m_slides.reserve(files.size());
+    for (const QString& filePath : files) {
+        SlideInfo info;
+        info.filePath = filePath;
+        info.slideId = m_nextSlideId++;
+        info.intrinsicSize = probeIntrinsicSize(filePath);
+        m_slides.append(info);
     }
 
-    // クリーンアップ
+    // 2. 配置計算フェーズ
+    relayoutPanorama();
+
+    qDebug() << "=== [DEBUG] setupPictureScroll End ===\n";
+}
+
+void ImageViewController::clearPanoramaSlides()
+{
+    // 動いているスクロールは対象が無くなるので止める
+    cancelScrollAnimation();
+
     for (int i = 0; i < m_slides.size(); ++i) {
-        if (m_slides[i].item) delete m_slides[i].item;
+        if (m_slides[i].item) {
+            mediaScene->removeItem(m_slides[i].item);
+            delete m_slides[i].item;
+        }
         cleanupPanoramaMovie(i); // ★ ここでムービーも削除
     }
     m_slides.clear();
     m_panoramaMovies.clear();
+    // 実行中のデコード結果は slideId が見つからないので破棄される
+    m_loadingSlideIds.clear();
+}
 
-    if (files.isEmpty()) {
-        mediaScene->setSceneRect(viewRect);
-        return;
-    }
-
-    // 1. サイズ計算フェーズ
-    QList<QSize> renderedSizes;
-    int totalLength = 0;
-
-    for (int i = 0; i < files.size(); ++i) {
-        const QString& filePath = files.at(i);
-        QImageReader reader(filePath);
-        if (!reader.canRead()) {
-            qDebug() << "Size Calc [" << i << "]: Cannot read file.";
-            renderedSizes.append(QSize(0,0));
-            continue;
-        }
-        QSize originalSize = reader.size();
-
-        QSize renderedSize;
-        if (m_slideDirection == DirectionHorizontal) {
-            // 倍率計算 (浮動小数点で計算)
-            qreal scale = (qreal)viewRect.height() / (qreal)originalSize.height();
-            // 幅を整数へ丸める
-            int width = qRound(originalSize.width() * scale);
-            renderedSize = QSize(width, viewRect.height());
-            totalLength += width;
+bool ImageViewController::syncPanoramaSlides(const QStringList& files)
+{
+    // まだパノラマが構築されていなければ差分更新はできない
+    if (m_slides.isEmpty() || files.isEmpty()) return false;
 
-            // デバッグ: 個別サイズ
-            // qDebug() << "Size Calc [" << i << "]: Org" << originalSize << "Scale" << scale << "-> Rendered" << renderedSize;
+    // 1. 既存スライドをパスで引けるようにする (同じパスが複数あっても先頭から順に割り当てる)
+    QHash<QString, QList<int>> oldIndicesByPath;
+    oldIndicesByPath.reserve(m_slides.size());
+    for (int i = 0; i < m_slides.size(); ++i) {
+        oldIndicesByPath[m_slides.at(i).filePath].append(i);
+    }
+
+    // 2. 新しい並びを作る。デコード済みのアイテムとムービーはそのまま引き継ぐ
+    QList<SlideInfo> newSlides;
+    newSlides.reserve(files.size());
+    QMap<int, QMovie*> newMovies;
+    QVector<bool> reused(m_slides.size(), false);
+
+    for (const QString& filePath : files) {
+        auto it = oldIndicesByPath.find(filePath);
+        if (it != oldIndicesByPath.end() && !it->isEmpty()) {
+            const int oldIndex = it->takeFirst();
+            reused[oldIndex] = true;
+            if (QMovie* movie = m_panoramaMovies.value(oldIndex, nullptr)) {
+                newMovies.insert(newSlides.size(), movie);
+            }
+            newSlides.append(m_slides.at(oldIndex));
         } else {
-            qreal scale = (qreal)viewRect.width() / (qreal)originalSize.width();
-            int height = qRound(originalSize.height() * scale);
-            renderedSize = QSize(viewRect.width(), height);
-            totalLength += height;
+            SlideInfo info;
+            info.filePath = filePath;
+            info.slideId = m_nextSlideId++;
+            info.intrinsicSize = probeIntrinsicSize(filePath);
+            newSlides.append(info);
         }
-        renderedSizes.append(renderedSize);
     }
 
-    qDebug() << "Total Length Calculated:" << totalLength;
-
-    // 2. 配置計算フェーズ
-    int currentPos;
-    int padding;
-
-    if (m_slideDirection == DirectionHorizontal) {
-        padding = viewRect.width() / 2;
-        currentPos = (m_layoutDirection == LayoutDirection::Backward) ? totalLength + padding : padding;
-    } else {
-        padding = viewRect.height() / 2;
-        currentPos = (m_layoutDirection == LayoutDirection::Backward) ? totalLength + padding : padding;
+    // 3. 使われなくなったスライドを解放
+    for (int i = 0; i < m_slides.size(); ++i) {
+        if (reused.at(i)) continue;
+        if (m_slides[i].item) {
+            mediaScene->removeItem(m_slides[i].item);
+            delete m_slides[i].item;
+        }
+        m_loadingSlideIds.remove(m_slides[i].slideId);
+        cleanupPanoramaMovie(i);
     }
 
-    // 隣接チェック用変数
-    int previousEdgePos = -999999;
-    bool isFirstItem = true;
-
-    for (int i = 0; i < files.size(); ++i) {
-        SlideInfo info;
-        info.filePath = files.at(i);
+    qDebug() << "[IVC] syncPanoramaSlides:" << m_slides.size() << "->" << newSlides.size();
 
-        QSize renderedSize = renderedSizes.at(i);
-        if (renderedSize.isEmpty()) continue;
+    m_slides = newSlides;
+    m_panoramaMovies = newMovies;
 
-        int itemStartPos = 0; // このアイテムの描画開始位置
-        int itemEndPos = 0;   // このアイテムの描画終了位置
+    // 4. オフセットを計算し直す (キャッシュ済みサイズのみ使用するのでファイルには触れない)
+    relayoutPanorama();
+    return true;
+}
 
-        if (m_slideDirection == DirectionHorizontal) {
-            if (m_layoutDirection == LayoutDirection::Backward) {
-                // Backward: currentPos は「右端」から「左」へ進む
-                // 配置: (currentPos - width) が左端
-                currentPos -= renderedSize.width();
-                info.geometry = QRectF(currentPos, 0, renderedSize.width(), renderedSize.height());
+int ImageViewController::findSlideIndex(quint64 slideId, int hintIndex) const
+{
+    if (hintIndex >= 0 && hintIndex < m_slides.size() && m_slides.at(hintIndex).slideId == slideId) {
+        return hintIndex;
+    }
+    for (int i = 0; i < m_slides.size(); ++i) {
+        if (m_slides.at(i).slideId == slideId) return i;
+    }
+    return -1;
+}
 
-                // 境界チェック用
-                itemStartPos = currentPos + renderedSize.width(); // 右端
-                itemEndPos = currentPos; // 左端 (次のアイテムの右端になるべき場所)
+QSize ImageViewController::probeIntrinsicSize(const QString& filePath)
+{
+    auto it = m_intrinsicSizeCache.constFind(filePath);
+    if (it != m_intrinsicSizeCache.constEnd()) {
+        return it.value();
+    }
 
-                // デバッグ: 隙間チェック (Backwardなので、前のアイテムの左端 == 今のアイテムの右端)
-                if (!isFirstItem) {
-                    int gap = previousEdgePos - itemStartPos;
-                    if (gap != 0) qDebug() << "!!! GAP DETECTED [" << i-1 << "->" << i << "] Gap:" << gap << "px";
-                }
-                previousEdgePos = itemEndPos;
+    QSize size;
+    QImageReader reader(filePath);
+    if (reader.canRead()) {
+        size = reader.size();
+    } else {
+        qDebug() << "Size Probe:" << filePath << "Cannot read file.";
+    }
+    if (!size.isValid() || size.isEmpty()) size = QSize();
 
-            } else {
-                // Forward: currentPos は「左端」から「右」へ進む
-                info.geometry = QRectF(currentPos, 0, renderedSize.width(), renderedSize.height());
+    m_intrinsicSizeCache.insert(filePath, size);
+    return size;
+}
 
-                itemStartPos = currentPos;
-                itemEndPos = currentPos + renderedSize.width();
+void ImageViewController::relayoutPanorama()
+{
+    QRect viewRect = m_view->viewport()->rect();
+    qDebug() << "[IVC] relayoutPanorama. Viewport Rect:" << viewRect << "Slides:" << m_slides.size();
 
-                currentPos += renderedSize.width();
+    if (viewRect.isEmpty()) {
+        qDebug() << "Viewport rect is empty. Aborting.";
+        return;
+    }
 
-                // デバッグ: 隙間チェック (前のアイテムの右端 == 今のアイテムの左端)
-                if (!isFirstItem) {
-                    int gap = itemStartPos - previousEdgePos;
-                    if (gap != 0) qDebug() << "!!! GAP DETECTED [" << i-1 << "->" << i << "] Gap:" << gap << "px";
-                }
-                previousEdgePos = itemEndPos;
-            }
-        } else {
-            // Vertical (同様のロジック)
-            if (m_layoutDirection == LayoutDirection::Backward) {
-                currentPos -= renderedSize.height();
-                info.geometry = QRectF(0, currentPos, renderedSize.width(), renderedSize.height());
+    if (m_slides.isEmpty()) {
+        mediaScene->setSceneRect(viewRect);
+        return;
+    }
 
-                itemStartPos = currentPos + renderedSize.height();
-                itemEndPos = currentPos;
+    const bool horizontal = (m_slideDirection == DirectionHorizontal);
+    const bool backward = (m_layoutDirection == LayoutDirection::Backward);
 
-                if (!isFirstItem) {
-                    int gap = previousEdgePos - itemStartPos;
-                    if (gap != 0) qDebug() << "!!! GAP DETECTED [" << i-1 << "->" << i << "] Gap:" << gap << "px";
-                }
-                previousEdgePos = itemEndPos;
+    // 1. 描画サイズの計算 (キャッシュ済みの元サイズから算出するだけなのでファイルには触れない)
+    QList<QSize> renderedSizes;
+    renderedSizes.reserve(m_slides.size());
+    int totalLength = 0;
 
+    for (const SlideInfo& slide : std::as_const(m_slides)) {
+        const QSize originalSize = slide.intrinsicSize;
+        QSize renderedSize(0, 0);
+        if (!originalSize.isEmpty()) {
+            if (horizontal) {
+                qreal scale = (qreal)viewRect.height() / (qreal)originalSize.height();
+                renderedSize = QSize(qRound(originalSize.width() * scale), viewRect.height());
+                totalLength += renderedSize.width();
             } else {
-                info.geometry = QRectF(0, currentPos, renderedSize.width(), renderedSize.height());
-
-                itemStartPos = currentPos;
-                itemEndPos = currentPos + renderedSize.height();
-
-                currentPos += renderedSize.height();
-
-                if (!isFirstItem) {
-                    int gap = itemStartPos - previousEdgePos;
-                    if (gap != 0) qDebug() << "!!! GAP DETECTED [" << i-1 << "->" << i << "] Gap:" << gap << "px";
-                }
-                previousEdgePos = itemEndPos;
+                qreal scale = (qreal)viewRect.width() / (qreal)originalSize.width();
+                renderedSize = QSize(viewRect.width(), qRound(originalSize.height() * scale));
+                totalLength += renderedSize.height();
             }
         }
+        renderedSizes.append(renderedSize);
+    }
 
-        // 詳細な座標ログが必要な場合はコメントアウトを外す
-        // qDebug() << "Item" << i << "Geometry:" << info.geometry << " (Int Rect:" << info.geometry.toRect() << ")";
+    qDebug() << "Total Length Calculated:" << totalLength;
 
-        m_slides.append(info);
-        isFirstItem = false;
-    }
+    // 2. 配置計算
+    // Forward: currentPos は先頭側の端から進む / Backward: 末尾側の端から戻る
+    const int padding = horizontal ? viewRect.width() / 2 : viewRect.height() / 2;
+    int currentPos = backward ? totalLength + padding : padding;
 
-    // シーン矩形の設定ログ
-    QRectF sceneRect;
-    if (m_slideDirection == DirectionHorizontal) {
-        sceneRect = QRectF(0, 0, totalLength + padding * 2, viewRect.height());
-    } else {
-        sceneRect = QRectF(0, 0, viewRect.width(), totalLength + padding * 2);
+    for (int i = 0; i < m_slides.size(); ++i) {
+        SlideInfo& slide = m_slides[i];
+        const QSize renderedSize = renderedSizes.at(i);
+        const int length = horizontal ? renderedSize.width() : renderedSize.height();
+
+        if (backward) currentPos -= length;
+        slide.geometry = horizontal
+                             ? QRectF(currentPos, 0, renderedSize.width(), renderedSize.height())
+                             : QRectF(0, currentPos, renderedSize.width(), renderedSize.height());
+        if (!backward) currentPos += length;
+
+        // ★ 読み込み済みのアイテムは破棄せず、その場で拡縮してプレースホルダーとして使う。
+        //    高画質版は loadSlidesAround が新しいサイズで再デコードする。
+        if (slide.item) {
+            fitSlideItem(i);
+        }
+        QMovie* movie = m_panoramaMovies.value(i, nullptr);
+        if (movie && !renderedSize.isEmpty()) {
+            movie->setScaledSize(renderedSize);
+            slide.decodedSize = renderedSize;
+        }
     }
+
+    QRectF sceneRect = horizontal
+                           ? QRectF(0, 0, totalLength + padding * 2, viewRect.height())
+                           : QRectF(0, 0, viewRect.width(), totalLength + padding * 2);
     mediaScene->setSceneRect(sceneRect);
 
     qDebug() << "Scene Rect Set To:" << sceneRect;
-    qDebug() << "=== [DEBUG] setupPictureScroll End ===\n";
+}
+
+void ImageViewController::fitSlideItem(int index)
+{
+    if (index < 0 || index >= m_slides.size()) return;
+    const SlideInfo& slide = m_slides.at(index);
+    if (!slide.item) return;
+
+    slide.item->setPos(slide.geometry.topLeft());
+
+    const QSize pixmapSize = slide.item->pixmap().size();
+    if (pixmapSize.isEmpty() || slide.geometry.isEmpty()) {
+        slide.item->setScale(1.0);
+        return;
+    }
+    slide.item->setScale(slide.geometry.width() / pixmapSize.width());
 }
 
 void ImageViewController::positionScrollAtIndex(int index)
@@ -547,6 +668,7 @@ void ImageViewController::onTogglePanoramaMode()
     if (slideshowWasActive) {
         slideshowTimer->stop();
         slideshowProgressTimer->stop();
+        clearSlideshowBuffer();
     }
 
     int finalIndex = -1;
@@ -610,13 +732,7 @@ void ImageViewController::onTogglePanoramaMode()
         int currentIndex = m_viewControlSlider->value();
         finalIndex = currentIndex;
 
-        for (const SlideInfo& slide : m_slides) {
-            if (slide.item) {
-                mediaScene->removeItem(slide.item);
-                delete slide.item;
-            }
-        }
-        m_slides.clear();
+        clearPanoramaSlides();
 
         const QStringList allFiles = getActiveImageList();
 
@@ -628,11 +744,8 @@ void ImageViewController::onTogglePanoramaMode()
 
             if (m_viewMode == ModeSlideshowList && m_currentSlideshowList) {
                 QString path = allFiles.at(finalIndex);
-                for (int i = 0; i < m_currentSlideshowList->count(); ++i) {
-                    if (m_currentSlideshowList->item(i)->data(Qt::UserRole).toString() == path) {
-                        m_currentSlideshowList->setCurrentItem(m_currentSlideshowList->item(i));
-                        break;
-                    }
+                if (QListWidgetItem* item = m_slideshowListIndex->itemForPath(path)) {
+                    m_currentSlideshowList->setCurrentItem(item);
                 }
             }
         } else {
@@ -645,7 +758,7 @@ void ImageViewController::onTogglePanoramaMode()
 
     if (slideshowWasActive) {
         slideshowCurrentIndex = finalIndex;
-        int interval_ms = static_cast<int>(m_slideshowInterval * 1000.0);
+        int interval_ms = slideshowTimerInterval();
         if (interval_ms > 0) {
             slideshowTimer->start(interval_ms);
             slideshowElapsedTimer.restart();
@@ -736,13 +849,7 @@ void ImageViewController::onViewControlSliderMoved(int value)
         if (m_viewMode == ModeSlideshowList && m_currentSlideshowList) {
             if (value >= 0 && value < allFiles.size()) {
                 QString path = allFiles.at(value);
-                QListWidgetItem* itemToHighlight = nullptr;
-                for (int i = 0; i < m_currentSlideshowList->count(); ++i) {
-                    if (m_currentSlideshowList->item(i)->data(Qt::UserRole).toString() == path) {
-                        itemToHighlight = m_currentSlideshowList->item(i);
-                        break;
-                    }
-                }
+                QListWidgetItem* itemToHighlight = m_slideshowListIndex->itemForPath(path);
                 if (itemToHighlight && m_currentSlideshowList->currentRow() != m_currentSlideshowList->row(itemToHighlight)) {
                     emit setItemHighlighted(m_currentlyDisplayedSlideItem, false);
                     m_currentlyDisplayedSlideItem = itemToHighlight;
@@ -752,7 +859,7 @@ void ImageViewController::onViewControlSliderMoved(int value)
         }
         if (slideshowTimer->isActive()) {
             slideshowCurrentIndex = value;
-            int interval_ms = static_cast<int>(m_slideshowInterval * 1000.0);
+            int interval_ms = slideshowTimerInterval();
             if (interval_ms > 0) {
                 slideshowTimer->start(interval_ms);
                 slideshowElapsedTimer.restart();
@@ -765,7 +872,7 @@ void ImageViewController::onViewControlSliderMoved(int value)
             if (slideshowTimer->isActive()) {
                 slideshowCurrentIndex = newIndex;
                 showNextSlide(true);
-                int interval_ms = static_cast<int>(m_slideshowInterval * 1000.0);
+                int interval_ms = slideshowTimerInterval();
                 if (interval_ms > 0) {
                     slideshowTimer->start(interval_ms);
                     slideshowElapsedTimer.restart();
@@ -774,6 +881,7 @@ void ImageViewController::onViewControlSliderMoved(int value)
             } else {
                 QString path = allFiles.at(newIndex);
                 displayMedia(path);
+                maybePrefetchSiblingDirectory(newIndex, allFiles.size());
             }
         }
     }
@@ -814,8 +922,7 @@ void ImageViewController::setSlideshowInterval(double seconds)
     qDebug() << "[IVC] Slideshow interval changed to:" << m_slideshowInterval;
 
     if (slideshowTimer->isActive()) {
-        int interval_ms = static_cast<int>(m_slideshowInterval * 1000.0);
-        slideshowTimer->start(interval_ms);
+        slideshowTimer->start(slideshowTimerInterval());
         slideshowElapsedTimer.restart();
         m_progressBar->setValue(0); // ui->slideshowProgressBar -> m_progressBar
     }
@@ -824,6 +931,7 @@ void ImageViewController::setSlideshowInterval(double seconds)
 void ImageViewController::setSlideshowList(QListWidget* listWidget)
 {
     m_currentSlideshowList = listWidget;
+    m_slideshowListIndex->setListWidget(listWidget);
     onSlideshowPlaylistChanged();
 }
 
@@ -836,6 +944,7 @@ void ImageViewController::setSortOrder(SortMode mode, bool ascending)
 
     m_currentSortMode = mode;
     m_sortAscending = ascending;
+    m_sortedDirectoryCache.clear();
 
     // 現在表示中のファイルを維持しつつ、リストを再構築してリロード
     if (!m_currentBrowsePath.isEmpty()) {
@@ -890,13 +999,7 @@ void ImageViewController::setViewStates(bool isPanorama, FitMode fitMode, Layout
 
     } else {
         currentImageItem->show();
-        for (const auto& slide : m_slides) {
-            if (slide.item) {
-                mediaScene->removeItem(slide.item);
-                delete slide.item;
-            }
-        }
-        m_slides.clear();
+        clearPanoramaSlides();
         m_scrollIndexUpdateTimer->stop();
     }
 
@@ -918,6 +1021,8 @@ void ImageViewController::toggleSlideshow()
         slideshowProgressTimer->stop();
         m_progressBar->hide();
         m_progressBar->setValue(0);
+        m_preloadAhead = 0;
+        clearSlideshowBuffer();
 
         handleResize();
 
@@ -938,9 +1043,9 @@ void ImageViewController::toggleSlideshow()
         slideshowCurrentIndex = m_viewControlSlider->value();
     } else {
         if (m_viewMode == ModeSlideshowList && m_currentSlideshowList && m_currentSlideshowList->currentItem()) {
-            slideshowCurrentIndex = allFiles.indexOf(m_currentSlideshowList->currentItem()->data(Qt::UserRole).toString());
+            slideshowCurrentIndex = indexOfActiveImage(m_currentSlideshowList->currentItem()->data(Qt::UserRole).toString());
         } else if (!currentImageItem->pixmap().isNull()) {
-            slideshowCurrentIndex = allFiles.indexOf(m_filenameEdit->text());
+            slideshowCurrentIndex = indexOfActiveImage(m_filenameEdit->text());
         } else {
             slideshowCurrentIndex = 0;
         }
@@ -967,7 +1072,7 @@ void ImageViewController::toggleSlideshow()
 
     showNextSlide(true);
 
-    int interval_ms = static_cast<int>(m_slideshowInterval * 1000.0);
+    int interval_ms = slideshowTimerInterval();
     if (interval_ms > 0) {
         slideshowTimer->start(interval_ms);
         slideshowElapsedTimer.restart();
@@ -1029,13 +1134,28 @@ void ImageViewController::handleWheelEvent(QWheelEvent *wheelEvent, QWidget* vie
         int step = (delta < 0) ? 1 : -1;
 
         if (m_slideshowMode == ModePictureScroll) {
+            // ★ 高分解能ホイール/タッチパッドは細かいイベントが大量に来るので、
+            //    移動量を貯めて1ページ分に達した分だけステップにする
+            if ((m_wheelRemainder > 0) != (delta > 0)) m_wheelRemainder = 0; // 向きが変わったら捨てる
+            m_wheelRemainder += delta;
+            const int unit = wheelEvent->pixelDelta().isNull() ? WHEEL_STEP_ANGLE : WHEEL_STEP_PIXELS;
+            const int notches = m_wheelRemainder / unit;
+            if (notches == 0) return;
+            m_wheelRemainder -= notches * unit;
+
+            step = -notches;
             if (m_layoutDirection == LayoutDirection::Backward) step *= -1;
 
-            // ★ 修正: 共通関数を呼ぶだけにする
-            stepByImage(step);
+            // 実際の移動は次のフレームでまとめて行う
+            queueImageStep(step);
 
         } else {
             // 標準モード
+            // 端まで来ていれば隣のフォルダへ (設定が有効な場合のみ)
+            const bool atEnd = (step > 0) ? m_viewControlSlider->value() >= m_viewControlSlider->maximum()
+                                          : m_viewControlSlider->value() <= m_viewControlSlider->minimum();
+            if (atEnd && continueToSiblingDirectory(step)) return;
+
             if (step > 0) m_viewControlSlider->triggerAction(QAbstractSlider::SliderSingleStepAdd);
             else m_viewControlSlider->triggerAction(QAbstractSlider::SliderSingleStepSub);
         }
@@ -1069,8 +1189,8 @@ void ImageViewController::handleKeyPressEvent(QKeyEvent *event)
     if (keyHandled) {
         if (m_layoutDirection == LayoutDirection::Backward) step *= -1;
 
-        // ★ 修正: 共通関数を使用
-        stepByImage(step);
+        // キーリピートもフレーム単位でまとめる
+        queueImageStep(step);
 
         event->accept();
     } else {
@@ -1081,31 +1201,50 @@ void ImageViewController::handleKeyPressEvent(QKeyEvent *event)
 void ImageViewController::onImageLoaded(const AsyncLoadResult& result)
 {
     // ロード中フラグを解除
-    m_loadingIndices.remove(result.index);
+    m_loadingSlideIds.remove(result.slideId);
+
+    // ★ リスト編集でインデックスがずれている可能性があるので、IDで現在位置を引き直す
+    const int index = findSlideIndex(result.slideId, result.index);
+    if (index < 0) return;
+    if (!result.success) return;
 
-    // インデックスの有効性チェック
-    if (result.index < 0 || result.index >= m_slides.size()) return;
+    // 先読み量の見積もり用にデコード時間を平均しておく
+    if (result.decodeMs > 0) {
+        m_slideDecodeLatencyMs = (m_slideDecodeLatencyMs <= 0.0)
+                                     ? result.decodeMs
+                                     : m_slideDecodeLatencyMs * 0.8 + result.decodeMs * 0.2;
+    }
+
+    SlideInfo& slide = m_slides[index];
 
-    // ユーザーが高速スクロールして、既に画面外になっていたら追加しない（メモリ節約）
-    // ただし、キャッシュとして保持したい場合は追加しても良い。
-    // ここでは、現在の loadSlidesAround の範囲ロジックと整合性を取るため、
-    // 生成してシーンに追加し、次回の loadSlidesAround 呼び出し時に範囲外なら消えるようにします。
-    // (または、ここで範囲チェックをして生成をスキップするのもありです)
+    // ★ アニメーション画像は QMovie 側で描画しているので触らない
+    if (m_panoramaMovies.contains(index)) return;
 
-    // 既にアイテムが存在する場合は何もしない（二重追加防止）
-    if (m_slides[result.index].item != nullptr) return;
+    // ★ デコード中にリサイズされた場合でも、結果は拡縮したプレースホルダーとして使い、
+    //    現在のサイズで改めてデコードし直す (古い結果で高画質版を上書きしないよう比較する)
+    const QSize currentSize = slide.geometry.size().toSize();
+    const bool isStale = (result.targetSize != currentSize);
+    if (isStale && slide.item && slide.decodedSize == currentSize) return;
 
-    if (result.success) {
-        // メインスレッドで QPixmap に変換 (QPixmapはメインスレッドでしか扱えない)
-        QPixmap pixmap = QPixmap::fromImage(result.image);
+    // メインスレッドで QPixmap に変換 (QPixmapはメインスレッドでしか扱えない)
+    QPixmap pixmap = QPixmap::fromImage(result.image);
 
+    if (slide.item) {
+        // 既存アイテム (拡縮中のプレースホルダー) を高画質版に差し替える
+        slide.item->setPixmap(pixmap);
+    } else {
         QGraphicsPixmapItem* item = new QGraphicsPixmapItem(pixmap);
         item->setTransformationMode(Qt::SmoothTransformation);
-        item->setPos(m_slides[result.index].geometry.topLeft());
 
         // シーンに追加
         mediaScene->addItem(item);
-        m_slides[result.index].item = item;
+        slide.item = item;
+    }
+    slide.decodedSize = result.targetSize;
+    fitSlideItem(index);
+
+    if (isStale && qAbs(index - m_loadedCenterIndex) <= PANORAMA_PRELOAD_RANGE) {
+        requestSlideDecode(index);
     }
 }
 
@@ -1131,7 +1270,7 @@ void ImageViewController::onSlideshowSelectionChanged()
         if (QApplication::mouseButtons() & Qt::LeftButton) {
             slideshowCurrentIndex = newIndex;
             showNextSlide(true);
-            slideshowTimer->start(static_cast<int>(m_intervalSpinBox->value() * 1000.0)); // ui->slideshowIntervalSpinBox -> m_intervalSpinBox
+            slideshowTimer->start(slideshowTimerInterval());
             slideshowElapsedTimer.restart();
             m_progressBar->setValue(0); // ui->slideshowProgressBar -> m_progressBar
         }
@@ -1149,7 +1288,7 @@ void ImageViewController::onSlideshowListDoubleClicked(QListWidgetItem *item)
     if (m_slideshowMode == ModePictureScroll) {
         qDebug() << "[IVC DblClick] Panorama mode is active.";
         const QStringList allFiles = getActiveImageList();
-        int newIndex = allFiles.indexOf(item->data(Qt::UserRole).toString());
+        int newIndex = indexOfActiveImage(item->data(Qt::UserRole).toString());
         qDebug() << "[IVC DblClick] Filtered index is:" << newIndex;
 
         if (newIndex == -1) {
@@ -1170,9 +1309,27 @@ void ImageViewController::onSlideshowListDoubleClicked(QListWidgetItem *item)
 
 void ImageViewController::onSlideshowPlaylistChanged()
 {
+    // ★ 削除はモデルのシグナルを止めて行われるので、ここで索引を明示的に無効化する
+    m_slideshowListIndex->invalidate();
     const QStringList allFiles = getActiveImageList();
 
+    // ★ パノラマ表示中は、編集前に中央にあった画像を覚えておき、差分更新後も同じ画像に留まる
+    QString anchorPath;
+    if (m_slideshowMode == ModePictureScroll) {
+        const int anchorIndex = slideshowTimer->isActive() ? slideshowCurrentIndex : m_viewControlSlider->value();
+        if (anchorIndex >= 0 && anchorIndex < m_slides.size()) {
+            anchorPath = m_slides.at(anchorIndex).filePath;
+        }
+    }
+
     if (!slideshowTimer->isActive()) {
+        if (m_slideshowMode == ModePictureScroll && syncPanoramaSlides(allFiles)) {
+            int newIndex = indexOfActiveImage(anchorPath);
+            if (newIndex < 0) newIndex = qMin(m_viewControlSlider->value(), allFiles.size() - 1);
+            updateViewControlSliderState(newIndex, allFiles.count());
+            positionScrollAtIndex(newIndex);
+            return;
+        }
         updateViewControlSliderState(-1, allFiles.count());
         return;
     }
@@ -1180,6 +1337,7 @@ void ImageViewController::onSlideshowPlaylistChanged()
     qDebug() << "Slideshow playlist changed, restarting slideshow...";
     slideshowTimer->stop();
     slideshowProgressTimer->stop();
+    clearSlideshowBuffer();
 
 
     if (allFiles.isEmpty()) {
@@ -1191,21 +1349,24 @@ void ImageViewController::onSlideshowPlaylistChanged()
         return;
     }
 
+    if (!anchorPath.isEmpty()) {
+        const int anchorIndex = indexOfActiveImage(anchorPath);
+        if (anchorIndex >= 0) slideshowCurrentIndex = anchorIndex;
+    }
     if (slideshowCurrentIndex >= allFiles.size()) slideshowCurrentIndex = allFiles.size() - 1;
     if (slideshowCurrentIndex < 0) slideshowCurrentIndex = 0;
 
     if (m_viewMode == ModeSlideshowList && m_currentSlideshowList) {
-        for (int i = 0; i < m_currentSlideshowList->count(); ++i) {
-            if (m_currentSlideshowList->item(i)->data(Qt::UserRole).toString() == allFiles.at(slideshowCurrentIndex)) {
-                m_currentSlideshowList->setCurrentItem(m_currentSlideshowList->item(i));
-                break;
-            }
+        if (QListWidgetItem* item = m_slideshowListIndex->itemForPath(allFiles.at(slideshowCurrentIndex))) {
+            m_currentSlideshowList->setCurrentItem(item);
         }
     }
 
     if (m_slideshowMode == ModePictureScroll) {
-        QApplication::processEvents();
-        setupPictureScroll(allFiles);
+        // ★ 差分更新できればデコード済みの近傍をそのまま使う。できなければ再構築
+        if (!syncPanoramaSlides(allFiles)) {
+            setupPictureScroll(allFiles);
+        }
         positionScrollAtIndex(slideshowCurrentIndex);
     } else {
         showNextSlide(true);
@@ -1213,32 +1374,32 @@ void ImageViewController::onSlideshowPlaylistChanged()
 
     slideshowElapsedTimer.restart();
     m_progressBar->setValue(0);
-    int interval_ms = static_cast<int>(m_slideshowInterval * 1000.0);
+    int interval_ms = slideshowTimerInterval();
     if (interval_ms > 0) {
         slideshowTimer->start(interval_ms);
         slideshowProgressTimer->start(16);
     }
-
-    if (m_slideshowMode == ModePictureScroll) {
-        const QStringList allFiles = getActiveImageList();
-        setupPictureScroll(allFiles);
-        // 現在位置を維持するか、0に戻すか
-        if (slideshowCurrentIndex >= allFiles.size()) slideshowCurrentIndex = allFiles.size() - 1;
-        positionScrollAtIndex(slideshowCurrentIndex);
-    }
 }
 
 void ImageViewController::onResizeTimeout()
 {
-    qDebug() << "[IVC Resize] Resize timer timed out. Rebuilding panorama.";
-
-    const QStringList allFiles = getActiveImageList();
+    // ★ 標準モードではパノラマのレイアウトは不要 (モード切替時に setupPictureScroll される)
+    if (m_slideshowMode == ModePictureScroll) {
+        const QStringList allFiles = getActiveImageList();
 
-    // 1. 画像がある場合の処理 (既存)
-    if (!allFiles.isEmpty()) {
-        int currentIndex = m_viewControlSlider->value(); // ui->viewControlSlider -> m_viewControlSlider
-        setupPictureScroll(allFiles);
-        positionScrollAtIndex(currentIndex);
+        // 1. 画像がある場合の処理
+        if (!allFiles.isEmpty()) {
+            int currentIndex = m_viewControlSlider->value(); // ui->viewControlSlider -> m_viewControlSlider
+            if (m_slides.size() == allFiles.size()) {
+                // ★ リストが変わっていなければ、キャッシュ済みのサイズから配置を計算し直すだけ
+                qDebug() << "[IVC Resize] Relayout panorama from cached sizes.";
+                relayoutPanorama();
+            } else {
+                qDebug() << "[IVC Resize] Slide count mismatch. Rebuilding panorama.";
+                setupPictureScroll(allFiles);
+            }
+            positionScrollAtIndex(currentIndex);
+        }
     }
 
     // 2. オーバーレイの位置を更新 (画像がない場合のラベルや、ローディング表示の位置合わせ)
@@ -1321,21 +1482,23 @@ void ImageViewController::cleanupPanoramaMovie(int index)
 }
 
 const QStringList ImageViewController::getActiveImageList() const
+{
+    // ★ 索引が保持する共有スナップショットを返す (リストが変わらない限り再構築しない)
+    return activeImageIndex()->files();
+}
+
+const ImageListIndex* ImageViewController::activeImageIndex() const
 {
     if (m_viewMode == ModeSlideshowList && m_currentSlideshowList) {
-        QStringList files;
-        int count = m_currentSlideshowList->count();
-        for(int i=0; i<count; ++i) {
-            QListWidgetItem* item = m_currentSlideshowList->item(i);
-            if (item && !item->data(Qt::UserRole + 1).toBool()) {
-                files << item->data(Qt::UserRole).toString();
-            }
-        }
-        return files;
-    } else {
-        // ディレクトリ閲覧モード
-        return m_directoryFiles;
+        return m_slideshowListIndex;
     }
+    // ディレクトリ閲覧モード
+    return m_directoryIndex;
+}
+
+int ImageViewController::indexOfActiveImage(const QString& path) const
+{
+    return activeImageIndex()->indexOf(path);
 }
 
 void ImageViewController::goBack()
@@ -1393,9 +1556,11 @@ void ImageViewController::loadSlidesAround(int index)
 {
     if (m_slides.isEmpty()) return;
 
-    const int range = 5;
+    const int range = PANORAMA_PRELOAD_RANGE;
     int startIndex = qMax(0, index - range);
-    int endIndex = qMin(m_slides.size() - 1, index + range);
+    // 連続スクロール中は進行方向をスクロール速度に応じて多めに読む
+    int endIndex = qMin(m_slides.size() - 1, index + qMax(range, m_preloadAhead));
+    m_loadedCenterIndex = index;
 
     // 1. 範囲外のアイテムを解放
     for (int i = 0; i < m_slides.size(); ++i) {
@@ -1404,6 +1569,7 @@ void ImageViewController::loadSlidesAround(int index)
                 mediaScene->removeItem(m_slides[i].item);
                 delete m_slides[i].item;
                 m_slides[i].item = nullptr;
+                m_slides[i].decodedSize = QSize();
             }
             // ★ 範囲外になったらムービーも停止してメモリ解放
             cleanupPanoramaMovie(i);
@@ -1412,14 +1578,22 @@ void ImageViewController::loadSlidesAround(int index)
 
     // 2. 範囲内のアイテムをロード
     for (int i = startIndex; i <= endIndex; ++i) {
-        // すでにアイテムがある、または現在ロード中なら何もしない
-        if (m_slides[i].item != nullptr || m_loadingIndices.contains(i)) {
+        // 現在ロード中なら何もしない
+        if (m_loadingSlideIds.contains(m_slides[i].slideId)) continue;
+
+        QSize targetSize = m_slides[i].geometry.size().toSize();
+        if (targetSize.isEmpty()) continue;
+
+        // すでにアイテムがある場合は、デコードサイズが現在の配置と一致していれば何もしない
+        // (リサイズ後の拡縮プレースホルダーは、ここで高画質版を要求する)
+        if (m_slides[i].item != nullptr) {
+            if (m_slides[i].decodedSize != targetSize && !m_panoramaMovies.contains(i)) {
+                requestSlideDecode(i);
+            }
             continue;
         }
 
         QString path = m_slides[i].filePath;
-        QSize targetSize = m_slides[i].geometry.size().toSize();
-        if (targetSize.isEmpty()) continue;
 
         // ★ 分岐: GIFアニメーションかどうか判定
         if (isAnimatedImage(path)) {
@@ -1444,13 +1618,17 @@ void ImageViewController::loadSlidesAround(int index)
             item->setPos(m_slides[i].geometry.topLeft());
             mediaScene->addItem(item);
             m_slides[i].item = item;
+            m_slides[i].decodedSize = targetSize;
 
             // フレーム更新シグナル
-            connect(movie, &QMovie::frameChanged, this, [this, i]() {
+            // ★ リスト編集でインデックスがずれるので、i ではなくムービー自身から現在位置を引く
+            connect(movie, &QMovie::frameChanged, this, [this, movie]() {
+                const int index = m_panoramaMovies.key(movie, -1);
                 // インデックスの妥当性とアイテムの存在を確認
-                if (m_panoramaMovies.contains(i) && i < m_slides.size() && m_slides[i].item) {
-                    QMovie* m = m_panoramaMovies[i];
-                    m_slides[i].item->setPixmap(m->currentPixmap());
+                if (index >= 0 && index < m_slides.size() && m_slides[index].item) {
+                    m_slides[index].item->setPixmap(movie->currentPixmap());
+                    // ★ リサイズ直後のフレームサイズの差を吸収
+                    fitSlideItem(index);
                     // シーン更新
                     mediaScene->update();
                 }
@@ -1464,41 +1642,62 @@ void ImageViewController::loadSlidesAround(int index)
             continue;
         }
 
-        // --- 静止画の場合: 既存の非同期ロード処理 (QtConcurrent) ---
+        // --- 静止画の場合: 非同期ロード処理 (QtConcurrent) ---
+        requestSlideDecode(i);
+    }
+}
+
+void ImageViewController::requestSlideDecode(int index)
+{
+    if (index < 0 || index >= m_slides.size()) return;
+    const quint64 slideId = m_slides[index].slideId;
+    if (m_loadingSlideIds.contains(slideId)) return;
+
+    const QString path = m_slides[index].filePath;
+    const QSize targetSize = m_slides[index].geometry.size().toSize();
+    if (targetSize.isEmpty()) return;
+
+    m_loadingSlideIds.insert(slideId);
 
-        m_loadingIndices.insert(i);
+    // 隣のフォルダの先読みでデコード済みなら、縮小だけをワーカーで行う
+    const QImage prefetched = m_prefetchedImages.take(path);
 
-        QFuture<AsyncLoadResult> future = QtConcurrent::run([i, path, targetSize]() -> AsyncLoadResult {
-            AsyncLoadResult result;
-            result.index = i;
-            result.success = false;
+    QFuture<AsyncLoadResult> future = QtConcurrent::run([index, slideId, path, targetSize, prefetched]() -> AsyncLoadResult {
+        AsyncLoadResult result;
+        result.index = index;
+        result.slideId = slideId;
+        result.targetSize = targetSize;
+        result.success = false;
 
-            if (targetSize.isEmpty()) return result;
+        QElapsedTimer decodeTimer;
+        decodeTimer.start();
 
+        QImage image = prefetched;
+        if (image.isNull()) {
             QImageReader reader(path);
             reader.setAutoTransform(true);
             reader.setScaledSize(targetSize);
+            image = reader.read();
+        }
+        if (image.isNull()) return result;
 
-            QImage image = reader.read();
-            if (image.isNull()) return result;
-
-            if (image.size() != targetSize) {
-                image = image.scaled(targetSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-            }
+        if (image.size() != targetSize) {
+            image = image.scaled(targetSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        }
 
-            result.image = image;
-            result.success = true;
-            return result;
-        });
+        result.image = image;
+        result.success = true;
+        result.decodeMs = decodeTimer.elapsed();
+        return result;
+    });
 
-        auto* watcher = new QFutureWatcher<AsyncLoadResult>();
-        connect(watcher, &QFutureWatcher<AsyncLoadResult>::finished, this, [this, watcher]() {
-            AsyncLoadResult result = watcher->result();
-            onImageLoaded(result);
-            watcher->deleteLater();
-        });
-        watcher->setFuture(future);
-    }
+    auto* watcher = new QFutureWatcher<AsyncLoadResult>();
+    connect(watcher, &QFutureWatcher<AsyncLoadResult>::finished, this, [this, watcher]() {
+        AsyncLoadResult result = watcher->result();
+        onImageLoaded(result);
+        watcher->deleteLater();
+    });
+    watcher->setFuture(future);
 }
 
 void ImageViewController::scrollToImage(int index)
@@ -1523,75 +1722,142 @@ void ImageViewController::scrollToImage(int index)
     m_isProgrammaticScroll = true;
     m_scrollIndexUpdateTimer->stop();
 
-    QRectF targetSlideRect = m_slides.at(index).geometry;
-    QScrollBar* scrollBar = (m_slideDirection == DirectionHorizontal)
-                                ? m_view->horizontalScrollBar()
-                                : m_view->verticalScrollBar();
+    // ★ アニメーションは作り直さず、フレーム駆動の目標だけを差し替える (連打しても速度が途切れない)
+    animateScrollTo(scrollValueForIndex(index), m_slideshowEffect == EffectSlide);
+}
 
+QScrollBar* ImageViewController::panoramaScrollBar() const
+{
+    return (m_slideDirection == DirectionHorizontal) ? m_view->horizontalScrollBar() : m_view->verticalScrollBar();
+}
+
+qreal ImageViewController::scrollValueForIndex(int index) const
+{
+    if (index < 0 || index >= m_slides.size()) return 0.0;
+
+    QRectF targetSlideRect = m_slides.at(index).geometry;
     qreal scale = m_view->transform().m11();
     if (qFuzzyCompare(scale, 0.0)) scale = 1.0;
 
+    // ビューポートのサイズ（ピクセル）
     qreal viewportSize = (m_slideDirection == DirectionHorizontal)
                              ? m_view->viewport()->width()
                              : m_view->viewport()->height();
 
+    // 目標とするスライドの中心（Scene座標）
     qreal targetSceneCenter = (m_slideDirection == DirectionHorizontal)
                                   ? targetSlideRect.center().x()
                                   : targetSlideRect.center().y();
 
-    qreal targetViewCenter = targetSceneCenter * scale;
-    qreal targetScrollValue = targetViewCenter - (viewportSize / 2.0);
-
-    // ★ 修正: 既存アニメーションの確実な停止と破棄
-    if (m_currentScrollAnim) {
-        m_currentScrollAnim->stop();
-        delete m_currentScrollAnim;
-        m_currentScrollAnim = nullptr;
-    }
-
-    if (m_slideshowEffect == EffectSlide) {
-        // 新しいアニメーションを作成
-        m_currentScrollAnim = new QPropertyAnimation(scrollBar, "value", this);
-        m_currentScrollAnim->setDuration(250);
-        m_currentScrollAnim->setEndValue(targetScrollValue);
-        m_currentScrollAnim->setEasingCurve(QEasingCurve::OutQuad);
-
-        // 完了時の処理
-        connect(m_currentScrollAnim, &QPropertyAnimation::finished, this, [this](){
-            // アニメーションが完了したらポインタをクリア
-            // (注: DeleteWhenStoppedによりオブジェクト自体は消えるため、ポインタをnullにする)
-            m_currentScrollAnim = nullptr;
-
-            // 少し待ってからフラグを下ろす (連打の切れ目を判定)
-            QTimer::singleShot(50, this, [this](){
-                // 次のアニメーションが始まっていなければ (ポインタがnullなら) 終了
-                if (m_currentScrollAnim == nullptr) {
-                    m_isProgrammaticScroll = false;
-                    m_logicalTargetIndex = -1; // ここで初めてリセット
-                    m_scrollIndexUpdateTimer->start();
-                }
-            });
-        });
+    // Scene座標をView座標（拡大された座標系）に変換し、中心位置 - 画面半分
+    return targetSceneCenter * scale - (viewportSize / 2.0);
+}
 
-        // 削除はQtの親システム(this)に任せるか、明示的に行うが、
-        // 今回は stop() -> delete を自分で行うため DeleteWhenStopped は使わない、
-        // あるいは finished で deleteLater する。
-        // ここでは安全のため、次の scrollToImage で delete する運用にします。
-        m_currentScrollAnim->start();
+void ImageViewController::queueImageStep(int step)
+{
+    if (step == 0) return;
+    m_pendingImageSteps += step;
+    startScrollDriver();
+}
 
-    } else {
-        // アニメーションなし
-        scrollBar->setValue(targetScrollValue);
-        QTimer::singleShot(50, this, [this](){
-            m_isProgrammaticScroll = false;
-            m_logicalTargetIndex = -1;
-            m_scrollIndexUpdateTimer->start();
-        });
+int ImageViewController::frameIntervalMs() const
+{
+    // 画面のリフレッシュレートに合わせる (取れなければ 60Hz)
+    qreal refreshRate = 60.0;
+    if (QScreen* screen = m_view->screen()) {
+        if (screen->refreshRate() > 1.0) refreshRate = screen->refreshRate();
+    }
+    return qMax(1, qRound(1000.0 / refreshRate));
+}
+
+void ImageViewController::startScrollDriver()
+{
+    if (m_scrollFrameTimer->isActive()) return;
+
+    m_scrollFrameTimer->setInterval(frameIntervalMs());
+    m_scrollFrameClock.start();
+    m_scrollFrameTimer->start();
+}
+
+void ImageViewController::animateScrollTo(qreal value, bool animate)
+{
+    QScrollBar* scrollBar = panoramaScrollBar();
+    m_scrollTargetValue = value;
+
+    if (!animate) {
+        m_scrollAnimating = false;
+        scrollBar->setValue(qRound(value));
+    } else if (!m_scrollAnimating) {
+        // 止まっている状態からは現在位置を起点にする (動いている最中なら速度を保ったまま目標だけ変わる)
+        m_scrollCurrentValue = scrollBar->value();
+        m_scrollFrameClock.start();
+        m_scrollAnimating = true;
+    }
+    m_lastDrivenScrollValue = scrollBar->value();
+
+    // 即時反映の場合も、次のフレームで終了処理 (フラグの解除) を行う
+    startScrollDriver();
+}
+
+void ImageViewController::cancelScrollAnimation()
+{
+    m_scrollAnimating = false;
+    m_pendingImageSteps = 0;
+    m_wheelRemainder = 0;
+}
+
+void ImageViewController::onScrollFrame()
+{
+    // 1. このフレームまでに貯まった入力を1回だけ反映
+    if (m_pendingImageSteps != 0 && m_slideshowMode == ModePictureScroll) {
+        const int step = m_pendingImageSteps;
+        m_pendingImageSteps = 0;
+        stepByImage(step);
+    }
+    m_pendingImageSteps = 0;
+
+    // 2. スクロール位置を目標へ近づける (経過時間ベースなので、フレームが落ちても速度は変わらない)
+    if (m_scrollAnimating) {
+        QScrollBar* scrollBar = panoramaScrollBar();
+        if (scrollBar->value() != m_lastDrivenScrollValue) {
+            // ユーザーがスクロールバーを動かした -> 追従をやめる
+            m_scrollAnimating = false;
+        } else {
+            const qreal dt = qMax<qint64>(1, m_scrollFrameClock.restart());
+            const qreal alpha = 1.0 - qExp(-dt / SCROLL_SMOOTHING_MS);
+            m_scrollCurrentValue += (m_scrollTargetValue - m_scrollCurrentValue) * alpha;
+            if (qAbs(m_scrollTargetValue - m_scrollCurrentValue) < 0.5) {
+                m_scrollCurrentValue = m_scrollTargetValue;
+                m_scrollAnimating = false;
+            }
+
+            const int next = qRound(m_scrollCurrentValue);
+            scrollBar->setValue(next);
+            m_lastDrivenScrollValue = scrollBar->value();
+            // 範囲外の目標 (先頭/末尾) には届かないので打ち切る
+            if (m_lastDrivenScrollValue != next) m_scrollAnimating = false;
+        }
+    }
+
+    if (m_scrollAnimating) return;
+
+    // 3. 動きが止まったら駆動を止め、プログラムによるスクロールの終了を通知
+    m_scrollFrameTimer->stop();
+    if (m_isProgrammaticScroll) {
+        m_isProgrammaticScroll = false;
+        m_logicalTargetIndex = -1;
+        m_scrollIndexUpdateTimer->start();
     }
 }
 
 void ImageViewController::showNextSlide(bool isFirstSlide)
 {
+    // 連続スクロールでは、タイマーはフレームごとの駆動として届く
+    if (!isFirstSlide && isAutoScrollSlideshow()) {
+        advanceAutoScroll();
+        return;
+    }
+
     const QStringList allFiles = getActiveImageList();
     if (allFiles.isEmpty()) { toggleSlideshow(); return; }
 
@@ -1604,11 +1870,8 @@ void ImageViewController::showNextSlide(bool isFirstSlide)
 
     QString nextImagePath = allFiles.at(slideshowCurrentIndex);
     if (m_viewMode == ModeSlideshowList && m_currentSlideshowList) {
-        for (int i = 0; i < m_currentSlideshowList->count(); ++i) {
-            if (m_currentSlideshowList->item(i)->data(Qt::UserRole).toString() == nextImagePath) {
-                m_currentSlideshowList->setCurrentItem(m_currentSlideshowList->item(i));
-                break;
-            }
+        if (QListWidgetItem* item = m_slideshowListIndex->itemForPath(nextImagePath)) {
+            m_currentSlideshowList->setCurrentItem(item);
         }
     }
 
@@ -1621,43 +1884,25 @@ void ImageViewController::showNextSlide(bool isFirstSlide)
         m_filenameEdit->setText(QFileInfo(nextImagePath).fileName()); // ui->filenameLineEdit -> m_filenameEdit
         loadSlidesAround(slideshowCurrentIndex);
 
-        QRectF targetSlideRect = m_slides.at(slideshowCurrentIndex).geometry;
-        QScrollBar* scrollBar = (m_slideDirection == DirectionHorizontal)
-                                    ? m_view->horizontalScrollBar() // ui->mediaView -> m_view
-                                    : m_view->verticalScrollBar();
-        qreal targetScrollValue;
-        qreal scale = m_view->transform().m11(); // ui->mediaView -> m_view
-        if (qFuzzyCompare(scale, 0.0)) scale = 1.0;
-
-        // ビューポートのサイズ（ピクセル）
-        qreal viewportSize = (m_slideDirection == DirectionHorizontal)
-                                 ? m_view->viewport()->width()
-                                 : m_view->viewport()->height();
-
-        // 目標とするスライドの中心（Scene座標）
-        qreal targetSceneCenter = (m_slideDirection == DirectionHorizontal)
-                                      ? targetSlideRect.center().x()
-                                      : targetSlideRect.center().y();
-
-        // Scene座標をView座標（拡大された座標系）に変換
-        qreal targetViewCenter = targetSceneCenter * scale;
+        // スクロールは手動操作と同じフレーム駆動に任せる
+        animateScrollTo(scrollValueForIndex(slideshowCurrentIndex), !isFirstSlide && m_slideshowEffect == EffectSlide);
 
-        // スクロール位置 = 中心位置 - 画面半分
-        targetScrollValue = targetViewCenter - (viewportSize / 2.0);
-
-        if (isFirstSlide || m_slideshowEffect != EffectSlide) {
-            scrollBar->setValue(targetScrollValue);
-        } else {
-            QPropertyAnimation* anim = new QPropertyAnimation(scrollBar, "value", this);
-            anim->setEndValue(targetScrollValue);
-            anim->setDuration(200);
-            anim->setEasingCurve(QEasingCurve::OutQuad);
-            anim->start(QAbstractAnimation::DeleteWhenStopped);
+        if (isFirstSlide && isAutoScrollSlideshow()) {
+            m_autoScrollPosition = m_lastAutoScrollValue = panoramaScrollBar()->value();
+            m_autoScrollClock.invalidate();
+            updateAutoScrollLookahead(slideshowCurrentIndex);
+            loadSlidesAround(slideshowCurrentIndex);
         }
     } else {
         // --- 標準モード ---
         m_filenameEdit->setText(QFileInfo(nextImagePath).fileName()); // ui->filenameLineEdit -> m_filenameEdit
-        QPixmap newPixmap(nextImagePath);
+
+        // 先読み済みならそのまま貼る (間に合わなかった場合だけ同期デコード)
+        const QImage buffered = m_slideshowBuffer.take(nextImagePath);
+        QPixmap newPixmap = QPixmap::fromImage(buffered.isNull() ? readSlideImage(nextImagePath) : buffered);
+
+        // 次の切り替えに向けて、表示したらすぐに次を読み始める
+        prefetchUpcomingSlides(allFiles);
         if (newPixmap.isNull()) return;
 
         if (isFirstSlide || m_slideshowEffect == EffectNone || m_slideshowEffect == EffectSlide) {
@@ -1688,9 +1933,72 @@ void ImageViewController::setImageExtensions(const QStringList& extensions)
     m_imageExtensions = extensions;
 }
 
+void ImageViewController::prefetchUpcomingSlides(const QStringList& allFiles)
+{
+    if (m_slideshowMode != ModeStandard || allFiles.isEmpty()) return;
+
+    // 次に表示される数枚 (末尾では先頭に戻る)
+    QStringList upcoming;
+    for (int i = 1; i <= SLIDESHOW_PREFETCH_COUNT && i < allFiles.size(); ++i) {
+        upcoming.append(allFiles.at((slideshowCurrentIndex + i) % allFiles.size()));
+    }
+
+    // 予定から外れたものは捨てる (手動で位置を変えた場合など)
+    for (auto it = m_slideshowBuffer.begin(); it != m_slideshowBuffer.end();) {
+        if (!upcoming.contains(it.key())) it = m_slideshowBuffer.erase(it);
+        else ++it;
+    }
+
+    const quint64 generation = m_slideshowBufferGeneration;
+    for (const QString& path : std::as_const(upcoming)) {
+        if (m_slideshowBuffer.contains(path) || m_slideshowBufferPending.contains(path)) continue;
+        if (isAnimatedImage(path)) continue;
+
+        // 隣のフォルダの先読みでデコード済みならそれを使う
+        if (m_prefetchedImages.contains(path)) {
+            m_slideshowBuffer.insert(path, m_prefetchedImages.take(path));
+            continue;
+        }
+
+        m_slideshowBufferPending.insert(path);
+        auto watcher = new QFutureWatcher<QImage>(this);
+        connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, path, generation]() {
+            watcher->deleteLater();
+            // 停止・リスト変更後の結果は捨てる
+            if (generation != m_slideshowBufferGeneration) return;
+            m_slideshowBufferPending.remove(path);
+
+            const QImage image = watcher->result();
+            if (image.isNull() || !slideshowTimer->isActive()) return;
+            m_slideshowBuffer.insert(path, image);
+        });
+        watcher->setFuture(QtConcurrent::run([path]() { return readSlideImage(path); }));
+    }
+}
+
+QImage ImageViewController::readSlideImage(const QString& path)
+{
+    // ★ 先読みが間に合わなかったときも同じ読み方にする (向きがタイミングで変わらないように)
+    QImageReader reader(path);
+    reader.setAutoTransform(true);
+    QImage image = reader.read();
+    if (image.isNull()) return image;
+    // QPixmap::fromImage で変換が起きない形式にしておく (切り替え時の処理を貼るだけにする)
+    return image.convertToFormat(image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied
+                                                         : QImage::Format_RGB32);
+}
+
+void ImageViewController::clearSlideshowBuffer()
+{
+    ++m_slideshowBufferGeneration;
+    m_slideshowBuffer.clear();
+    m_slideshowBufferPending.clear();
+}
+
 void ImageViewController::stepByImage(int step)
 {
-    const int count = getActiveImageList().size();
+    const QStringList allFiles = getActiveImageList();
+    const int count = allFiles.size();
     if (count <= 0) return;
 
     // 1. 基準となるインデックスを決定
@@ -1706,10 +2014,15 @@ void ImageViewController::stepByImage(int step)
     // 2. 次のインデックスを計算
     int nextIndex = baseIndex + step;
 
-    // 3. ループ処理
+    // 3. ループ処理 (設定があれば隣のフォルダへ進む)
+    if (nextIndex >= count || nextIndex < 0) {
+        if (continueToSiblingDirectory(nextIndex >= count ? 1 : -1)) return;
+    }
     if (nextIndex >= count) nextIndex = 0;
     else if (nextIndex < 0) nextIndex = count - 1;
 
+    maybePrefetchSiblingDirectory(nextIndex, count);
+
     qDebug() << "[IVC] stepByImage. Step:" << step
              << "Base:" << baseIndex << "->" << nextIndex
              << "(Logical:" << m_logicalTargetIndex << ")";
@@ -1728,7 +2041,6 @@ void ImageViewController::stepByImage(int step)
         scrollToImage(nextIndex);
 
         // ▼▼▼ 追加: シグナルをブロックしたため、ここで手動でUI更新と通知を行う ▼▼▼
-        const QStringList allFiles = getActiveImageList();
         if (nextIndex >= 0 && nextIndex < allFiles.size()) {
             QString path = allFiles.at(nextIndex);
 
@@ -1742,13 +2054,7 @@ void ImageViewController::stepByImage(int step)
 
             // 3. スライドショーリストモードならハイライトも同期
             if (m_viewMode == ModeSlideshowList && m_currentSlideshowList) {
-                QListWidgetItem* itemToHighlight = nullptr;
-                for (int i = 0; i < m_currentSlideshowList->count(); ++i) {
-                    if (m_currentSlideshowList->item(i)->data(Qt::UserRole).toString() == path) {
-                        itemToHighlight = m_currentSlideshowList->item(i);
-                        break;
-                    }
-                }
+                QListWidgetItem* itemToHighlight = m_slideshowListIndex->itemForPath(path);
                 // ハイライトの更新
                 if (itemToHighlight) {
                     emit setItemHighlighted(m_currentlyDisplayedSlideItem, false);
@@ -1761,35 +2067,377 @@ void ImageViewController::stepByImage(int step)
     }
 }
 
-void ImageViewController::sortFileInfos(QFileInfoList &list)
+QStringList ImageViewController::imageNameFilters() const
 {
-    if (m_currentSortMode == SortShuffle) {
-        auto *generator = QRandomGenerator::global();
-        for (int i = 0; i < list.size(); ++i) {
-            int j = generator->bounded(list.size());
-            list.swapItemsAt(i, j);
-        }
-        return;
+    QStringList filters;
+    for (const QString& ext : m_imageExtensions) {
+        filters << "*." + ext;
     }
+    return filters;
+}
 
-    std::sort(list.begin(), list.end(), [this](const QFileInfo &a, const QFileInfo &b) -> bool {
-        bool result = true;
-        switch (m_currentSortMode) {
-        case SortName:
-            // QCollator で "1.jpg, 2.jpg, 10.jpg" の順序を実現
-            result = (m_collator.compare(a.fileName(), b.fileName()) < 0);
-            break;
-        case SortDate:
-            result = (a.lastModified() < b.lastModified());
-            break;
-        case SortSize:
-            result = (a.size() < b.size());
-            break;
-        default:
+void ImageViewController::setAutoScrollSpeed(int pixelsPerSecond)
+{
+    m_autoScrollSpeed = qMax(0, pixelsPerSecond);
+    if (m_autoScrollSpeed == 0) m_preloadAhead = 0;
+
+    // 実行中なら新しい駆動間隔で続ける (位置は現在のスクロールから)
+    if (slideshowTimer->isActive() && m_slideshowMode == ModePictureScroll) {
+        m_autoScrollPosition = m_lastAutoScrollValue = panoramaScrollBar()->value();
+        m_autoScrollClock.invalidate();
+        slideshowTimer->start(slideshowTimerInterval());
+        slideshowElapsedTimer.restart();
+        m_progressBar->setValue(0);
+    }
+}
+
+bool ImageViewController::isAutoScrollSlideshow() const
+{
+    return m_slideshowMode == ModePictureScroll && m_autoScrollSpeed > 0;
+}
+
+int ImageViewController::slideshowTimerInterval() const
+{
+    if (isAutoScrollSlideshow()) return frameIntervalMs();
+    return static_cast<int>(m_slideshowInterval * 1000.0);
+}
+
+void ImageViewController::advanceAutoScroll()
+{
+    if (m_slides.isEmpty()) return;
+
+    QScrollBar* scrollBar = panoramaScrollBar();
+
+    // ホイール等の手動スクロール中は任せ、終わった位置から続ける
+    if (m_scrollAnimating || scrollBar->value() != m_lastAutoScrollValue) {
+        m_autoScrollPosition = m_lastAutoScrollValue = scrollBar->value();
+        m_autoScrollClock.invalidate();
+        if (m_scrollAnimating) return;
+    }
+
+    // 経過時間ベースで進める (フレームが落ちても速度は一定)
+    qint64 dt = 0;
+    if (m_autoScrollClock.isValid()) {
+        dt = qMin<qint64>(m_autoScrollClock.restart(), AUTO_SCROLL_MAX_STEP_MS);
+    } else {
+        m_autoScrollClock.start();
+    }
+
+    // 右→左レイアウトではインデックスが進むほどスクロール値が減る
+    const qreal direction = (scrollValueForIndex(m_slides.size() - 1) >= scrollValueForIndex(0)) ? 1.0 : -1.0;
+    const qreal endValue = (direction > 0) ? scrollBar->maximum() : scrollBar->minimum();
+
+    if (qAbs(m_autoScrollPosition - endValue) < 0.5) {
+        // 末尾まで来たら先頭に戻る (1枚ずつのスライドショーと同じ)
+        m_autoScrollPosition = qBound<qreal>(scrollBar->minimum(), scrollValueForIndex(0), scrollBar->maximum());
+    } else {
+        m_autoScrollPosition += direction * m_autoScrollSpeed * dt / 1000.0;
+        m_autoScrollPosition = qBound<qreal>(scrollBar->minimum(), m_autoScrollPosition, scrollBar->maximum());
+    }
+
+    scrollBar->setValue(qRound(m_autoScrollPosition));
+    m_lastAutoScrollValue = scrollBar->value();
+
+    // 現在位置の確定と先読みは毎フレームではなく間引いて行う
+    // (スクロール変更のデバウンスは動き続ける間は発火しないので、ここで直接呼ぶ)
+    if (!m_autoScrollIndexClock.isValid() || m_autoScrollIndexClock.elapsed() >= SCROLL_UPDATE_INTERVAL) {
+        m_autoScrollIndexClock.start();
+        m_scrollIndexUpdateTimer->stop();
+        updateAutoScrollLookahead(m_viewControlSlider->value());
+        updateSlideshowIndexFromScroll();
+        slideshowCurrentIndex = m_viewControlSlider->value();
+    }
+}
+
+void ImageViewController::updateAutoScrollLookahead(int index)
+{
+    if (index < 0 || index >= m_slides.size()) return;
+
+    // デコードが間に合うように、「速度 × デコード時間 (余裕込み) + 画面1枚分」先まで読む
+    const qreal latencyMs = qMax(m_slideDecodeLatencyMs, AUTO_SCROLL_MIN_LATENCY_MS) * AUTO_SCROLL_LATENCY_MARGIN;
+    const qreal viewportSize = (m_slideDirection == DirectionHorizontal)
+                                   ? m_view->viewport()->width()
+                                   : m_view->viewport()->height();
+    const qreal needed = m_autoScrollSpeed * latencyMs / 1000.0 + viewportSize;
+
+    qreal scale = m_view->transform().m11();
+    if (qFuzzyCompare(scale, 0.0)) scale = 1.0;
+
+    int ahead = 0;
+    qreal covered = 0.0;
+    for (int i = index + 1; i < m_slides.size() && covered < needed && ahead < AUTO_SCROLL_MAX_LOOKAHEAD; ++i, ++ahead) {
+        const QRectF& geometry = m_slides.at(i).geometry;
+        covered += ((m_slideDirection == DirectionHorizontal) ? geometry.width() : geometry.height()) * scale;
+    }
+    m_preloadAhead = ahead;
+}
+
+void ImageViewController::setContinueToSiblingDirectory(bool enabled)
+{
+    m_continueToSiblingDirectory = enabled;
+    if (!enabled) {
+        m_siblingPrefetchedFor.clear();
+        m_prefetchedSiblingDir.clear();
+        m_noPreviousSiblingFor.clear();
+        m_prefetchedImages.clear();
+        m_siblingContinueDirection = 0;
+    }
+}
+
+QString ImageViewController::findSiblingDirectory(const QString& dirPath, int direction, const QStringList& filters,
+                                                  SortMode sortMode, bool ascending)
+{
+    // ※ ワーカースレッドからも呼ばれる。メンバには触らないこと
+    QDir parent(dirPath);
+    if (!parent.cdUp()) return QString();
+
+    // 兄弟フォルダを現在のソート順で並べる (シャッフル時は名前順)
+    QFileInfoList siblings = parent.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    FileSorter::sort(siblings, sortMode == SortShuffle ? SortName : sortMode, ascending);
+
+    const QString self = DirectorySnapshotCache::normalizedPath(dirPath);
+    int index = -1;
+    for (int i = 0; i < siblings.size(); ++i) {
+        if (DirectorySnapshotCache::normalizedPath(siblings[i].absoluteFilePath()) == self) {
+            index = i;
             break;
         }
-        return m_sortAscending ? result : !result;
+    }
+    if (index < 0) return QString();
+
+    // 画像を含む最初のフォルダ (中身は1件見つかれば十分)
+    int tried = 0;
+    for (int i = index + direction; i >= 0 && i < siblings.size() && tried < MAX_SIBLING_SEARCH; i += direction, ++tried) {
+        QDirIterator it(siblings[i].absoluteFilePath(), filters, QDir::Files);
+        if (it.hasNext()) return QDir::fromNativeSeparators(siblings[i].absoluteFilePath());
+    }
+    return QString();
+}
+
+ImageViewController::SiblingPrefetchResult ImageViewController::prefetchSiblingDirectory(const QString& dirPath, int direction,
+                                                                                         const QStringList& filters,
+                                                                                         SortMode sortMode, bool ascending, int pageCount)
+{
+    // ※ ワーカースレッドで実行される。メンバには触らないこと
+    SiblingPrefetchResult result;
+    result.fromDir = DirectorySnapshotCache::normalizedPath(dirPath);
+    result.direction = direction;
+    result.siblingDir = findSiblingDirectory(dirPath, direction, filters, sortMode, ascending);
+    if (result.siblingDir.isEmpty()) return result;
+
+    // 一覧 (取り消しはしない)
+    result.listing = listDirectory(result.siblingDir, filters, nullptr, sortMode, ascending,
+                                   0, QSharedPointer<QAtomicInt>(new QAtomicInt(0)));
+
+    // 最初に表示するページをデコードしておく (シャッフルは実際の並びが変わるので一覧のみ)
+    if (sortMode != SortShuffle) {
+        const QStringList& files = result.listing.files;
+        for (int i = 0; i < pageCount && i < files.size(); ++i) {
+            const QString& path = (direction > 0) ? files.at(i) : files.at(files.size() - 1 - i);
+            QImageReader reader(path);
+            reader.setAutoTransform(true);
+            if (reader.supportsAnimation() && reader.imageCount() > 1) continue; // アニメーションは QMovie で読む
+            const QImage image = reader.read();
+            if (!image.isNull()) result.images.insert(path, image);
+        }
+    }
+    return result;
+}
+
+void ImageViewController::maybePrefetchSiblingDirectory(int currentIndex, int count)
+{
+    if (!m_continueToSiblingDirectory || m_viewMode != ModeDirectoryBrowse || m_isDirectoryLoading) return;
+    if (m_siblingPrefetchInFlight || count - 1 - currentIndex > SIBLING_PREFETCH_THRESHOLD) return;
+
+    const QString dirKey = DirectorySnapshotCache::normalizedPath(m_currentBrowsePath);
+    if (m_siblingPrefetchedFor == dirKey) return;
+
+    startSiblingPrefetch(1, SIBLING_PREFETCH_PAGES);
+}
+
+void ImageViewController::startSiblingPrefetch(int direction, int pageCount)
+{
+    m_siblingPrefetchInFlight = true;
+    const QString dirPath = m_currentBrowsePath;
+    const QStringList filters = imageNameFilters();
+    const SortMode sortMode = m_currentSortMode;
+    const bool ascending = m_sortAscending;
+
+    auto* watcher = new QFutureWatcher<SiblingPrefetchResult>(this);
+    connect(watcher, &QFutureWatcher<SiblingPrefetchResult>::finished, this, [this, watcher]() {
+        m_siblingPrefetchInFlight = false;
+        onSiblingPrefetched(watcher->result());
+        watcher->deleteLater();
     });
+    watcher->setFuture(QtConcurrent::run([=]() {
+        return prefetchSiblingDirectory(dirPath, direction, filters, sortMode, ascending, pageCount);
+    }));
+}
+
+void ImageViewController::onSiblingPrefetched(const SiblingPrefetchResult& result)
+{
+    const int pending = std::exchange(m_siblingContinueDirection, 0);
+
+    // 先読み中に別のフォルダへ移動していたら捨てる
+    if (result.fromDir != DirectorySnapshotCache::normalizedPath(m_currentBrowsePath)) return;
+
+    if (result.direction > 0) {
+        m_siblingPrefetchedFor = result.fromDir;
+        m_prefetchedSiblingDir = result.siblingDir;
+    } else if (result.siblingDir.isEmpty()) {
+        m_noPreviousSiblingFor = result.fromDir;
+    }
+    if (!result.siblingDir.isEmpty()) {
+        m_prefetchedImages = result.images;
+
+        // ★ 一覧をキャッシュに入れておけば、browseTo はディスクに触れずに同期で切り替わる
+        const QString siblingKey = DirectorySnapshotCache::normalizedPath(result.siblingDir);
+        if (m_directoryCache && m_directoryCache->nameFilters() == imageNameFilters()) {
+            if (!m_directoryCache->contains(siblingKey)) m_directoryCache->store(siblingKey, result.listing.snapshot);
+            // 先読み中にソート条件が変わっていれば、古い並びはキャッシュしない
+            if (m_currentSortMode != SortShuffle && result.listing.sortMode == m_currentSortMode
+                && result.listing.ascending == m_sortAscending) {
+                if (m_sortedDirectoryCache.size() >= MAX_SORTED_DIRECTORY_CACHE) m_sortedDirectoryCache.clear();
+                m_sortedDirectoryCache.insert(siblingKey, result.listing.files);
+            }
+        }
+        qDebug() << "[IVC] Sibling directory prefetched:" << result.siblingDir
+                 << "Files:" << result.listing.files.size() << "Decoded:" << result.images.size();
+    }
+
+    // 端で待っていた移動を続ける
+    if (pending == 0) return;
+    if (pending != result.direction) {
+        continueToSiblingDirectory(pending); // 反対向きはまだ探していない
+    } else if (result.siblingDir.isEmpty()) {
+        stepByImage(pending); // 隣が無ければ、これまでどおりフォルダ内で折り返す
+    } else {
+        enterSiblingDirectory(result.siblingDir, pending, result.listing.files);
+    }
+}
+
+bool ImageViewController::continueToSiblingDirectory(int direction)
+{
+    if (!m_continueToSiblingDirectory || m_viewMode != ModeDirectoryBrowse || m_currentBrowsePath.isEmpty()) return false;
+
+    const QString dirKey = DirectorySnapshotCache::normalizedPath(m_currentBrowsePath);
+
+    // 先読み済みならすぐに切り替える (一覧はキャッシュ済み)
+    if (direction > 0 && m_siblingPrefetchedFor == dirKey) {
+        if (m_prefetchedSiblingDir.isEmpty()) return false;
+        enterSiblingDirectory(m_prefetchedSiblingDir, direction, QStringList());
+        return true;
+    }
+    if (direction < 0 && m_noPreviousSiblingFor == dirKey) return false;
+
+    // ★ 分かっていなければ、探索と一覧はワーカーで行い、届いたら切り替える (それまでは今のページに留まる)
+    //    次のフォルダの先読みが走っていれば、その完了を待つ
+    m_siblingContinueDirection = direction;
+    if (!m_siblingPrefetchInFlight) startSiblingPrefetch(direction, 0);
+    return true;
+}
+
+void ImageViewController::enterSiblingDirectory(const QString& sibling, int direction, const QStringList& files)
+{
+    // 開くページ: 進むなら先頭、戻るなら末尾
+    const QStringList& list = files.isEmpty() ? m_sortedDirectoryCache.value(DirectorySnapshotCache::normalizedPath(sibling))
+                                              : files;
+    QString target;
+    if (!list.isEmpty()) target = (direction > 0) ? list.first() : list.last();
+
+    qDebug() << "[IVC] Continue to sibling directory:" << sibling << "Target:" << target;
+    m_siblingPrefetchedFor.clear();
+    m_prefetchedSiblingDir.clear();
+    m_noPreviousSiblingFor.clear();
+    browseTo(sibling, target, true);
+}
+
+void ImageViewController::setDirectoryCache(DirectorySnapshotCache* cache)
+{
+    if (m_directoryCache) disconnect(m_directoryCache, nullptr, this, nullptr);
+    m_directoryCache = cache;
+    m_sortedDirectoryCache.clear();
+    if (m_directoryCache) {
+        connect(m_directoryCache, &DirectorySnapshotCache::directoryUpdated, this, &ImageViewController::onDirectoryUpdated);
+    }
+}
+
+void ImageViewController::onDirectoryUpdated(const QString& dirPath, const QFileInfoList& addedFiles, const QStringList& removedFiles,
+                                             const QFileInfoList& addedDirs, const QStringList& removedDirs)
+{
+    Q_UNUSED(addedDirs);
+    Q_UNUSED(removedDirs);
+    if (addedFiles.isEmpty() && removedFiles.isEmpty()) return;
+
+    // 表示中でないディレクトリは、ソート済み一覧を捨てるだけ (次回はキャッシュから再ソート)
+    const bool isCurrent = (dirPath == DirectorySnapshotCache::normalizedPath(m_currentBrowsePath));
+    if (!isCurrent || m_isDirectoryLoading) {
+        m_sortedDirectoryCache.remove(dirPath);
+        return;
+    }
+
+    qDebug() << "[IVC] Live update:" << dirPath << "+" << addedFiles.size() << "-" << removedFiles.size();
+
+    // 差分適用の前に、表示中のファイルを覚えておく
+    const QString anchorPath = getCurrentFilePath();
+
+    // 1. 削除
+    if (!removedFiles.isEmpty()) {
+        const QSet<QString> removed(removedFiles.cbegin(), removedFiles.cend());
+        m_directoryFiles.erase(std::remove_if(m_directoryFiles.begin(), m_directoryFiles.end(),
+                                              [&removed](const QString& p) { return removed.contains(p); }),
+                               m_directoryFiles.end());
+    }
+
+    // 2. 追加 (ソート済みの位置へ二分探索で挿入。シャッフル時はランダムな位置へ)
+    for (const QFileInfo& fi : addedFiles) {
+        const QString path = QDir::fromNativeSeparators(fi.absoluteFilePath());
+        int pos;
+        if (m_currentSortMode == SortShuffle) {
+            pos = QRandomGenerator::global()->bounded(m_directoryFiles.size() + 1);
+        } else {
+            auto it = std::lower_bound(m_directoryFiles.begin(), m_directoryFiles.end(), fi,
+                                       [this](const QString& existing, const QFileInfo& value) {
+                                           return FileSorter::lessThan(QFileInfo(existing), value, m_currentSortMode, m_sortAscending, m_collator);
+                                       });
+            pos = int(it - m_directoryFiles.begin());
+        }
+        m_directoryFiles.insert(pos, path);
+    }
+
+    m_directoryIndex->setFiles(m_directoryFiles);
+    if (m_currentSortMode != SortShuffle) {
+        m_sortedDirectoryCache.insert(dirPath, m_directoryFiles);
+    } else {
+        m_sortedDirectoryCache.remove(dirPath);
+    }
+
+    // 3. 表示へ反映 (スライドショーリスト表示中は一覧の更新のみ)
+    if (m_viewMode != ModeDirectoryBrowse) return;
+
+    int index = m_directoryIndex->indexOf(anchorPath);
+
+    if (m_slideshowMode == ModePictureScroll) {
+        if (!syncPanoramaSlides(m_directoryFiles)) {
+            setupPictureScroll(m_directoryFiles);
+        }
+        if (index < 0) index = qBound(0, m_viewControlSlider->value(), qMax(0, m_directoryFiles.size() - 1));
+        updateViewControlSliderState(index, m_directoryFiles.count());
+        positionScrollAtIndex(index);
+    } else if (index >= 0) {
+        updateViewControlSliderState(index, m_directoryFiles.count());
+    } else if (!slideshowTimer->isActive()) {
+        // 表示中のファイルが消えた場合は、同じ位置の画像へ
+        const int fallback = qMin(m_viewControlSlider->value(), m_directoryFiles.size() - 1);
+        displayMedia(fallback >= 0 ? m_directoryFiles.at(fallback) : QString());
+    }
+
+    if (m_directoryFiles.isEmpty()) {
+        m_emptyDirectoryLabel->show();
+        updateOverlayLayout();
+    } else {
+        m_emptyDirectoryLabel->hide();
+    }
 }
 
 void ImageViewController::stopCurrentMovie()
@@ -1833,6 +2481,17 @@ void ImageViewController::updateOverlayLayout()
 
 void ImageViewController::updateSlideshowProgress()
 {
+    // 連続スクロールでは全体のうちどこまで進んだかを表示
+    if (isAutoScrollSlideshow()) {
+        QScrollBar* scrollBar = panoramaScrollBar();
+        const int range = scrollBar->maximum() - scrollBar->minimum();
+        if (range <= 0) return;
+        qreal ratio = qreal(scrollBar->value() - scrollBar->minimum()) / range;
+        if (scrollValueForIndex(m_slides.size() - 1) < scrollValueForIndex(0)) ratio = 1.0 - ratio;
+        m_progressBar->setValue(qRound(ratio * 1000.0));
+        return;
+    }
+
     double duration = m_slideshowInterval * 1000.0;
     if (duration <= 0) return;
     qint64 elapsed = slideshowElapsedTimer.elapsed();
@@ -1855,8 +2514,8 @@ void ImageViewController::updateSlideshowIndexFromScroll()
                                 ? m_view->horizontalScrollBar()
                                 : m_view->verticalScrollBar();
 
-    QPropertyAnimation* currentAnim = scrollBar->findChild<QPropertyAnimation*>();
-    if (currentAnim && currentAnim->state() == QAbstractAnimation::Running) {
+    // フレーム駆動のスクロール中は確定しない
+    if (m_scrollAnimating) {
         return;
     }
 
@@ -1906,13 +2565,7 @@ void ImageViewController::updateSlideshowIndexFromScroll()
 
         if (m_viewMode == ModeSlideshowList && m_currentSlideshowList) {
             QString path = m_slides.at(bestIndex).filePath;
-            QListWidgetItem* itemToHighlight = nullptr;
-            for (int i = 0; i < m_currentSlideshowList->count(); ++i) {
-                if (m_currentSlideshowList->item(i)->data(Qt::UserRole).toString() == path) {
-                    itemToHighlight = m_currentSlideshowList->item(i);
-                    break;
-                }
-            }
+            QListWidgetItem* itemToHighlight = m_slideshowListIndex->itemForPath(path);
             if (itemToHighlight) {
                 emit setItemHighlighted(m_currentlyDisplayedSlideItem, false);
                 m_currentlyDisplayedSlideItem = itemToHighlight;
@@ -1944,9 +2597,9 @@ void ImageViewController::updateViewControlSliderState(int currentIndex, int cou
         if (indexToSet < 0) {
             const QStringList& allFiles = getActiveImageList();
             if (m_viewMode == ModeSlideshowList && m_currentSlideshowList && m_currentSlideshowList->currentItem()) {
-                indexToSet = allFiles.indexOf(m_currentSlideshowList->currentItem()->data(Qt::UserRole).toString());
+                indexToSet = indexOfActiveImage(m_currentSlideshowList->currentItem()->data(Qt::UserRole).toString());
             } else {
-                indexToSet = allFiles.indexOf(m_filenameEdit->text()); // ui->filenameLineEdit -> m_filenameEdit
+                indexToSet = indexOfActiveImage(m_filenameEdit->text()); // ui->filenameLineEdit -> m_filenameEdit
             }
         }
         if (indexToSet < 0) indexToSet = 0;
@@ -2036,62 +2689,185 @@ void ImageViewController::browseTo(const QString& path, const QString& fileToSel
         addPathToHistory(path);
     }
 
-    QDir dir(path);
+    emit currentDirectoryChanged(m_currentBrowsePath);
+
+    bool canUp = !getParentPath(m_currentBrowsePath).isEmpty();
+    bool canBack = (m_historyIndex > 0);
+    bool canForward = (m_historyIndex < m_history.count() - 1);
+    emit navigationStateChanged(canBack, canForward, canUp);
+
+    // ★ 検索対象のパスも標準化する
+    const QString normTarget = QDir::fromNativeSeparators(fileToSelectPath);
+
+    // ★ 一覧の取得・ソートはワーカーで行う。新しいナビゲーションが来たら世代番号で古い結果を捨てる
+    const int generation = m_browseGeneration->fetchAndAddOrdered(1) + 1;
+    m_pendingSelectPath = normTarget;
+
+    // ★ 監視中のキャッシュにソート済みの一覧があれば、ディスクに触れずに即座に反映する (履歴移動など)
+    const QString dirKey = DirectorySnapshotCache::normalizedPath(path);
+    const bool hasSnapshot = m_directoryCache && m_directoryCache->contains(dirKey);
+    if (hasSnapshot && m_currentSortMode != SortShuffle && m_sortedDirectoryCache.contains(dirKey)) {
+        DirectoryLoadResult result;
+        result.generation = generation;
+        result.path = path;
+        result.files = m_sortedDirectoryCache.value(dirKey);
+        result.sortMode = m_currentSortMode;
+        result.ascending = m_sortAscending;
+        m_isDirectoryLoading = true;
+        onDirectoryLoaded(result);
+        return;
+    }
+    m_isDirectoryLoading = true;
+
+    // 1. 一覧が揃う前に、指定ファイルだけ先に表示する (パスが分かっていればデコードは始められる)
+    m_directoryFiles.clear();
+    if (!normTarget.isEmpty() && QFileInfo::exists(normTarget)) {
+        m_directoryFiles << normTarget;
+    }
+    m_directoryIndex->setFiles(m_directoryFiles);
+
+    if (!m_directoryFiles.isEmpty()) {
+        if (m_slideshowMode == ModePictureScroll) {
+            setupPictureScroll(m_directoryFiles);
+            positionScrollAtIndex(0);
+        } else {
+            displayMedia(normTarget);
+        }
+        m_filenameEdit->setText(QFileInfo(normTarget).fileName());
+        m_emptyDirectoryLabel->hide();
+    } else {
+        setLoading(true);
+    }
+
+    // 2. バックグラウンドで一覧を取得
     QStringList filters;
     for (const QString& ext : m_imageExtensions) {
         filters << "*." + ext;
     }
 
-    m_directoryFiles.clear();
-    // 以前: QFileInfoList fileInfos = dir.entryInfoList(filters, QDir::Files, QDir::Name | QDir::LocaleAware);
+    const SortMode sortMode = m_currentSortMode;
+    const bool ascending = m_sortAscending;
+    QSharedPointer<QAtomicInt> latestGeneration = m_browseGeneration;
+    // キャッシュに一覧だけある場合 (ソート条件が変わった等) はソートのみワーカーで行う
+    const DirectorySnapshotCache::Snapshot cachedSnapshot = hasSnapshot ? m_directoryCache->snapshot(dirKey)
+                                                                        : DirectorySnapshotCache::Snapshot();
 
-    // ソート指定なしでファイルリストを取得
-    QFileInfoList fileInfos = dir.entryInfoList(filters, QDir::Files);
+    QFuture<DirectoryLoadResult> future = QtConcurrent::run([=]() -> DirectoryLoadResult {
+        return listDirectory(path, filters, hasSnapshot ? &cachedSnapshot : nullptr,
+                             sortMode, ascending, generation, latestGeneration);
+    });
 
-    // 自前のソート関数を通す (ここで自然順ソートなどが適用される)
-    sortFileInfos(fileInfos);
+    auto* watcher = new QFutureWatcher<DirectoryLoadResult>(this);
+    connect(watcher, &QFutureWatcher<DirectoryLoadResult>::finished, this, [this, watcher]() {
+        DirectoryLoadResult result = watcher->result();
+        watcher->deleteLater();
+        onDirectoryLoaded(result);
+    });
+    watcher->setFuture(future);
+}
 
-    // ソート済みの結果をリストに格納
-    // ★ リスト作成時にパスを標準化 (fromNativeSeparators) しておく (既存の修正を維持)
-    for (const QFileInfo& fi : fileInfos) {
-        m_directoryFiles << QDir::fromNativeSeparators(fi.absoluteFilePath());
+ImageViewController::DirectoryLoadResult ImageViewController::listDirectory(const QString& path, const QStringList& filters,
+                                                                            const DirectorySnapshotCache::Snapshot* cachedSnapshot,
+                                                                            SortMode sortMode, bool ascending,
+                                                                            int generation, QSharedPointer<QAtomicInt> latestGeneration)
+{
+    // ※ ワーカースレッドで実行される。メンバには触らないこと
+    DirectoryLoadResult result;
+    result.generation = generation;
+    result.path = path;
+    result.sortMode = sortMode;
+    result.ascending = ascending;
+
+    auto isCancelled = [&]() { return latestGeneration->loadAcquire() != generation; };
+
+    // ソート指定なしでファイルリストを取得 (大きなフォルダの途中でも、新しいナビゲーションが来たら打ち切る)
+    if (cachedSnapshot) {
+        result.snapshot = *cachedSnapshot;
+    } else {
+        result.snapshot = DirectorySnapshotCache::scan(path, filters, isCancelled);
+        result.scannedFromDisk = true;
     }
 
-    emit currentDirectoryChanged(m_currentBrowsePath);
+    if (isCancelled()) {
+        result.cancelled = true;
+        return result;
+    }
 
-    bool canUp = !getParentPath(m_currentBrowsePath).isEmpty();
-    bool canBack = (m_historyIndex > 0);
-    bool canForward = (m_historyIndex < m_history.count() - 1);
-    emit navigationStateChanged(canBack, canForward, canUp);
+    // 共通のソート関数を通す (ここで自然順ソートなどが適用される)
+    QFileInfoList fileInfos = result.snapshot.imageFiles;
+    FileSorter::sort(fileInfos, sortMode, ascending);
 
-    // ★ 検索対象のパスも標準化する
-    QString normTarget = QDir::fromNativeSeparators(fileToSelectPath);
+    // ★ リスト作成時にパスを標準化 (fromNativeSeparators) しておく
+    result.files.reserve(fileInfos.size());
+    for (const QFileInfo& fi : std::as_const(fileInfos)) {
+        result.files << QDir::fromNativeSeparators(fi.absoluteFilePath());
+    }
+    return result;
+}
 
-    if (m_slideshowMode == ModePictureScroll) {
-        // --- パノラマモード ---
-        setupPictureScroll(m_directoryFiles);
-
-        int index = 0;
-        if (!normTarget.isEmpty()) {
-            // 1. 完全一致検索 (リスト側も標準化済みなのでヒット率向上)
-            index = m_directoryFiles.indexOf(normTarget);
-
-            // 2. それでもダメなら大文字小文字無視で比較
-            if (index == -1) {
-                for (int i = 0; i < m_directoryFiles.size(); ++i) {
-                    if (QString::compare(m_directoryFiles[i], normTarget, Qt::CaseInsensitive) == 0) {
-                        index = i;
-                        break;
-                    }
+void ImageViewController::onDirectoryLoaded(const DirectoryLoadResult& result)
+{
+    const QString dirKey = DirectorySnapshotCache::normalizedPath(result.path);
+
+    // 読み終わった一覧は、古い世代でもキャッシュには登録しておく (戻る/進むで使う)
+    // ★ ただしソート済み一覧は、読み込み中にソート条件が変わっていれば登録しない (古い並びが戻る/進むで出てしまう)
+    if (!result.cancelled && m_directoryCache) {
+        if (result.scannedFromDisk) m_directoryCache->store(dirKey, result.snapshot);
+        if (m_currentSortMode != SortShuffle && result.sortMode == m_currentSortMode && result.ascending == m_sortAscending) {
+            if (m_sortedDirectoryCache.size() >= MAX_SORTED_DIRECTORY_CACHE) m_sortedDirectoryCache.clear();
+            m_sortedDirectoryCache.insert(dirKey, result.files);
+        }
+    }
+
+    // 新しいナビゲーションで置き換えられた結果は捨てる
+    if (result.cancelled || result.generation != m_browseGeneration->loadAcquire()) {
+        qDebug() << "[IVC] Stale directory listing discarded:" << result.path;
+        return;
+    }
+    m_isDirectoryLoading = false;
+
+    qDebug() << "[IVC] Directory listing finished:" << result.path << "Files:" << result.files.size();
+
+    setLoading(false);
+
+    m_directoryFiles = result.files;
+    m_directoryIndex->setFiles(m_directoryFiles);
+
+    // 読み込み中にスライドショーリストへ切り替えられた場合は表示に触らない
+    if (m_viewMode != ModeDirectoryBrowse) return;
+
+    QString normTarget = m_pendingSelectPath;
+    m_pendingSelectPath.clear();
+
+    int index = -1;
+    if (!normTarget.isEmpty()) {
+        // 1. 完全一致検索 (リスト側も標準化済みなのでヒット率向上)
+        index = m_directoryIndex->indexOf(normTarget);
+
+        // 2. それでもダメなら大文字小文字無視で比較
+        if (index == -1) {
+            for (int i = 0; i < m_directoryFiles.size(); ++i) {
+                if (QString::compare(m_directoryFiles[i], normTarget, Qt::CaseInsensitive) == 0) {
+                    normTarget = m_directoryFiles[i]; // 見つかった正しいパスで上書き
+                    index = i;
+                    break;
                 }
             }
+        }
 
-            // デバッグ出力
-            if (index != -1) {
-                qDebug() << "[IVC] Found restore file at index:" << index;
-            } else {
-                qDebug() << "[IVC] Restore file NOT found:" << normTarget;
-            }
+        // デバッグ出力
+        if (index != -1) {
+            qDebug() << "[IVC] Found restore file at index:" << index;
+        } else {
+            qDebug() << "[IVC] Restore file NOT found:" << normTarget;
+        }
+    }
+
+    if (m_slideshowMode == ModePictureScroll) {
+        // --- パノラマモード ---
+        // ★ 先行表示したスライドは差分更新で引き継ぐ (デコードし直さない)
+        if (!syncPanoramaSlides(m_directoryFiles)) {
+            setupPictureScroll(m_directoryFiles);
         }
 
         if (index < 0) index = 0;
@@ -2114,27 +2890,12 @@ void ImageViewController::browseTo(const QString& path, const QString& fileToSel
 
     } else {
         // --- 標準モード ---
-        // こちらも標準化パスを使って検索・表示する
-        if (!normTarget.isEmpty()) {
-            // リストに含まれているか確認してから表示 (エラー回避のため)
-            int index = m_directoryFiles.indexOf(normTarget);
-            if (index == -1) {
-                // 大文字小文字無視で再検索
-                for (int i = 0; i < m_directoryFiles.size(); ++i) {
-                    if (QString::compare(m_directoryFiles[i], normTarget, Qt::CaseInsensitive) == 0) {
-                        normTarget = m_directoryFiles[i]; // 見つかった正しいパスで上書き
-                        index = i;
-                        break;
-                    }
-                }
-            }
-
-            if (index != -1) {
-                displayMedia(normTarget);
-            } else if (!m_directoryFiles.isEmpty()) {
-                displayMedia(m_directoryFiles.first());
+        if (index != -1) {
+            if (m_currentDisplayedFilePath == normTarget) {
+                // 先行表示済みなので、スライダーの範囲と位置だけ合わせる
+                updateViewControlSliderState(index, m_directoryFiles.count());
             } else {
-                displayMedia(QString());
+                displayMedia(normTarget);
             }
         } else if (!m_directoryFiles.isEmpty()) {
             displayMedia(m_directoryFiles.first());
@@ -2216,8 +2977,8 @@ bool ImageViewController::eventFilter(QObject *obj, QEvent *event)
                 if (handled) {
                     if (m_layoutDirection == LayoutDirection::Backward) step *= -1;
 
-                    // 共通関数を使用
-                    stepByImage(step);
+                    // 共通関数を使用 (フレーム単位でまとめる)
+                    queueImageStep(step);
                 }
                 m_isClickCandidate = false;
             }
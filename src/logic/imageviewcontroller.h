@@ -11,11 +11,17 @@
 #include <QListWidget>
 #include <QFileInfo>
 #include <QMap>
+#include <QHash>
 #include <QMovie>
 #include <QSet>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QThreadPool>
 #include <QtConcurrent>
 
 #include "pixmap_object.h"
+#include "imagelistindex.h"
+#include "directorysnapshotcache.h"
 #include "utils/common_types.h"
 
 // ★ 必要なクラスの前方宣言
@@ -27,6 +33,7 @@ class QProgressBar;
 class QDoubleSpinBox;
 class QStackedWidget;
 class QLabel;
+class QScrollBar;
 
 enum SlideshowMode { ModeStandard, ModePictureScroll };
 enum SlideshowEffect { EffectNone, EffectFade, EffectSlide };
@@ -108,6 +115,9 @@ public slots:
     void loadDirectory(const QDir& dir, const QString& fileToSelectPath = QString());
     void switchToSlideshowListMode(QListWidgetItem *item);
     void setImageExtensions(const QStringList& extensions);
+    void setDirectoryCache(DirectorySnapshotCache* cache);
+    void setContinueToSiblingDirectory(bool enabled); // フォルダの端で隣のフォルダへ進む
+    void setAutoScrollSpeed(int pixelsPerSecond);     // パノラマのスライドショーを連続スクロールにする (0で1枚ずつ)
     void goBack();
     void goForward();
     void goUp();
@@ -136,6 +146,13 @@ private:
     void updateViewControlSliderState(int currentIndex = -1, int count = -1);
     void updateZoomState();
     void loadSlidesAround(int index);
+    void requestSlideDecode(int index);
+    void clearPanoramaSlides();
+    bool syncPanoramaSlides(const QStringList& files);
+    int findSlideIndex(quint64 slideId, int hintIndex) const;
+    void relayoutPanorama();
+    void fitSlideItem(int index);
+    QSize probeIntrinsicSize(const QString& filePath);
     void scrollToImage(int index);
     QString getParentPath(const QString& path) const;
     void addPathToHistory(const QString& path);
@@ -144,6 +161,8 @@ private:
     void cleanupPanoramaMovie(int index);
     bool isAnimatedImage(const QString &path);
     void stepByImage(int step);
+    const ImageListIndex* activeImageIndex() const;
+    int indexOfActiveImage(const QString& path) const;
 
     // --- UIポインタ (Dependency Injection) ---
     QGraphicsView *m_view;
@@ -163,6 +182,9 @@ private:
     QLabel *m_loadingLabel;
     QLabel *m_emptyDirectoryLabel; // 追加: 宣言が漏れていた場合のために念のため
     QString m_currentDisplayedFilePath;
+    quint64 m_displayRequestId = 0; // displayMedia の呼び出しごとに進める (本体デコードの照合用)
+    QSharedPointer<QAtomicInteger<quint64>> m_latestDisplayRequest; // m_displayRequestId の写し (ワーカーと共有)
+    QThreadPool m_fullDecodePool; // 本体デコード専用 (1スレッド。先読みやパノラマのデコードを待たせない)
 
     QList<QString> m_history;
     int m_historyIndex;
@@ -178,14 +200,22 @@ private:
     SlideDirection m_slideDirection;
     ViewMode m_viewMode;
     QStringList m_directoryFiles;
+    ImageListIndex* m_slideshowListIndex;
+    ImageListIndex* m_directoryIndex;
     QStringList m_imageExtensions;
 
     struct SlideInfo {
         QString filePath;
         QRectF geometry;
         QGraphicsPixmapItem* item = nullptr;
+        QSize intrinsicSize; // 元画像のサイズ (読めないファイルは無効サイズ)
+        QSize decodedSize;   // item に載っているピクスマップのデコードサイズ
+        quint64 slideId = 0; // 挿入・削除でインデックスがずれても非同期結果を照合するためのID
     };
     QList<SlideInfo> m_slides;
+    QHash<QString, QSize> m_intrinsicSizeCache; // リサイズ時にファイルを再読込しないためのキャッシュ
+    int m_loadedCenterIndex = -1;               // loadSlidesAround の現在の中心
+    quint64 m_nextSlideId = 1;
 
     QTimer *slideshowProgressTimer;
     QTimer *m_scrollIndexUpdateTimer;
@@ -194,7 +224,40 @@ private:
     QListWidgetItem* m_currentlyDisplayedSlideItem;
     QPoint m_clickStartPos;
     bool m_isClickCandidate = false;
-    QPropertyAnimation* m_currentScrollAnim = nullptr;
+
+    // --- フレーム同期のスクロール駆動 ---
+    // ホイール/キー/クリックの移動量はフレームごとに1つの目標にまとめ、
+    // スクロールは1本のタイマーで目標へ近づける (入力ごとにアニメーションを作り直さない)
+    QTimer* m_scrollFrameTimer = nullptr;
+    QElapsedTimer m_scrollFrameClock;
+    qreal m_scrollTargetValue = 0.0;
+    qreal m_scrollCurrentValue = 0.0;
+    int m_lastDrivenScrollValue = 0; // これと違う値になっていたらユーザーが動かした
+    bool m_scrollAnimating = false;
+    int m_pendingImageSteps = 0;
+    int m_wheelRemainder = 0;        // 1ステップに満たないホイール量
+    void queueImageStep(int step);
+    int frameIntervalMs() const;
+    void startScrollDriver();
+    void onScrollFrame();
+    void animateScrollTo(qreal value, bool animate);
+    void cancelScrollAnimation();
+    QScrollBar* panoramaScrollBar() const;
+    qreal scrollValueForIndex(int index) const;
+
+    // --- パノラマの連続自動スクロール (スライドショー) ---
+    // slideshowTimer をフレーム間隔で回し、経過時間 × 速度だけ進める
+    int m_autoScrollSpeed = 0;            // px/秒 (0 なら1枚ずつ切り替え)
+    qreal m_autoScrollPosition = 0.0;     // 端数を含むスクロール位置
+    int m_lastAutoScrollValue = 0;        // これと違う値になっていたらユーザーが動かした
+    QElapsedTimer m_autoScrollClock;
+    QElapsedTimer m_autoScrollIndexClock; // 現在位置の確定を間引く
+    qreal m_slideDecodeLatencyMs = 0.0;   // スライド1枚のデコード時間 (移動平均)
+    int m_preloadAhead = 0;               // 進行方向に先読みする枚数 (速度とデコード時間から決める)
+    bool isAutoScrollSlideshow() const;
+    int slideshowTimerInterval() const;
+    void advanceAutoScroll();
+    void updateAutoScrollLookahead(int index);
 
     qreal m_fitScale;
     qreal m_userZoomFactor;
@@ -205,23 +268,106 @@ private:
     bool m_isUpdatingView;
     bool m_isProgrammaticScroll;
 
-    QCollator m_collator;       // 数値考慮の比較用
+    QCollator m_collator;       // 数値考慮の比較用 (差分挿入の単発比較のみ。ソートは FileSorter)
     SortMode m_currentSortMode; // 現在のモード
     bool m_sortAscending;       // 昇順/降順
 
-    void sortFileInfos(QFileInfoList &list);
 
-    QSet<int> m_loadingIndices;
+    // --- ディレクトリの非同期読み込み ---
+    struct DirectoryLoadResult {
+        int generation = 0;
+        QString path;
+        QStringList files;  // ソート済み・標準化済みのパス
+        SortMode sortMode = SortName; // files を並べたソート条件
+        bool ascending = true;
+        DirectorySnapshotCache::Snapshot snapshot;
+        bool scannedFromDisk = false;
+        bool cancelled = false;
+    };
+    static DirectoryLoadResult listDirectory(const QString& path, const QStringList& filters,
+                                             const DirectorySnapshotCache::Snapshot* cachedSnapshot,
+                                             SortMode sortMode, bool ascending,
+                                             int generation, QSharedPointer<QAtomicInt> latestGeneration);
+    void onDirectoryLoaded(const DirectoryLoadResult& result);
+    QSharedPointer<QAtomicInt> m_browseGeneration; // 最新のナビゲーション番号 (ワーカーと共有)
+    QString m_pendingSelectPath;                   // 一覧の到着後に選択するファイル
+    bool m_isDirectoryLoading = false;
+
+    // --- ディレクトリ一覧のキャッシュ (MainWindow から共有) ---
+    DirectorySnapshotCache* m_directoryCache = nullptr;
+    QHash<QString, QStringList> m_sortedDirectoryCache; // 現在のソート条件でのソート済み一覧
+    void onDirectoryUpdated(const QString& dirPath, const QFileInfoList& addedFiles, const QStringList& removedFiles,
+                            const QFileInfoList& addedDirs, const QStringList& removedDirs);
+
+    QSet<quint64> m_loadingSlideIds;
     struct AsyncLoadResult {
-        int index;
+        int index;          // 要求時のインデックス (検索のヒント)
+        quint64 slideId;
+        QSize targetSize;
         QImage image;
         bool success;
+        qint64 decodeMs = 0; // デコードにかかった時間 (先読み量の見積もり用)
     };
 
     void onImageLoaded(const AsyncLoadResult& result);
 
+    // --- 静止画の表示 (埋め込みプレビューを仮表示し、本体は非同期でデコード) ---
+    void showStaticPixmap(const QString& filePath, const QPixmap& pixmap);
+    void decodeFullImageAsync(const QString& filePath);
+
     static const int SCROLL_UPDATE_INTERVAL = 40;
+    static const int WHEEL_STEP_ANGLE = 120;      // 通常のホイール1ノッチ
+    static const int WHEEL_STEP_PIXELS = 120;     // タッチパッドの1ページ分の移動量
+    static constexpr qreal SCROLL_SMOOTHING_MS = 60.0; // 目標への追従の時定数
     static const int RESIZE_DEBOUNCE_INTERVAL = 80;
+    static const int PANORAMA_PRELOAD_RANGE = 5;
+    static const int AUTO_SCROLL_MAX_STEP_MS = 100;      // 長い停止の後に一気に進まないための上限
+    static const int AUTO_SCROLL_MAX_LOOKAHEAD = 32;
+    static constexpr qreal AUTO_SCROLL_LATENCY_MARGIN = 2.0; // 並列デコードの待ちを見込んだ余裕
+    static constexpr qreal AUTO_SCROLL_MIN_LATENCY_MS = 50.0;
+    static const int MAX_SORTED_DIRECTORY_CACHE = 64;
+    // --- 隣のフォルダへの継続 (Series/Vol01 -> Vol02 ...) ---
+    struct SiblingPrefetchResult {
+        QString fromDir;      // 要求時のフォルダ (normalizedPath)
+        int direction = 1;    // 1 = 次のフォルダ, -1 = 前のフォルダ
+        QString siblingDir;   // 隣のフォルダ (なければ空)
+        DirectoryLoadResult listing;
+        QHash<QString, QImage> images; // 最初に表示するページ (進むなら先頭、戻るなら末尾) のデコード済み画像
+    };
+    static QString findSiblingDirectory(const QString& dirPath, int direction, const QStringList& filters,
+                                        SortMode sortMode, bool ascending);
+    static SiblingPrefetchResult prefetchSiblingDirectory(const QString& dirPath, int direction, const QStringList& filters,
+                                                          SortMode sortMode, bool ascending, int pageCount);
+    void maybePrefetchSiblingDirectory(int currentIndex, int count);
+    void startSiblingPrefetch(int direction, int pageCount);
+    void onSiblingPrefetched(const SiblingPrefetchResult& result);
+    bool continueToSiblingDirectory(int direction);
+    void enterSiblingDirectory(const QString& sibling, int direction, const QStringList& files);
+    QStringList imageNameFilters() const;
+    bool m_continueToSiblingDirectory = false;
+    bool m_siblingPrefetchInFlight = false;
+    int m_siblingContinueDirection = 0;         // 探索の完了を待って隣へ進む向き (0 = 待っていない)
+    QString m_siblingPrefetchedFor;             // 先読み済み (または次が無いと分かった) フォルダ
+    QString m_prefetchedSiblingDir;
+    QString m_noPreviousSiblingFor;             // 前のフォルダが無いと分かったフォルダ
+    QHash<QString, QImage> m_prefetchedImages;  // displayMedia / パノラマのデコードで優先して使う
+
+    // --- 標準モードのスライドショーの先読み (ダブルバッファ) ---
+    // 表示した直後に次の数枚を裏でデコードしておき、タイマーが来たら貼るだけにする
+    // (シャッフル時もアクティブリストの並びがそのまま再生順なので同じ扱い)
+    void prefetchUpcomingSlides(const QStringList& allFiles);
+    void clearSlideshowBuffer();
+    static QImage readSlideImage(const QString& path); // EXIF の向きを反映して読む (先読みと同期読み込みで共通)
+    QHash<QString, QImage> m_slideshowBuffer; // デコード済みの次のスライド
+    QSet<QString> m_slideshowBufferPending;   // デコード中
+    quint64 m_slideshowBufferGeneration = 0;  // 停止・リスト変更で進める (古い結果を捨てる)
+
+    static const int SLIDESHOW_PREFETCH_COUNT = 2;   // 先にデコードしておく枚数
+    static const int SIBLING_PREFETCH_THRESHOLD = 5; // 残りページがこれ以下になったら先読みする
+    static const int SIBLING_PREFETCH_PAGES = 2;     // 先にデコードしておくページ数
+    static const int MAX_SIBLING_SEARCH = 16;        // 画像のないフォルダを飛ばす上限
+    static const qint64 PREVIEW_PLACEHOLDER_MIN_BYTES = 4 * 1024 * 1024; // これ未満は同期デコードで十分速い
+    static const int PREVIEW_PLACEHOLDER_MIN_EDGE = 160;                 // EXIF サムネイルの標準サイズ
 };
 
 class ViewUpdateGuard {
@@ -1,10 +1,17 @@
 #include "mediamanager.h"
+#include "sdlfilestream.h"
+#include "gainkernels.h"
+#include "audioprobe.h"
 #include <QDebug>
-#include <QFile>
 #include <QFileInfo>
+#include <QFutureWatcher>
+#include <QPair>
+#include <QThread>
 #include <QTime>
 #include <QTimer>
 #include <QtMath>
+#include <QtConcurrent>
+#include <utility>
 
 #include <SDL.h>
 #include <SDL_mixer.h>
@@ -14,10 +21,29 @@ MediaManager* MediaManager::instance = nullptr;
 MediaManager::MediaManager(WId wid, QObject *parent)
     : QObject(parent)
     , m_mpv(nullptr)
-    , m_mpvEventTimer(nullptr)
+    , m_mpvEventThread(nullptr)
+    , m_pcmHooked(false)
+    , m_deviceGeneration(0)
+    , m_preloadedTrack(nullptr)
+    , m_pcmSwitchesSeen(0)
+    , m_mpvFileSession(0)
+    , m_musicStartSeconds(0)
+    , m_seekDelaySamples(0)
+    , m_seekGeneration(0)
+    , m_pendingSeekSeconds(-1)
     , m_progressTimer(nullptr)
     , m_music(nullptr)
     , m_volumeGain(0.2f)
+    , m_trackGain(1.0f)
+    , m_appliedGain(0.2f)
+    , m_audioFormat(AUDIO_S16SYS)
+    , m_audioChannels(AUDIO_CHANNELS)
+    , m_audioOpened(false)
+    , m_nativeRateOutput(false)
+    , m_lowLatencyOutput(false)
+    , m_requestedFrequency(0)
+    , m_outputFrequency(0)
+    , m_outputChunkSize(0)
     , m_currentVolumePercent(20)
     , m_isMuted(false)
     , m_volumeBeforeMute(20)
@@ -25,28 +51,31 @@ MediaManager::MediaManager(WId wid, QObject *parent)
     , m_isPaused(false)
 {
     instance = this;
+    m_seekPool.setMaxThreadCount(1);
+    m_decodePool.setMaxThreadCount(1);
 
     // --- SDLの初期化 ---
     if (SDL_Init(SDL_INIT_AUDIO) < 0) {
         qDebug() << "SDL Init Error:" << SDL_GetError();
     }
-    if (Mix_OpenAudio(AUDIO_FREQUENCY, MIX_DEFAULT_FORMAT, AUDIO_CHANNELS, AUDIO_CHUNK_SIZE) < 0) {
-        qDebug() << "SDL_mixer Init Error:" << Mix_GetError();
-    }
-    // SDLコールバックの登録
-    Mix_RegisterEffect(MIX_CHANNEL_POST, amplifyEffect, nullptr, this);
-    Mix_HookMusicFinished(musicFinishedCallback);
+    openAudioDevice(AUDIO_FREQUENCY, AUDIO_CHUNK_SIZE);
 
     // --- mpvの初期化 ---
     m_mpv = mpv_create();
     if (m_mpv) {
+        // 次のプレイリスト項目を終わり際に開いておく (動画の先読み)
+        mpv_set_option_string(m_mpv, "prefetch-playlist", "yes");
         mpv_initialize(m_mpv);
         mpv_set_property(m_mpv, "wid", MPV_FORMAT_INT64, &wid);
-        mpv_observe_property(m_mpv, 0, "pause", MPV_FORMAT_FLAG);
+        mpv_observe_property(m_mpv, MpvTimePos, "time-pos", MPV_FORMAT_DOUBLE);
+        mpv_observe_property(m_mpv, MpvDuration, "duration", MPV_FORMAT_DOUBLE);
+        mpv_observe_property(m_mpv, MpvPause, "pause", MPV_FORMAT_FLAG);
+        mpv_observe_property(m_mpv, MpvPath, "path", MPV_FORMAT_STRING);
 
-        // mpvのイベントを監視するためのタイマーを開始
-        m_mpvEventTimer = new QTimer(this);
-        connect(m_mpvEventTimer, &QTimer::timeout, this, &MediaManager::handleMpvEvents);
+        // ★ ポーリングせず、mpv から通知が来たときだけ専用スレッドでイベントを処理する
+        mpv_set_wakeup_callback(m_mpv, mpvWakeupCallback, this);
+        m_mpvEventThread = QThread::create([this]() { runMpvEventLoop(); });
+        m_mpvEventThread->start();
     }
 
     // --- 再生位置更新タイマーのセットアップ ---
@@ -56,56 +85,119 @@ MediaManager::MediaManager(WId wid, QObject *parent)
 
 MediaManager::~MediaManager()
 {
+    // 開き直しやデコードの途中なら終わるのを待つ (SDL を閉じた後に Mix_LoadMUSType_RW などを呼ばせない)
+    m_seekPool.clear();
+    m_seekPool.waitForDone();
+    m_decodePool.clear();
+    m_decodePool.waitForDone();
+    Mix_HookMusicFinished(nullptr);
+    Mix_HaltMusic();
+    if (m_pcmHooked) Mix_HookMusic(nullptr, nullptr);
+    m_pcm.setTrack(nullptr);
+    freePreloadedTrack(std::exchange(m_preloadedTrack, nullptr));
     if (m_music) { Mix_FreeMusic(m_music); }
-    Mix_CloseAudio();
+    if (m_seekIndexCancelled) m_seekIndexCancelled->storeRelaxed(1);
+    if (m_audioOpened) Mix_CloseAudio();
     SDL_Quit();
 
+    if (m_mpvEventThread) {
+        m_mpvEventLoopQuit.storeRelease(1);
+        m_mpvWakeup.release();
+        m_mpvEventThread->wait();
+        delete m_mpvEventThread;
+    }
     if (m_mpv) {
+        mpv_set_wakeup_callback(m_mpv, nullptr, nullptr);
         mpv_terminate_destroy(m_mpv);
     }
 }
 
 void MediaManager::play(const QString& filePath)
 {
-    stop(); // まず現在の再生を停止
+    // ★ ギャップレスで既に再生を始めている曲なら、止めずにそのまま続ける
+    if (!m_gaplessFilePath.isEmpty() && filePath == m_gaplessFilePath && isSdlActive()) {
+        m_gaplessFilePath.clear();
+        m_progressTimer->start(10); // TODO: この間隔は設定から渡す
+        m_isPlaying = true;
+        m_isPaused = false;
+        emit playbackStateChanged(true);
+        return;
+    }
+    m_gaplessFilePath.clear();
 
-    QFileInfo fileInfo(filePath);
-    QString suffix = fileInfo.suffix().toLower();
-    QStringList audioExtensions = {"mp3", "wav", "ogg", "flac"};
-    QStringList videoExtensions = {"mp4", "mkv", "avi", "mov", "wmv"};
+    // ★ mpv が先読みしていた次の動画へ既に進んでいれば、読み込み直さずにそのまま続ける
+    if (!m_mpvAdvancedFilePath.isEmpty() && filePath == m_mpvAdvancedFilePath) {
+        m_mpvAdvancedFilePath.clear();
+        m_mpvCurrentFilePath = filePath;
+        m_progressTimer->start(MPV_PROGRESS_INTERVAL);
+        m_isPlaying = true;
+        m_isPaused = false;
+        emit playbackStateChanged(true);
+        return;
+    }
+    m_mpvAdvancedFilePath.clear();
 
-    if (audioExtensions.contains(suffix)) {
-        // --- 音声ファイルの場合 (SDL) ---
-        QFile file(filePath);
-        if (!file.open(QIODevice::ReadOnly)) { return; }
-        m_currentMusicData = file.readAll();
-        file.close();
+    // 先読み済みの曲が要求された場合は開き直さずに使う
+    PreloadedTrack* preloaded = std::exchange(m_preloadedTrack, nullptr);
+    if (!preloaded && m_pcmHooked && filePath == m_pcmNextFilePath) {
+        // 控えていた次の曲 (まだ切り替わっていなければ) を取り戻す
+        if (PcmPlayer::Track* next = m_pcm.setNext(nullptr)) {
+            preloaded = new PreloadedTrack;
+            preloaded->filePath = filePath;
+            preloaded->pcm = next;
+        }
+    }
+    if (preloaded && preloaded->filePath != filePath) {
+        freePreloadedTrack(preloaded);
+        preloaded = nullptr;
+    }
+    // 次の曲としてデコード中なら、それが終わるのを待つ
+    QSharedPointer<QAtomicInt> decoding;
+    if (!m_preloadDecodingPath.isEmpty() && m_preloadDecodingPath == filePath) {
+        decoding = m_preloadDecodeCancelled;
+    } else if (m_preloadDecodeCancelled) {
+        m_preloadDecodeCancelled->storeRelaxed(1);
+    }
+    m_preloadDecodeCancelled.reset();
+    m_preloadDecodingPath.clear();
 
-        SDL_RWops* rw = SDL_RWFromConstMem(m_currentMusicData.constData(), m_currentMusicData.size());
-        if (!rw) return;
+    stop(); // まず現在の再生を停止
 
-        m_music = Mix_LoadMUS_RW(rw, 1); // 1 = auto-free the RWops
-        if (!m_music) {
-            qDebug() << "Mix_LoadMUS_RW Error:" << Mix_GetError();
-            return;
+    if (isAudioFile(filePath)) {
+        // --- 音声ファイルの場合 (SDL) ---
+        // ★ 曲のレートやバッファの設定がデバイスと違えば開き直す (先読み済みの曲は古いデバイス向けなので捨てる)
+        const int frequency = desiredFrequency(filePath);
+        const int chunkSize = desiredChunkSize();
+        if (!m_audioOpened || frequency != m_requestedFrequency || chunkSize != m_outputChunkSize) {
+            freePreloadedTrack(preloaded);
+            preloaded = nullptr;
+            if (decoding) decoding->storeRelaxed(1);
+            decoding.reset();
+            if (!openAudioDevice(frequency, chunkSize)) return;
         }
 
-        if (Mix_PlayMusic(m_music, 1) == -1) { // ループはPlaylistManagerが担当
-            qDebug() << "Mix_PlayMusic Error:" << Mix_GetError();
+        if (preloaded) {
+            startPreloadedTrack(preloaded);
+            return;
         }
-        m_progressTimer->start(10); // TODO: この間隔は設定から渡す
-        m_isPlaying = true;
-        m_isPaused = false;
-        emit playbackStateChanged(true);
+        // ★ 曲全体をワーカーでデコードし終わってから再生を始める (長すぎる曲は handleTrackDecoded で Mix_Music に回す)
+        m_decodeWantedCancelled = decoding ? decoding : requestDecode(filePath);
+        emit loadingStateChanged(true);
 
-    } else if (videoExtensions.contains(suffix)) {
+    } else if (isVideoFile(filePath)) {
+        freePreloadedTrack(preloaded);
+        if (decoding) decoding->storeRelaxed(1);
         // --- ビデオファイルの場合 (mpv) ---
         emit loadingStateChanged(true); // 読込中表示を開始
 
-        // mpvに再生コマンドを送る
-        QString command = QString("loadfile \"%1\"").arg(filePath);
-        mpv_command_string(m_mpv, command.toUtf8().constData());
-        m_mpvEventTimer->start(MPV_EVENT_TIMER_INTERVAL);
+        // mpvに再生コマンドを送る (非同期。結果はイベントで届く)
+        if (m_mpv) {
+            const QByteArray path = filePath.toUtf8();
+            const char *args[] = {"loadfile", path.constData(), nullptr};
+            mpv_command_async(m_mpv, 0, args);
+        }
+        m_mpvCurrentFilePath = filePath;
+        m_progressTimer->start(MPV_PROGRESS_INTERVAL);
         m_isPlaying = true;
         m_isPaused = false;
         // playbackStateChangedは "file-loaded" か "pause" プロパティ変更イベントで発行
@@ -115,24 +207,55 @@ void MediaManager::play(const QString& filePath)
 void MediaManager::stop()
 {
     // SDLの停止
-    Mix_HookMusicFinished(nullptr); // 一時的にコールバックを解除
-    Mix_HaltMusic();
-    if (m_music) {
-        Mix_FreeMusic(m_music);
-        m_music = nullptr;
+    releaseSdlPlayback();
+    m_gaplessFilePath.clear();
+    // デコードを待っている曲も取り消す
+    if (m_decodeWantedCancelled) m_decodeWantedCancelled->storeRelaxed(1);
+    m_decodeWantedCancelled.reset();
+    // mpvの停止 (これより前のファイルのイベントは無視する。先読みしたプレイリストも消える)
+    m_mpvSession.ref();
+    if (m_mpv) {
+        const char *args[] = {"stop", nullptr};
+        mpv_command_async(m_mpv, 0, args);
     }
-    // mpvの停止
-    mpv_command_string(m_mpv, "stop");
+    m_mpvCurrentFilePath.clear();
+    m_mpvQueuedFilePath.clear();
+    m_mpvAdvancedFilePath.clear();
+    m_mpvState.hasFile.storeRelease(0);
+    m_mpvState.positionMs.storeRelease(0);
+    m_mpvState.durationMs.storeRelease(0);
 
     // タイマーの停止
     m_progressTimer->stop();
-    m_mpvEventTimer->stop();
 
     m_isPlaying = false;
     m_isPaused = false;
     emit playbackStateChanged(false);
     emit loadingStateChanged(false);
+}
 
+void MediaManager::releaseSdlPlayback()
+{
+    Mix_HookMusicFinished(nullptr); // 一時的にコールバックを解除
+    Mix_HaltMusic();
+    if (m_music) {
+        Mix_FreeMusic(m_music);
+        m_music = nullptr;
+    }
+    // デコード済みの曲は、コールバックを外してから解放する (外し終われば mix はもう呼ばれない)
+    if (m_pcmHooked) {
+        Mix_HookMusic(nullptr, nullptr);
+        m_pcmHooked = false;
+    }
+    m_pcm.setTrack(nullptr);
+    m_pcmNextFilePath.clear();
+    m_pcmSwitchesSeen = 0;
+    m_musicFilePath.clear();
+    m_musicStartSeconds = 0;
+    ++m_seekGeneration; // 開き直しの途中なら、その結果は捨てる
+    m_pendingSeekSeconds = -1;
+    requestSeekIndex(QString()); // 作りかけの索引を捨てる
+    m_musicFinishedPending.storeRelease(0); // 届いていない終了通知は無視する
     Mix_HookMusicFinished(musicFinishedCallback); // コールバックを再登録
 }
 
@@ -143,34 +266,40 @@ void MediaManager::togglePlayback()
         return;
     }
 
-    // --- mpvの再生状態を取得 ---
+    // --- mpvの再生状態を取得 (ミラーから読む) ---
     int mpv_pause_flag = 1; // 1 = Paused/Stopped
     if (isMpvActive()) {
-        mpv_get_property(m_mpv, "pause", MPV_FORMAT_FLAG, &mpv_pause_flag);
+        mpv_pause_flag = m_mpvState.paused.loadAcquire();
     }
 
     // --- 現在再生中かどうかを判定 ---
-    bool isSdlPlaying = Mix_PlayingMusic() && !Mix_PausedMusic();
+    bool isSdlPlaying = m_pcmHooked ? !m_pcm.isPaused() : (Mix_PlayingMusic() && !Mix_PausedMusic());
     bool isMpvPlaying = isMpvActive() && mpv_pause_flag == 0;
     bool isPlaying = isSdlPlaying || isMpvPlaying;
 
     // --- 現在一時停止中かどうかを判定 ---
-    bool isSdlPaused = Mix_PlayingMusic() && Mix_PausedMusic();
+    bool isSdlPaused = m_pcmHooked ? m_pcm.isPaused() : (Mix_PlayingMusic() && Mix_PausedMusic());
     bool isMpvPaused = isMpvActive() && mpv_pause_flag == 1;
     bool isPaused = isSdlPaused || isMpvPaused;
 
     if (isPlaying) {
         // --- 1. 再生中の場合 → 一時停止 ---
-        if (isSdlPlaying) Mix_PauseMusic();
-        if (isMpvPlaying) mpv_command_string(m_mpv, "set pause yes");
+        if (isSdlPlaying) {
+            if (m_pcmHooked) m_pcm.setPaused(true);
+            else Mix_PauseMusic();
+        }
+        if (isMpvPlaying) setMpvPause(true);
         m_isPlaying = false;
         m_isPaused = true;
         emit playbackStateChanged(false);
 
     } else if (isPaused) {
         // --- 2. 一時停止中の場合 → 再生再開 ---
-        if (isSdlPaused) Mix_ResumeMusic();
-        if (isMpvPaused) mpv_command_string(m_mpv, "set pause no");
+        if (isSdlPaused) {
+            if (m_pcmHooked) m_pcm.setPaused(false);
+            else Mix_ResumeMusic();
+        }
+        if (isMpvPaused) setMpvPause(false);
         m_isPlaying = true;
         m_isPaused = false;
         emit playbackStateChanged(true);
@@ -179,11 +308,24 @@ void MediaManager::togglePlayback()
 
 void MediaManager::setPosition(int pos)
 {
-    if (m_music) { // SDL
-        Mix_SetMusicPosition(pos / 1000.0);
-    } else { // mpv
+    if (m_pcmHooked) { // SDL (デコード済み)
+        // 終わった曲は次の曲への切り替えを待っているので触らない
+        if (m_musicFinishedPending.loadAcquire()) return;
+        // ★ 読み出し位置を変えるだけ (サンプル単位で合う)
+        m_pcm.seek(pos / 1000.0);
+    } else if (m_music) { // SDL
+        // 終わった曲は次の曲への切り替えを待っているので触らない
+        if (m_musicFinishedPending.loadAcquire()) return;
+
+        // ★ 索引があれば手前のフレームから開き直す (VBR の MP3 でも先頭からデコードしない)
+        const double seconds = pos / 1000.0;
+        if (!seekWithIndex(seconds)) {
+            Mix_SetMusicPosition(qMax(0.0, seconds - m_musicStartSeconds));
+        }
+    } else if (m_mpv) { // mpv
         double pos_sec = pos / 1000.0;
-        mpv_set_property(m_mpv, "time-pos", MPV_FORMAT_DOUBLE, &pos_sec);
+        mpv_set_property_async(m_mpv, 0, "time-pos", MPV_FORMAT_DOUBLE, &pos_sec);
+        m_mpvState.positionMs.storeRelease(pos); // シーク完了の通知までスライダーが戻らないように
     }
 }
 
@@ -200,7 +342,7 @@ void MediaManager::setVolume(int percent)
         // mpv用の音量を更新
         if (m_mpv) {
             double mpv_volume = static_cast<double>(percent);
-            mpv_set_property(m_mpv, "volume", MPV_FORMAT_DOUBLE, &mpv_volume);
+            mpv_set_property_async(m_mpv, 0, "volume", MPV_FORMAT_DOUBLE, &mpv_volume);
         }
     }
     // 2. UIに変更を通知
@@ -213,7 +355,7 @@ void MediaManager::handleMuteClicked()
 
     if (m_mpv) {
         int mute_flag = m_isMuted ? 1 : 0;
-        mpv_set_property(m_mpv, "mute", MPV_FORMAT_FLAG, &mute_flag);
+        mpv_set_property_async(m_mpv, 0, "mute", MPV_FORMAT_FLAG, &mute_flag);
     }
 
     int currentVolume;
@@ -232,7 +374,7 @@ void MediaManager::handleMuteClicked()
 
         if (m_mpv) {
             double mpv_volume = static_cast<double>(currentVolume);
-            mpv_set_property(m_mpv, "volume", MPV_FORMAT_DOUBLE, &mpv_volume);
+            mpv_set_property_async(m_mpv, 0, "volume", MPV_FORMAT_DOUBLE, &mpv_volume);
         }
     }
 
@@ -248,95 +390,564 @@ void MediaManager::handlePositionSliderPressed()
 
 void MediaManager::handlePositionSliderReleased()
 {
-    if (m_music && Mix_PlayingMusic()) {
+    if (m_pcmHooked || (m_music && Mix_PlayingMusic())) {
         m_progressTimer->start(10); // TODO: 設定から渡す
+    } else if (isMpvActive()) {
+        m_progressTimer->start(MPV_PROGRESS_INTERVAL);
     }
 }
 
-void MediaManager::handleMpvEvents()
+void MediaManager::mpvWakeupCallback(void *ctx)
 {
-    while (m_mpv) {
-        mpv_event *event = mpv_wait_event(m_mpv, 0);
-        if (event->event_id == MPV_EVENT_NONE) {
-            break; // イベントがなければループを抜ける
+    // mpv の内部スレッドから呼ばれる (ここで mpv の API は呼べない)
+    static_cast<MediaManager*>(ctx)->m_mpvWakeup.release();
+}
+
+void MediaManager::runMpvEventLoop()
+{
+    while (!m_mpvEventLoopQuit.loadAcquire()) {
+        m_mpvWakeup.acquire();
+        m_mpvWakeup.tryAcquire(m_mpvWakeup.available()); // 溜まった通知は1回の処理でまとめて片付く
+
+        // 届いているイベントをすべて取り出す
+        while (true) {
+            mpv_event *event = mpv_wait_event(m_mpv, 0);
+            if (event->event_id == MPV_EVENT_NONE) break;
+            processMpvEvent(event);
         }
+    }
+}
 
-        if (event->event_id == MPV_EVENT_FILE_LOADED) {
-            // ファイルの読み込みが完了したら、読込中表示を終了
-            emit loadingStateChanged(false);
-            m_isPlaying = true;
-            m_isPaused = false;
-            emit playbackStateChanged(true);
+void MediaManager::processMpvEvent(const mpv_event *event)
+{
+    switch (event->event_id) {
+    case MPV_EVENT_PROPERTY_CHANGE: {
+        const mpv_event_property *prop = static_cast<const mpv_event_property*>(event->data);
+        const bool hasValue = prop->format != MPV_FORMAT_NONE && prop->data;
+        switch (event->reply_userdata) {
+        case MpvTimePos:
+            m_mpvState.positionMs.storeRelease(hasValue ? qint64(*static_cast<double*>(prop->data) * 1000) : 0);
+            break;
+        case MpvDuration:
+            m_mpvState.durationMs.storeRelease(hasValue ? qint64(*static_cast<double*>(prop->data) * 1000) : 0);
+            break;
+        case MpvPath:
+            m_mpvState.hasFile.storeRelease(hasValue ? 1 : 0);
+            break;
+        case MpvPause: {
+            if (!hasValue) break;
+            const bool paused = *static_cast<int*>(prop->data) != 0;
+            m_mpvState.paused.storeRelease(paused ? 1 : 0);
+            QMetaObject::invokeMethod(this, [this, paused]() { handleMpvPauseChanged(paused); }, Qt::QueuedConnection);
+            break;
+        }
+        default:
+            break;
+        }
+        break;
+    }
+    case MPV_EVENT_START_FILE:
+        m_mpvFileSession = m_mpvSession.loadAcquire();
+        break;
+    case MPV_EVENT_FILE_LOADED: {
+        const quint32 session = m_mpvFileSession;
+        QMetaObject::invokeMethod(this, [this, session]() { handleMpvFileLoaded(session); }, Qt::QueuedConnection);
+        break;
+    }
+    case MPV_EVENT_END_FILE: {
+        const quint32 session = m_mpvFileSession;
+        const int reason = static_cast<const mpv_event_end_file*>(event->data)->reason;
+        QMetaObject::invokeMethod(this, [this, session, reason]() { handleMpvEndFile(session, reason); }, Qt::QueuedConnection);
+        break;
+    }
+    case MPV_EVENT_COMMAND_REPLY:
+    case MPV_EVENT_SET_PROPERTY_REPLY:
+        if (event->error < 0) {
+            qDebug() << "mpv async request failed:" << mpv_error_string(event->error);
         }
+        break;
+    default:
+        break;
+    }
+}
 
-        if (event->event_id == MPV_EVENT_END_FILE) {
-            mpv_event_end_file *end_file_event = (mpv_event_end_file *)event->data;
-            if (end_file_event->reason == MPV_END_FILE_REASON_EOF) {
-                // 再生が「自然に終了した(EOF)」場合のみ、次の曲へ進む
-                m_isPlaying = false;
-                m_isPaused = false;
-                emit trackFinished();
-            } else {
-                // 停止ボタンなどで停止した場合
-                m_isPlaying = false;
-                m_isPaused = false;
-                emit playbackStateChanged(false);
-            }
-            emit loadingStateChanged(false);
+void MediaManager::handleMpvFileLoaded(quint32 session)
+{
+    if (session != m_mpvSession.loadAcquire()) return; // 停止済みのファイル
+
+    // ファイルの読み込みが完了したら、読込中表示を終了
+    emit loadingStateChanged(false);
+    m_isPlaying = true;
+    m_isPaused = false;
+    emit playbackStateChanged(true);
+}
+
+void MediaManager::handleMpvEndFile(quint32 session, int reason)
+{
+    if (session != m_mpvSession.loadAcquire()) return; // 停止済みのファイル
+
+    if (reason == MPV_END_FILE_REASON_EOF && !m_mpvQueuedFilePath.isEmpty()) {
+        // 先読みしていた次の動画へ mpv が自分で進む。読込中表示は出さずに、プレイリストだけ進める
+        m_mpvAdvancedFilePath = m_mpvQueuedFilePath;
+        m_mpvQueuedFilePath.clear();
+        m_mpvCurrentFilePath.clear();
+        emit trackFinished();
+        return;
+    }
+
+    if (reason == MPV_END_FILE_REASON_EOF) {
+        // 再生が「自然に終了した(EOF)」場合のみ、次の曲へ進む
+        m_isPlaying = false;
+        m_isPaused = false;
+        emit trackFinished();
+    } else {
+        // 停止ボタンなどで停止した場合
+        m_isPlaying = false;
+        m_isPaused = false;
+        emit playbackStateChanged(false);
+    }
+    emit loadingStateChanged(false);
+}
+
+void MediaManager::handleMpvPauseChanged(bool paused)
+{
+    // SDL で再生中なら mpv の状態は関係ない
+    if (isSdlActive() || !isMpvActive()) return;
+
+    // mpvの "pause" プロパティが変更された
+    m_isPlaying = !paused;
+    m_isPaused = paused;
+    emit playbackStateChanged(m_isPlaying);
+}
+
+void MediaManager::setMpvPause(bool paused)
+{
+    if (!m_mpv) return;
+    int flag = paused ? 1 : 0;
+    mpv_set_property_async(m_mpv, 0, "pause", MPV_FORMAT_FLAG, &flag);
+    m_mpvState.paused.storeRelease(flag); // 通知が届く前に続けて切り替えられても良いように
+}
+
+void MediaManager::preloadNextTrack(const QString& filePath)
+{
+    // 動画を再生中なら mpv 側で先読みする
+    queueNextVideo(filePath);
+
+    // 同じ曲を先読み済み (控えている / デコード中) なら何もしない
+    if (m_preloadedTrack && m_preloadedTrack->filePath == filePath) return;
+    if (!m_pcmNextFilePath.isEmpty() && m_pcmNextFilePath == filePath) return;
+    if (!m_preloadDecodingPath.isEmpty() && m_preloadDecodingPath == filePath) return;
+
+    // ★ 控えている曲は取り下げる (既に切り替わっていれば、handlePcmTrackSwitched がプレイリストに合わせ直す)
+    PcmPlayer::free(m_pcm.setNext(nullptr));
+    m_pcmNextFilePath.clear();
+    freePreloadedTrack(std::exchange(m_preloadedTrack, nullptr));
+    if (m_preloadDecodeCancelled) m_preloadDecodeCancelled->storeRelaxed(1);
+    m_preloadDecodeCancelled.reset();
+    m_preloadDecodingPath.clear();
+
+    // 音声を再生中で、次も音声のときだけ (動画は mpv 側で扱う)
+    // ★ デバイスを開き直す必要がある曲は、曲間が途切れるので先読みしない
+    if (filePath.isEmpty() || !isSdlActive() || !isAudioFile(filePath)
+        || desiredFrequency(filePath) != m_requestedFrequency) {
+        return;
+    }
+    // ★ 次の曲もワーカーでデコードしておく (長すぎる曲は handleTrackDecoded で開くだけにする)
+    m_preloadDecodingPath = filePath;
+    m_preloadDecodeCancelled = requestDecode(filePath);
+}
+
+QSharedPointer<QAtomicInt> MediaManager::requestDecode(const QString& filePath)
+{
+    QSharedPointer<QAtomicInt> cancelled(new QAtomicInt(0));
+    const quint32 deviceGeneration = m_deviceGeneration;
+    const float gain = m_trackGainLookup ? m_trackGainLookup(filePath) : 1.0f;
+
+    auto *watcher = new QFutureWatcher<PcmPlayer::DecodeResult>(this);
+    connect(watcher, &QFutureWatcher<PcmPlayer::DecodeResult>::finished, this,
+            [this, watcher, filePath, cancelled, deviceGeneration]() {
+        const PcmPlayer::DecodeResult result = watcher->result();
+        watcher->deleteLater();
+        handleTrackDecoded(result, filePath, cancelled, deviceGeneration);
+    });
+    watcher->setFuture(QtConcurrent::run(&m_decodePool, [filePath, gain, cancelled]() {
+        return PcmPlayer::decode(filePath, gain, cancelled.data());
+    }));
+    return cancelled;
+}
+
+void MediaManager::handleTrackDecoded(const PcmPlayer::DecodeResult& result, const QString& filePath,
+                                      const QSharedPointer<QAtomicInt>& cancelled, quint32 deviceGeneration)
+{
+    // 開き直す前のデバイスの形式でデコードしたものは使えない
+    const bool usable = deviceGeneration == m_deviceGeneration;
+
+    if (cancelled == m_decodeWantedCancelled) {
+        // --- 再生を待っている曲 ---
+        if (!usable) {
+            PcmPlayer::free(result.track);
+            m_decodeWantedCancelled = requestDecode(filePath);
+            return;
         }
+        m_decodeWantedCancelled.reset();
+        emit loadingStateChanged(false);
+        if (result.track) {
+            startPcmPlayback(result.track);
+        } else if (result.tooLong) {
+            // ★ メモリに載せきれない曲は、これまでどおり再生しながら少しずつデコードする
+            playStreamed(filePath, nullptr);
+        } else {
+            qDebug() << "MediaManager: failed to decode" << filePath;
+        }
+        return;
+    }
 
-        if (event->event_id == MPV_EVENT_PROPERTY_CHANGE) {
-            mpv_event_property *prop = (mpv_event_property *)event->data;
-            if (strcmp(prop->name, "pause") == 0) {
-                // mpvの "pause" プロパティが変更された
-                int* pause_flag = (int*)prop->data;
-                if (*pause_flag == 0) { // 再生開始
-                    m_isPlaying = true;
-                    m_isPaused = false;
-                } else { // 一時停止
-                    m_isPlaying = false;
-                    m_isPaused = true;
+    if (cancelled == m_preloadDecodeCancelled) {
+        // --- 次の曲の先読み ---
+        m_preloadDecodeCancelled.reset();
+        m_preloadDecodingPath.clear();
+        if (usable && result.track && m_pcmHooked) {
+            // ★ デコード済みの曲を再生中なら、オーディオスレッドに控えておく (曲の終わりでそのまま切り替わる)
+            PcmPlayer::free(m_pcm.setNext(result.track));
+            m_pcmNextFilePath = filePath;
+            return;
+        }
+        PreloadedTrack* track = nullptr;
+        if (usable && result.track) {
+            track = new PreloadedTrack;
+            track->filePath = filePath;
+            track->pcm = result.track;
+        } else if (usable && result.tooLong) {
+            // 長い曲はヘッダの解析とデコーダの初期化だけ済ませておく
+            if (SDL_RWops* rw = SdlFileStream::open(filePath)) {
+                if (Mix_Music* music = Mix_LoadMUS_RW(rw, 1)) {
+                    track = new PreloadedTrack;
+                    track->filePath = filePath;
+                    track->music = music;
+                } else {
+                    qDebug() << "Preload Mix_LoadMUS_RW Error:" << Mix_GetError();
                 }
-                emit playbackStateChanged(m_isPlaying);
             }
         }
+        if (!track) PcmPlayer::free(result.track);
+        freePreloadedTrack(std::exchange(m_preloadedTrack, track));
+        return;
+    }
+
+    // 取り消された依頼
+    PcmPlayer::free(result.track);
+}
+
+void MediaManager::startPcmPlayback(PcmPlayer::Track* track)
+{
+    // 止めてある (コールバックを外してある) ので、ここで曲を渡してよい
+    m_pcm.setTrack(track);
+    m_pcmHooked = true;
+    Mix_HookMusic(musicHook, this);
+    m_progressTimer->start(10); // TODO: この間隔は設定から渡す
+    m_isPlaying = true;
+    m_isPaused = false;
+    emit playbackStateChanged(true);
+}
+
+bool MediaManager::playStreamed(const QString& filePath, Mix_Music* music)
+{
+    if (!music) {
+        // ★ 全体を読み込まず、再生しながら少しずつ読む (巨大なファイルでもUIを止めずメモリも増えない)
+        SDL_RWops* rw = SdlFileStream::open(filePath);
+        if (!rw) return false;
+
+        music = Mix_LoadMUS_RW(rw, 1); // 1 = auto-free the RWops
+        if (!music) {
+            qDebug() << "Mix_LoadMUS_RW Error:" << Mix_GetError();
+            return false;
+        }
+    }
+    m_music = music;
+
+    m_trackGain = m_trackGainLookup ? m_trackGainLookup(filePath) : 1.0f; // 止めてあるのでオーディオスレッドとは競合しない
+    if (Mix_PlayMusic(m_music, 1) == -1) { // ループはPlaylistManagerが担当
+        qDebug() << "Mix_PlayMusic Error:" << Mix_GetError();
+    }
+    m_musicFilePath = filePath;
+    requestSeekIndex(filePath);
+    m_progressTimer->start(10); // TODO: この間隔は設定から渡す
+    m_isPlaying = true;
+    m_isPaused = false;
+    emit playbackStateChanged(true);
+    return true;
+}
+
+bool MediaManager::startPreloadedTrack(PreloadedTrack* track)
+{
+    bool started = false;
+    if (track->pcm) {
+        startPcmPlayback(std::exchange(track->pcm, nullptr));
+        started = true;
+    } else if (track->music) {
+        started = playStreamed(track->filePath, std::exchange(track->music, nullptr));
+    }
+    freePreloadedTrack(track);
+    return started;
+}
+
+void MediaManager::requestSeekIndex(const QString& filePath)
+{
+    if (m_seekIndexCancelled) m_seekIndexCancelled->storeRelaxed(1);
+    m_seekIndexCancelled.reset();
+    m_seekIndex = SeekIndex();
+    m_seekDelaySamples = 0;
+
+    // WAV / FLAC / Ogg はデコーダ自身が正確にシークできる
+    if (filePath.isEmpty() || QFileInfo(filePath).suffix().toLower() != "mp3") return;
+
+    // Xing / VBRI の目次があれば、フレームを数え終わるまではそれを使う (先頭を少し読むだけ)
+    m_seekIndex = SeekIndex::fromHeader(filePath);
+
+    // 正確な索引はキャッシュから読むか、バックグラウンドでフレームを数えて作る
+    QSharedPointer<QAtomicInt> cancelled(new QAtomicInt(0));
+    m_seekIndexCancelled = cancelled;
+    auto *watcher = new QFutureWatcher<SeekIndex>(this);
+    connect(watcher, &QFutureWatcher<SeekIndex>::finished, this, [this, watcher, filePath, cancelled]() {
+        const SeekIndex index = watcher->result();
+        watcher->deleteLater();
+        if (cancelled->loadRelaxed() || filePath != m_musicFilePath || !index.isValid()) return;
+        m_seekIndex = index;
+
+        // ★ LAME タグの遅延を削るかはデコーダによるので、デコーダが返す長さがどちらに近いかで見分ける
+        //    (正確な索引ができるまでは開き直さないので、m_music はまだ元の曲)
+        const double decoded = m_music ? Mix_MusicDuration(m_music) : -1;
+        if (index.encoderDelay() > 0 && decoded > 0
+            && qAbs(decoded - index.trimmedDuration()) < qAbs(decoded - index.duration())) {
+            m_seekDelaySamples = index.encoderDelay();
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([filePath, cancelled]() {
+        return SeekIndex::build(filePath, cancelled.data());
+    }));
+}
+
+bool MediaManager::seekWithIndex(double seconds)
+{
+    // ★ フレームを数えた索引のときだけ使う。目次 (Xing / VBRI) は概算で、開き直すと位置がずれるため、
+    //    数え終わるまではデコーダのシークに任せる
+    if (!m_seekIndex.isExact() || m_musicFilePath.isEmpty()) return false;
+
+    const SeekIndex index = m_seekIndex;
+    const int delaySamples = m_seekDelaySamples;
+    const QString filePath = m_musicFilePath;
+    const quint32 generation = ++m_seekGeneration;
+    m_pendingSeekSeconds = seconds;
+
+    using Reopened = QPair<Mix_Music*, double>; // 開き直した曲と、その最初のサンプルの時刻
+    auto *watcher = new QFutureWatcher<Reopened>(this);
+    connect(watcher, &QFutureWatcher<Reopened>::finished, this, [this, watcher, filePath, seconds, generation]() {
+        const Reopened reopened = watcher->result();
+        watcher->deleteLater();
+        finishIndexedSeek(reopened.first, filePath, seconds, reopened.second, generation);
+    });
+    watcher->setFuture(QtConcurrent::run(&m_seekPool, [index, filePath, seconds, delaySamples]() -> Reopened {
+        // 予備のフレーム (書き換えたもの) から始まるように開く
+        const SeekIndex::Start start = index.prepareStart(filePath, seconds, delaySamples);
+        if (start.offset < 0) return Reopened(nullptr, 0);
+        SDL_RWops* rw = SdlFileStream::open(filePath, start.offset, start.head);
+        if (!rw) return Reopened(nullptr, 0);
+        // 途中から始まるデータは形式の判定ができないことがあるので MP3 と指定する
+        Mix_Music* music = Mix_LoadMUSType_RW(rw, MUS_MP3, 1);
+        if (!music) qDebug() << "Seek Mix_LoadMUSType_RW Error:" << Mix_GetError();
+        return Reopened(music, start.seconds);
+    }));
+    return true;
+}
+
+void MediaManager::finishIndexedSeek(Mix_Music *music, const QString& filePath, double seconds, double startSeconds, quint32 generation)
+{
+    // 後から別のシーク / stop() / 曲の切り替えがあった、または曲が終わって次を待っているなら捨てる
+    if (generation != m_seekGeneration || filePath != m_musicFilePath || !m_music
+        || m_musicFinishedPending.loadAcquire()) {
+        if (music) Mix_FreeMusic(music);
+        return;
+    }
+    m_pendingSeekSeconds = -1;
+
+    // 開き直せなかったときはデコーダのシークに任せる
+    if (!music) {
+        Mix_SetMusicPosition(qMax(0.0, seconds - m_musicStartSeconds));
+        return;
+    }
+
+    // 差し替える間はフックを外す (Mix_HaltMusic でも終了フックが呼ばれる。先読み済みの次の曲はそのまま)
+    Mix_HookMusicFinished(nullptr);
+    Mix_HaltMusic();
+    Mix_FreeMusic(m_music);
+    m_music = music;
+    m_musicStartSeconds = startSeconds;
+    if (Mix_PlayMusic(m_music, 1) == -1) {
+        qDebug() << "Mix_PlayMusic Error:" << Mix_GetError();
+    }
+    if (m_isPaused) Mix_PauseMusic();
+    // 残りは数フレームなので、デコーダのシーク (先頭からのデコード) でもすぐ終わる
+    // 予備のフレームも1フレームぶんずつ出てくるので、デコーダが数えるサンプルの位置がそのまま時刻になる
+    if (seconds > startSeconds) Mix_SetMusicPosition(seconds - startSeconds);
+    Mix_HookMusicFinished(musicFinishedCallback);
+}
+
+void MediaManager::queueNextVideo(const QString& filePath)
+{
+    // 動画を再生中で、次も動画のときだけ
+    const QString next = (!m_mpvCurrentFilePath.isEmpty() && isVideoFile(filePath)) ? filePath : QString();
+    if (!m_mpv || next == m_mpvQueuedFilePath) return;
+
+    // 控えている項目を入れ替える (playlist-clear は再生中の項目を残す)
+    if (!m_mpvQueuedFilePath.isEmpty()) {
+        const char *clearArgs[] = {"playlist-clear", nullptr};
+        mpv_command_async(m_mpv, 0, clearArgs);
+    }
+    if (!next.isEmpty()) {
+        const QByteArray path = next.toUtf8();
+        const char *args[] = {"loadfile", path.constData(), "append", nullptr};
+        mpv_command_async(m_mpv, 0, args);
     }
+    m_mpvQueuedFilePath = next;
+}
+
+void MediaManager::setAudioOutputOptions(bool nativeRate, bool lowLatency)
+{
+    m_nativeRateOutput = nativeRate;
+    m_lowLatencyOutput = lowLatency;
 
-    // 再生位置と時間表示の更新
-    if (isMpvActive() && m_isPlaying) {
-        double position = 0;
-        double duration = 0;
-        mpv_get_property(m_mpv, "time-pos", MPV_FORMAT_DOUBLE, &position);
-        mpv_get_property(m_mpv, "duration", MPV_FORMAT_DOUBLE, &duration);
+    // 再生中の曲を途切れさせないよう、SDL で再生していないときだけすぐ開き直す
+    const int chunkSize = desiredChunkSize();
+    if (!isSdlActive() && !m_decodeWantedCancelled && (chunkSize != m_outputChunkSize || (!nativeRate && m_requestedFrequency != AUDIO_FREQUENCY))) {
+        openAudioDevice(nativeRate ? m_requestedFrequency : AUDIO_FREQUENCY, chunkSize);
+        return;
+    }
+    emit audioOutputChanged(m_outputFrequency, m_outputChunkSize);
+}
 
-        qint64 pos_ms = static_cast<qint64>(position * 1000);
-        qint64 dur_ms = static_cast<qint64>(duration * 1000);
+bool MediaManager::openAudioDevice(int frequency, int chunkSize)
+{
+    if (m_audioOpened) {
+        // 先読みした曲は閉じるデバイスの形式で開かれているので捨てる
+        freePreloadedTrack(std::exchange(m_preloadedTrack, nullptr));
+        if (m_preloadDecodeCancelled) m_preloadDecodeCancelled->storeRelaxed(1);
+        m_preloadDecodeCancelled.reset();
+        m_preloadDecodingPath.clear();
+        // デコード中のワーカーは今のデバイスの形式を読んでいるので、終わるのを待つ
+        m_decodePool.waitForDone();
+        Mix_CloseAudio();
+        m_audioOpened = false;
+    }
 
-        emit positionChanged(pos_ms);
-        emit durationChanged(dur_ms);
+    // 曲のレートで開くときは、デバイスが対応していなければ近いレートに変えてもらう (変換は SDL に任せる)
+    const int allowedChanges = m_nativeRateOutput ? SDL_AUDIO_ALLOW_FREQUENCY_CHANGE : 0;
+    if (Mix_OpenAudioDevice(frequency, MIX_DEFAULT_FORMAT, AUDIO_CHANNELS, chunkSize, nullptr, allowedChanges) < 0) {
+        qDebug() << "SDL_mixer Init Error:" << Mix_GetError();
+        // 閉じたままなので、次の play() では同じ設定でも開き直させる
+        m_requestedFrequency = 0;
+        m_outputChunkSize = 0;
+        return false;
+    }
+    m_audioOpened = true;
+    m_requestedFrequency = frequency;
+    m_outputChunkSize = chunkSize;
 
-        QString current = formatTime(pos_ms);
-        QString total = formatTime(dur_ms);
-        emit timeLabelChanged(current + " / " + total);
+    // MIX_DEFAULT_FORMAT のままでも、実際に開かれた形式に合わせてゲインを掛ける
+    int channels = AUDIO_CHANNELS;
+    m_outputFrequency = frequency;
+    if (Mix_QuerySpec(&m_outputFrequency, &m_audioFormat, &channels) == 0) {
+        qDebug() << "SDL_mixer: failed to query audio spec:" << Mix_GetError();
     }
+    m_audioChannels = channels;
+    m_pcm.setOutputFormat(m_audioFormat, m_audioChannels, m_outputFrequency);
+    ++m_deviceGeneration;
+    // SDLコールバックの登録 (デバイスを閉じると外れる)
+    Mix_RegisterEffect(MIX_CHANNEL_POST, amplifyEffect, nullptr, this);
+    Mix_HookMusicFinished(musicFinishedCallback);
+
+    emit audioOutputChanged(m_outputFrequency, m_outputChunkSize);
+    return true;
+}
+
+int MediaManager::desiredFrequency(const QString& filePath) const
+{
+    if (!m_nativeRateOutput) return AUDIO_FREQUENCY;
+
+    // レートが分からない形式は今のデバイスのままで良い
+    const int rate = AudioProbe::sampleRate(filePath);
+    return rate > 0 ? rate : (m_requestedFrequency > 0 ? m_requestedFrequency : AUDIO_FREQUENCY);
 }
 
 void MediaManager::handleMusicFinished()
 {
+    // 通知が届く前に stop() / play() されていれば、終わったのは前の曲なので何もしない
+    if (!m_musicFinishedPending.fetchAndStoreOrdered(0)) return;
+    // 曲が終わったので、開き直しを待っているシークは捨てる
+    ++m_seekGeneration;
+    m_pendingSeekSeconds = -1;
+
+    // ★ 先読み済みの次の曲があれば、ここ (メインスレッド) で続けて再生を始める
+    PreloadedTrack* next = std::exchange(m_preloadedTrack, nullptr);
+    // ★ 先読みの後にプレイリストの選ぶ曲が変わっていれば (表示の切り替えなど)、続けずに通常どおり次の曲を待つ
+    if (next && m_upcomingTrackLookup && m_upcomingTrackLookup() != next->filePath) {
+        freePreloadedTrack(std::exchange(next, nullptr));
+    }
+    if (next) {
+        const QString nextFilePath = next->filePath;
+        releaseSdlPlayback(); // 前の曲は終わっているので、止めても聞こえない
+        if (startPreloadedTrack(next)) {
+            // プレイリストを進める (play() で m_gaplessFilePath と一致すれば、そのまま続行される)
+            m_gaplessFilePath = nextFilePath;
+            emit trackFinished();
+            return;
+        }
+    }
+
     m_isPlaying = false;
     m_isPaused = false;
     emit trackFinished();
 }
 
-void MediaManager::updateProgress()
+void MediaManager::handlePcmTrackSwitched()
 {
-    if (!m_music || !Mix_PlayingMusic()) return;
+    // 切り替え済みの前の曲を解放する
+    m_pcm.collectRetired();
+    const int switches = m_pcm.switchCount();
+    if (!m_pcmHooked || switches == m_pcmSwitchesSeen) return; // 通知が届く前に止めた / 処理済み
+    m_pcmSwitchesSeen = switches;
 
-    double position = Mix_GetMusicPosition(m_music);
-    double duration = Mix_MusicDuration(m_music);
+    // 曲は既に切り替わっている。プレイリストを進める (play() で m_gaplessFilePath と一致すれば、そのまま続行される)
+    // ※ 控えた後にプレイリストの選ぶ曲が変わっていれば、play() が一致しないので選ばれた曲を読み込み直す
+    const PcmPlayer::Track* current = m_pcm.currentTrack();
+    m_gaplessFilePath = current ? current->filePath : QString();
+    m_pcmNextFilePath.clear();
+    emit trackFinished();
+}
 
-    qint64 pos_ms = static_cast<qint64>(position * 1000);
-    qint64 dur_ms = static_cast<qint64>(duration * 1000);
+void MediaManager::updateProgress()
+{
+    qint64 pos_ms = 0;
+    qint64 dur_ms = 0;
+    if (m_pcmHooked) {
+        pos_ms = static_cast<qint64>(m_pcm.position() * 1000);
+        dur_ms = static_cast<qint64>(m_pcm.duration() * 1000);
+    } else if (m_music) {
+        if (!Mix_PlayingMusic()) return;
+        // 途中から開き直した曲は、開いた位置の時刻を足す (長さもデコーダでは分からないので索引から)
+        // 開き直しを待っている間はシーク先を出す (スライダーが前の位置へ戻らないように)
+        const double position = m_pendingSeekSeconds >= 0 ? m_pendingSeekSeconds
+                                                          : m_musicStartSeconds + Mix_GetMusicPosition(m_music);
+        pos_ms = static_cast<qint64>(position * 1000);
+        const double duration = !m_seekIndex.isValid() ? Mix_MusicDuration(m_music)
+                              : (m_seekDelaySamples > 0 ? m_seekIndex.trimmedDuration() : m_seekIndex.duration());
+        dur_ms = static_cast<qint64>(duration * 1000);
+    } else if (isMpvActive() && m_isPlaying) {
+        // ★ 動画はイベントスレッドが更新したミラーを読むだけ (mpv は呼ばない)
+        pos_ms = m_mpvState.positionMs.loadAcquire();
+        dur_ms = m_mpvState.durationMs.loadAcquire();
+    } else {
+        return;
+    }
 
     emit positionChanged(pos_ms);
     emit durationChanged(dur_ms);
@@ -355,13 +966,8 @@ QString MediaManager::formatTime(qint64 ms)
 
 bool MediaManager::isMpvActive() const
 {
-    if (!m_mpv) return false;
-    char *path = nullptr;
-    if (mpv_get_property(m_mpv, "path", MPV_FORMAT_STRING, &path) == 0 && path) {
-        mpv_free(path);
-        return true;
-    }
-    return false;
+    // "path" の観測結果 (文字列の取得・解放はしない)
+    return m_mpv && m_mpvState.hasFile.loadAcquire();
 }
 
 int MediaManager::getCurrentVolume() const
@@ -371,26 +977,79 @@ int MediaManager::getCurrentVolume() const
     return m_currentVolumePercent;
 }
 
+bool MediaManager::isAudioFile(const QString& filePath)
+{
+    static const QStringList audioExtensions = {"mp3", "wav", "ogg", "flac"};
+    return audioExtensions.contains(QFileInfo(filePath).suffix().toLower());
+}
+
+bool MediaManager::isVideoFile(const QString& filePath)
+{
+    static const QStringList videoExtensions = {"mp4", "mkv", "avi", "mov", "wmv"};
+    return videoExtensions.contains(QFileInfo(filePath).suffix().toLower());
+}
+
+void MediaManager::freePreloadedTrack(PreloadedTrack* track)
+{
+    if (!track) return;
+    if (track->music) Mix_FreeMusic(track->music);
+    PcmPlayer::free(track->pcm);
+    delete track;
+}
+
 void MediaManager::musicFinishedCallback()
 {
-    if (instance) {
-        QMetaObject::invokeMethod(instance, "handleMusicFinished", Qt::QueuedConnection);
-    }
+    if (!instance) return;
+
+    // ★ オーディオスレッドで呼ばれる。ここでは SDL_mixer を呼ばず、メインスレッドに知らせるだけ
+    //    (stop() はフックを外してから止めるので、ここに来るのは曲が自然に終わったときだけ)
+    instance->m_musicFinishedPending.storeRelease(1);
+    QMetaObject::invokeMethod(instance, "handleMusicFinished", Qt::QueuedConnection);
 }
 
 void MediaManager::amplifyEffect(int chan, void *stream, int len, void *udata)
 {
+    Q_UNUSED(chan);
     MediaManager* manager = static_cast<MediaManager*>(udata);
-    if (!manager || manager->m_volumeGain == 1.0f || manager->m_isMuted) return;
+    if (!manager || manager->m_pcmHooked) return; // デコード済みの曲は musicHook で掛けている
 
-    Sint16* samples = (Sint16*)stream;
-    int numSamples = len / sizeof(Sint16);
-    float gain = manager->m_isMuted ? 0.0f : manager->m_volumeGain; // ミュート対応
+    // 前のバッファの末尾のゲインから目標のゲインへ、バッファ内で少しずつ変える (ミュート対応)
+    const float gainFrom = manager->m_appliedGain;
+    const float gainTo = manager->m_isMuted ? 0.0f : manager->m_volumeGain * manager->m_trackGain;
+    manager->m_appliedGain = gainTo;
+    if (gainFrom == 1.0f && gainTo == 1.0f) return;
 
-    for (int i = 0; i < numSamples; ++i) {
-        float amplifiedSample = samples[i] * gain;
-        if (amplifiedSample > 32767) amplifiedSample = 32767;
-        else if (amplifiedSample < -32768) amplifiedSample = -32768;
-        samples[i] = static_cast<Sint16>(amplifiedSample);
+    switch (manager->m_audioFormat) {
+    case AUDIO_S16SYS:
+        GainKernels::applyS16(static_cast<qint16*>(stream), len / int(sizeof(qint16)), manager->m_audioChannels, gainFrom, gainTo);
+        break;
+    case AUDIO_S32SYS:
+        GainKernels::applyS32(static_cast<qint32*>(stream), len / int(sizeof(qint32)), manager->m_audioChannels, gainFrom, gainTo);
+        break;
+    case AUDIO_F32SYS:
+        GainKernels::applyF32(static_cast<float*>(stream), len / int(sizeof(float)), manager->m_audioChannels, gainFrom, gainTo);
+        break;
+    default:
+        break; // 想定外の形式 (8bit / 逆エンディアン) には手を付けない
+    }
+}
+
+void MediaManager::musicHook(void *udata, Uint8 *stream, int len)
+{
+    MediaManager* manager = static_cast<MediaManager*>(udata);
+    if (!manager) return;
+
+    // ★ オーディオスレッドではデコード済みの PCM をコピーしてゲインを掛けるだけ (音量の変化は amplifyEffect と同じく滑らかに)
+    const float gainFrom = manager->m_appliedGain;
+    const float gainTo = manager->m_isMuted ? 0.0f : manager->m_volumeGain;
+    manager->m_appliedGain = gainTo;
+    const int events = manager->m_pcm.mix(stream, len, gainFrom, gainTo);
+    // 終了フックと同じく、メインスレッドに知らせるだけ (曲の切り替えは mix の中で済んでいる)
+    if (events & PcmPlayer::TrackSwitched) {
+        QMetaObject::invokeMethod(manager, "handlePcmTrackSwitched", Qt::QueuedConnection);
+    }
+    if (events & PcmPlayer::TrackEnded) {
+        manager->m_musicFinishedPending.storeRelease(1);
+        QMetaObject::invokeMethod(manager, "handleMusicFinished", Qt::QueuedConnection);
     }
 }
@@ -3,10 +3,19 @@
 
 #include <QObject>
 #include <QTimer>
-#include <QByteArray>
+#include <QAtomicInteger>
+#include <QSemaphore>
+#include <QSharedPointer>
+#include <QThreadPool>
 #include <mpv/client.h>
 #include <SDL_mixer.h>
 #include <qwindowdefs.h>
+#include <functional>
+
+#include "seekindex.h"
+#include "pcmplayer.h"
+
+class QThread;
 
 class MediaManager : public QObject
 {
@@ -24,6 +33,13 @@ public:
     int getCurrentVolume() const;
     int getVolumeBeforeMute() const { return m_volumeBeforeMute; }
 
+    static bool isAudioFile(const QString& filePath); // SDL で再生する形式
+
+    // 曲ごとのゲイン (ラウドネスの正規化用。倍率で返す) を引く関数。次に再生を始める曲から反映
+    void setTrackGainLookup(const std::function<float(const QString&)> &lookup) { m_trackGainLookup = lookup; }
+    // 曲が終わったときにプレイリストが次に選ぶ曲を引く関数。先読みした曲と違えば続けて再生しない
+    void setUpcomingTrackLookup(const std::function<QString()> &lookup) { m_upcomingTrackLookup = lookup; }
+
 public slots:
     // --- MainWindowから呼び出されるスロット ---
     void play(const QString& filePath);
@@ -34,6 +50,8 @@ public slots:
     void handleMuteClicked();
     void handlePositionSliderPressed();
     void handlePositionSliderReleased();
+    void preloadNextTrack(const QString& filePath); // 次の曲を開いておく (ギャップレス再生 / 動画の先読み用。空なら破棄)
+    void setAudioOutputOptions(bool nativeRate, bool lowLatency); // 出力デバイスの開き方 (次の曲から反映)
 
 signals:
     // --- MainWindow (UI) に状態変化を通知するシグナル ---
@@ -44,17 +62,115 @@ signals:
     void trackFinished();
     void volumeChanged(int percent, bool isMuted);
     void loadingStateChanged(bool isLoading);
+    void audioOutputChanged(int frequency, int bufferSamples); // 実際に開かれた出力デバイスのレートとバッファ
 
 private slots:
     // --- 内部タイマーで呼び出されるスロット ---
-    void handleMpvEvents();
     void handleMusicFinished();
+    void handlePcmTrackSwitched(); // musicHook が次の曲へ切り替えた
     void updateProgress();
 
 private:
     // --- ヘルパー関数 ---
     QString formatTime(qint64 ms);
     bool isMpvActive() const;
+    void setMpvPause(bool paused);
+
+    // --- 出力デバイス ---
+    // 曲のレートで開き直せば SDL_mixer の再サンプリングが要らなくなる (再生中の曲がないときだけ呼ぶ)
+    bool openAudioDevice(int frequency, int chunkSize);
+    int desiredFrequency(const QString& filePath) const;
+    int desiredChunkSize() const { return m_lowLatencyOutput ? LOW_LATENCY_CHUNK_SIZE : AUDIO_CHUNK_SIZE; }
+
+    // --- デコード済みの PCM での再生 ---
+    // ★ 曲全体をワーカー (1本) でデバイスの形式にデコードしてから、Mix_HookMusic のコールバックでコピーするだけにする。
+    //    オーディオスレッドではデコードしないので、CPU の負荷が高くても小さいバッファでも途切れない
+    // ※ メモリに載せきれない長い曲 (PcmPlayer::MAX_DECODED_BYTES 超) は、これまでどおり Mix_Music で少しずつデコードする
+    QSharedPointer<QAtomicInt> requestDecode(const QString& filePath); // 返り値を立てると取り消せる
+    void handleTrackDecoded(const PcmPlayer::DecodeResult& result, const QString& filePath,
+                            const QSharedPointer<QAtomicInt>& cancelled, quint32 deviceGeneration);
+    void startPcmPlayback(PcmPlayer::Track* track);
+    bool playStreamed(const QString& filePath, Mix_Music* music); // music が nullptr なら開く
+    void releaseSdlPlayback(); // SDL で再生中の曲を止めて解放する (mpv と UI の状態はそのまま)
+    bool isSdlActive() const { return m_music || m_pcmHooked; }
+    static void musicHook(void *udata, Uint8 *stream, int len);
+    PcmPlayer m_pcm;
+    bool m_pcmHooked;  // Mix_HookMusic で m_pcm を再生中
+    QSharedPointer<QAtomicInt> m_decodeWantedCancelled; // デコードし終わったら再生を始める曲の依頼
+    quint32 m_deviceGeneration; // デバイスを開き直すごとに進める番号 (前の形式の PCM を捨てる)
+    QThreadPool m_decodePool;   // デコード用 (1本。終了時に待つ)
+
+    // --- ギャップレス再生 ---
+    // ★ デコード済みの曲どうしは、次の曲を m_pcm に控えておき、musicHook が曲の最後のサンプルの直後から切り替える
+    //    (曲間は 0 サンプル。メインスレッドは後から知らされて、プレイリストを進めるだけ)
+    // ※ 長い曲 (Mix_Music) が前後どちらかにあるときは、次の曲を開いて (デコードして) おき、
+    //    曲の終わりの通知を受けたメインスレッドで再生を始める。読み込み直しはしないが、
+    //    通知が届くまでのぶん (デバイスのバッファの残り + イベントループの遅れ) だけ曲間が空く
+    //    (終了フックはオーディオスレッドで呼ばれ、SDL_mixer の関数を呼べないため)
+    struct PreloadedTrack {
+        QString filePath;
+        PcmPlayer::Track *pcm = nullptr; // デコード済み
+        Mix_Music *music = nullptr;      // 長い曲 (開いただけ)
+    };
+    static bool isVideoFile(const QString& filePath);
+    static void freePreloadedTrack(PreloadedTrack* track);
+    bool startPreloadedTrack(PreloadedTrack* track); // SDL の再生を止めてから呼ぶ (track は解放される)
+    PreloadedTrack* m_preloadedTrack; // 先読み済みの次の曲
+    QString m_pcmNextFilePath;        // m_pcm に控えている次の曲
+    int m_pcmSwitchesSeen;            // 処理済みの m_pcm の切り替えの回数
+    QString m_preloadDecodingPath;    // デコード中の次の曲
+    QSharedPointer<QAtomicInt> m_preloadDecodeCancelled;
+    QString m_gaplessFilePath;        // 続けて再生を始めていて、play() が呼ばれるのを待っている曲
+    QAtomicInt m_musicFinishedPending; // フックが立て、handleMusicFinished が下ろす (その間 m_music は終わった曲)
+
+    // --- mpv のイベント処理 ---
+    // mpv からの通知 (wakeup コールバック) で専用スレッドがイベントを取り出し、
+    // 観測しているプロパティはミラーに書き込む。UI はミラーを読むだけで mpv を呼ばない
+    struct MpvStateMirror {
+        QAtomicInteger<qint64> positionMs; // time-pos
+        QAtomicInteger<qint64> durationMs; // duration
+        QAtomicInt paused;                 // pause
+        QAtomicInt hasFile;                // path (ファイルが開かれているか)
+    };
+    enum MpvObservedProperty { MpvTimePos = 1, MpvDuration, MpvPause, MpvPath };
+    static void mpvWakeupCallback(void *ctx);
+    void runMpvEventLoop();                     // イベントスレッド
+    void processMpvEvent(const mpv_event *event); // イベントスレッド
+    void handleMpvFileLoaded(quint32 session);
+    void handleMpvEndFile(quint32 session, int reason);
+    void handleMpvPauseChanged(bool paused);
+    MpvStateMirror m_mpvState;
+    QThread *m_mpvEventThread;
+    QSemaphore m_mpvWakeup;
+    QAtomicInt m_mpvEventLoopQuit;
+    // stop() ごとに進める番号。古いファイルのイベントが届いても無視するため
+    QAtomicInteger<quint32> m_mpvSession;
+    quint32 m_mpvFileSession; // 今のファイルが始まったときの番号 (イベントスレッド専用)
+
+    // --- 次の動画の先読み ---
+    // 次の動画を mpv のプレイリストに追加しておき、prefetch-playlist で終わり際に開いてもらう。
+    // EOF で mpv が自分で次へ進むので、play() はそれを止めずに引き継ぐ
+    void queueNextVideo(const QString& filePath);
+    QString m_mpvCurrentFilePath;  // mpv に渡した再生中の動画
+    QString m_mpvQueuedFilePath;   // mpv のプレイリストで次に控えている動画
+    QString m_mpvAdvancedFilePath; // mpv が既に進んでいて、play() が呼ばれるのを待っている動画
+
+    // --- シーク索引 (MP3) ---
+    // ★ 目的の時刻の数フレーム手前から曲を開き直し、残りだけをデコーダにシークさせる。
+    //    VBR でも先頭からデコードせず、位置もずれない。索引は初回の再生時にバックグラウンドで作る
+    //    開き直した曲はエンコーダ遅延を削られないので、元の曲でデコーダが削っていたぶんを時刻で補う
+    // ※ 開き直し (ファイルを開いてデコーダを作る) はワーカーで行い、差し替えだけをメインスレッドで行う
+    void requestSeekIndex(const QString& filePath);
+    bool seekWithIndex(double seconds);
+    void finishIndexedSeek(Mix_Music *music, const QString& filePath, double seconds, double startSeconds, quint32 generation);
+    QString m_musicFilePath;     // m_music の曲
+    SeekIndex m_seekIndex;       // m_music の曲の索引 (正確でなければ Mix_SetMusicPosition に任せる)
+    double m_musicStartSeconds;  // m_music を曲の途中から開いていれば、その位置の時刻
+    int m_seekDelaySamples;      // 元の曲でデコーダが先頭から削っていたサンプル数 (LAME タグの遅延。削らなければ 0)
+    QSharedPointer<QAtomicInt> m_seekIndexCancelled; // 曲が変わったら立て、作りかけの索引を捨てる
+    quint32 m_seekGeneration;    // シーク / stop() ごとに進める番号。開き直しが終わったとき古ければ捨てる
+    double m_pendingSeekSeconds; // 開き直しを待っているシーク先 (なければ負。その間はスライダーに表示する)
+    QThreadPool m_seekPool;      // 開き直し用 (1本。終了時に待つ)
 
     // --- SDLコールバック ---
     static void musicFinishedCallback();
@@ -63,14 +179,24 @@ private:
     // --- データメンバ ---
     static MediaManager* instance; // SDLコールバック用
     mpv_handle *m_mpv;
-    QTimer *m_mpvEventTimer;
     QTimer *m_progressTimer;
 
     Mix_Music *m_music;
-    QByteArray m_currentMusicData;
 
     // --- 状態変数 ---
     float m_volumeGain;
+    float m_trackGain;     // 再生中の曲のラウドネス補正 (倍率)
+    float m_appliedGain;   // 直前のバッファの末尾で適用したゲイン (オーディオスレッド専用。PCM の再生中は音量だけ)
+    std::function<float(const QString&)> m_trackGainLookup;
+    std::function<QString()> m_upcomingTrackLookup;
+    Uint16 m_audioFormat;  // デバイスのサンプル形式 (Mix_QuerySpec で取得)
+    int m_audioChannels;   // デバイスのチャンネル数 (ゲインをフレーム単位で進める)
+    bool m_audioOpened;
+    bool m_nativeRateOutput;  // 曲のサンプリングレートでデバイスを開く
+    bool m_lowLatencyOutput;  // 小さいバッファで開く
+    int m_requestedFrequency; // 開くときに要求したレート (実際のレートとは違うことがある)
+    int m_outputFrequency;    // 実際に開かれたレート
+    int m_outputChunkSize;
     int m_currentVolumePercent;
     bool m_isMuted;
     int m_volumeBeforeMute;
@@ -78,10 +204,11 @@ private:
     bool m_isPaused;
 
     // --- 定数 ---
-    static const int MPV_EVENT_TIMER_INTERVAL = 20;
+    static const int MPV_PROGRESS_INTERVAL = 20; // 動画の再生位置をミラーから読む間隔
     static const int AUDIO_FREQUENCY = 44100;
     static const int AUDIO_CHANNELS = 2;
-    static const int AUDIO_CHUNK_SIZE = 2048;
+    static const int AUDIO_CHUNK_SIZE = 2048;       // 約46ms (44.1kHz)
+    static const int LOW_LATENCY_CHUNK_SIZE = 512;  // 約12ms (44.1kHz)
 };
 
 #endif // MEDIAMANAGER_H
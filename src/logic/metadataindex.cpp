@@ -0,0 +1,268 @@
+#include "metadataindex.h"
+#include "mediamanager.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent/qtconcurrentrun.h>
+
+#include <mpv/client.h>
+
+namespace {
+const quint32 INDEX_MAGIC = 0x5844494D; // "MIDX"
+const quint32 INDEX_VERSION = 1;
+const double REFERENCE_LUFS = -18.0;   // ReplayGain 2.0 の基準ラウドネス
+const float MIN_GAIN_DB = -20.0f;
+const float MAX_GAIN_DB = 10.0f;
+
+// 文字列のプロパティ (なければ空)
+QString propertyString(mpv_handle *mpv, const char *name)
+{
+    char *value = mpv_get_property_string(mpv, name);
+    if (!value) return QString();
+    const QString result = QString::fromUtf8(value);
+    mpv_free(value);
+    return result;
+}
+
+// "-6.45 dB" のような ReplayGain のタグを読む
+bool parseGainTag(const QString &tag, float *gainDb)
+{
+    bool ok = false;
+    const float value = tag.section(' ', 0, 0, QString::SectionSkipEmpty).toFloat(&ok);
+    if (ok) *gainDb = value;
+    return ok;
+}
+}
+
+MetadataIndex::MetadataIndex(QObject *parent)
+    : QObject(parent)
+    , m_dirty(false)
+    , m_cancelled(new QAtomicInt(0))
+    , m_runningBatches(0)
+{
+    m_filePath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/metadata.idx";
+    m_pool.setMaxThreadCount(MAX_JOBS);
+    load();
+}
+
+MetadataIndex::~MetadataIndex()
+{
+    // 未着手のバッチは捨て、実行中のものはファイルの区切りで止めさせる
+    m_cancelled->storeRelaxed(1);
+    m_pool.clear();
+    m_pool.waitForDone();
+    save();
+}
+
+bool MetadataIndex::lookup(const QString &filePath, Metadata *metadata) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_records.constFind(filePath);
+    if (it == m_records.constEnd()) return false;
+
+    if (metadata) *metadata = it->metadata;
+    return true;
+}
+
+void MetadataIndex::request(const QStringList &filePaths)
+{
+    QStringList targets;
+    for (const QString &filePath : filePaths) {
+        if (m_checked.contains(filePath)) continue;
+        m_checked.insert(filePath);
+        targets.append(filePath);
+    }
+
+    // 1件ずつではなく数件ずつまとめて投げる (巨大なプレイリストでもジョブとウォッチャーが増えすぎない)
+    for (int start = 0; start < targets.size(); start += BATCH_SIZE) {
+        const QStringList batch = targets.mid(start, BATCH_SIZE);
+        QSharedPointer<QAtomicInt> cancelled = m_cancelled;
+
+        // ★ 破棄時はプールの完了を待つので、ワーカーから this を参照してよい
+        auto future = QtConcurrent::run(&m_pool, [this, batch, cancelled]() {
+            QStringList updated;
+            for (const QString &filePath : batch) {
+                if (cancelled->loadRelaxed()) break;
+
+                // 記録が今のファイルと一致すれば調べ直さない
+                const QFileInfo info(filePath);
+                {
+                    QMutexLocker locker(&m_mutex);
+                    auto it = m_records.constFind(filePath);
+                    if (it != m_records.constEnd() && it->lastModified == info.lastModified() && it->size == info.size()) continue;
+                }
+
+                Record record;
+                record.lastModified = info.lastModified();
+                record.size = info.size();
+                if (!probe(filePath, &record.metadata, cancelled.data())) continue;
+
+                QMutexLocker locker(&m_mutex);
+                // 上限を超えたら作り直す (古い記録の寿命管理まではしない)
+                if (m_records.size() >= MAX_RECORDS) m_records.clear();
+                m_records.insert(filePath, record);
+                m_dirty = true;
+                updated.append(filePath);
+            }
+            return updated;
+        });
+
+        auto watcher = new QFutureWatcher<QStringList>(this);
+        connect(watcher, &QFutureWatcher<QStringList>::finished, this, [this, watcher]() {
+            --m_runningBatches;
+            const QStringList updated = watcher->result();
+            watcher->deleteLater();
+            if (!updated.isEmpty()) emit metadataReady(updated);
+
+            // 一段落したら書き出しておく
+            if (m_runningBatches == 0) save();
+        });
+        ++m_runningBatches;
+        watcher->setFuture(future);
+    }
+}
+
+QString MetadataIndex::displayName(const QString &filePath, const Metadata &metadata)
+{
+    if (metadata.title.isEmpty()) return QFileInfo(filePath).fileName();
+    return metadata.artist.isEmpty() ? metadata.title : metadata.artist + " - " + metadata.title;
+}
+
+void MetadataIndex::load()
+{
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    QDataStream in(&file);
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if (magic != INDEX_MAGIC || version != INDEX_VERSION) return;
+
+    qint32 count = 0;
+    in >> count;
+    m_records.reserve(count);
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString key;
+        Record record;
+        Metadata &m = record.metadata;
+        in >> key >> record.lastModified >> record.size
+           >> m.durationMs >> m.title >> m.artist >> m.album >> m.hasGain >> m.gainDb;
+        m_records.insert(key, record);
+    }
+    if (in.status() != QDataStream::Ok) {
+        qDebug() << "MetadataIndex: broken index file, ignored" << m_filePath;
+        m_records.clear();
+    }
+}
+
+void MetadataIndex::save()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_dirty) return;
+
+    QDir().mkpath(QFileInfo(m_filePath).absolutePath());
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "MetadataIndex: failed to save" << m_filePath << file.errorString();
+        return;
+    }
+
+    QDataStream out(&file);
+    out << INDEX_MAGIC << INDEX_VERSION << qint32(m_records.size());
+    for (auto it = m_records.constBegin(); it != m_records.constEnd(); ++it) {
+        const Metadata &m = it->metadata;
+        out << it.key() << it->lastModified << it->size
+            << m.durationMs << m.title << m.artist << m.album << m.hasGain << m.gainDb;
+    }
+    if (file.commit()) m_dirty = false;
+}
+
+bool MetadataIndex::probe(const QString &filePath, Metadata *metadata, const QAtomicInt *cancelled)
+{
+    mpv_handle *mpv = mpv_create();
+    if (!mpv) return false;
+
+    // 映像も音も出さない。音声は測るときだけ、実時間を待たずにデコードさせる
+    mpv_set_option_string(mpv, "vo", "null");
+    mpv_set_option_string(mpv, "vid", "no");
+    mpv_set_option_string(mpv, "sub", "no");
+    mpv_set_option_string(mpv, "ao", "null");
+    mpv_set_option_string(mpv, "ao-null-untimed", "yes");
+    mpv_set_option_string(mpv, "pause", "yes");
+    mpv_set_option_string(mpv, "keep-open", "yes"); // 最後まで測ったあとも結果を読めるように
+    mpv_set_option_string(mpv, "config", "no");
+    mpv_set_option_string(mpv, "load-scripts", "no");
+    mpv_set_option_string(mpv, "terminal", "no");
+    if (mpv_initialize(mpv) < 0) {
+        mpv_terminate_destroy(mpv);
+        return false;
+    }
+
+    bool loaded = false;
+    const QByteArray path = filePath.toUtf8();
+    const char *loadArgs[] = { "loadfile", path.constData(), nullptr };
+    if (mpv_command(mpv, loadArgs) >= 0) {
+        QElapsedTimer timer;
+        timer.start();
+        while (!loaded && timer.elapsed() < LOAD_TIMEOUT_MS) {
+            const mpv_event *event = mpv_wait_event(mpv, (LOAD_TIMEOUT_MS - timer.elapsed()) / 1000.0);
+            if (event->event_id == MPV_EVENT_FILE_LOADED) loaded = true;
+            else if (event->event_id == MPV_EVENT_END_FILE || event->event_id == MPV_EVENT_NONE) break;
+        }
+    }
+
+    if (loaded) {
+        double duration = 0;
+        mpv_get_property(mpv, "duration", MPV_FORMAT_DOUBLE, &duration);
+        metadata->durationMs = qMax<qint64>(0, qint64(duration * 1000));
+        metadata->title = propertyString(mpv, "metadata/by-key/title");
+        metadata->artist = propertyString(mpv, "metadata/by-key/artist");
+        metadata->album = propertyString(mpv, "metadata/by-key/album");
+
+        // ★ ReplayGain のタグ (曲 -> アルバム) があればそれを使い、なければ音声ファイルだけ実測する
+        float gainDb = 0.0f;
+        metadata->hasGain = parseGainTag(propertyString(mpv, "metadata/by-key/REPLAYGAIN_TRACK_GAIN"), &gainDb)
+                            || parseGainTag(propertyString(mpv, "metadata/by-key/REPLAYGAIN_ALBUM_GAIN"), &gainDb)
+                            || (MediaManager::isAudioFile(filePath) && measureLoudness(mpv, &gainDb, cancelled));
+        metadata->gainDb = qBound(MIN_GAIN_DB, gainDb, MAX_GAIN_DB);
+    }
+
+    mpv_terminate_destroy(mpv);
+    return loaded && !cancelled->loadRelaxed();
+}
+
+bool MetadataIndex::measureLoudness(mpv_handle *mpv, float *gainDb, const QAtomicInt *cancelled)
+{
+    // EBU R128 の積分ラウドネスをフィルタのメタデータとして出させ、最後まで流す
+    mpv_observe_property(mpv, 0, "eof-reached", MPV_FORMAT_FLAG);
+    if (mpv_set_property_string(mpv, "af", "@lufs:lavfi=[ebur128=metadata=1]") < 0) return false;
+    int pause = 0;
+    mpv_set_property(mpv, "pause", MPV_FORMAT_FLAG, &pause);
+
+    QElapsedTimer timer;
+    timer.start();
+    bool reachedEnd = false;
+    while (!reachedEnd && timer.elapsed() < MEASURE_TIMEOUT_MS) {
+        if (cancelled->loadRelaxed()) return false;
+        const mpv_event *event = mpv_wait_event(mpv, 0.1);
+        if (event->event_id == MPV_EVENT_END_FILE) return false;
+        if (event->event_id == MPV_EVENT_PROPERTY_CHANGE) {
+            const mpv_event_property *prop = static_cast<const mpv_event_property *>(event->data);
+            reachedEnd = prop->format == MPV_FORMAT_FLAG && *static_cast<int *>(prop->data) != 0;
+        }
+    }
+    if (!reachedEnd) return false;
+
+    bool ok = false;
+    const double loudness = propertyString(mpv, "af-metadata/lufs/by-key/lavfi.r128.I").toDouble(&ok);
+    if (!ok || loudness <= -70.0) return false; // 無音 (ゲートで測れない)
+
+    *gainDb = float(REFERENCE_LUFS - loudness);
+    return true;
+}
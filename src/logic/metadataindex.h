@@ -0,0 +1,77 @@
+#ifndef METADATAINDEX_H
+#define METADATAINDEX_H
+
+#include <QAtomicInt>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+
+struct mpv_handle;
+
+// プレイリストの曲の情報 (長さ・タグ・ラウドネス) の索引
+// - ファイルの更新日時とサイズが変わらない限り、前回調べた結果をそのまま使う (再起動後も有効)
+// - 調べるのは同時実行数を絞った専用のスレッドプールで、ヘッドレスの libmpv を使う
+// - ラウドネスは ReplayGain のタグを優先し、なければ音声ファイルだけ EBU R128 で測る
+class MetadataIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Metadata {
+        qint64 durationMs = 0; // 0 なら不明
+        QString title;
+        QString artist;
+        QString album;
+        bool hasGain = false;
+        float gainDb = 0.0f;   // 基準ラウドネスに揃えるためのゲイン (dB)
+    };
+
+    explicit MetadataIndex(QObject *parent = nullptr);
+    ~MetadataIndex();
+
+    // 記録があれば true (ファイルの確認はしないので描画中にも呼べる)
+    bool lookup(const QString &filePath, Metadata *metadata) const;
+    // 未確認のファイルをバックグラウンドで調べる (記録が古ければ調べ直す)
+    void request(const QStringList &filePaths);
+    void save();
+
+    static QString displayName(const QString &filePath, const Metadata &metadata); // "アーティスト - タイトル" (タグがなければファイル名)
+
+signals:
+    void metadataReady(const QStringList &filePaths); // 記録が新しくなったファイル
+
+private:
+    struct Record {
+        QDateTime lastModified;
+        qint64 size = 0;
+        Metadata metadata;
+    };
+
+    void load();
+    static bool probe(const QString &filePath, Metadata *metadata, const QAtomicInt *cancelled);
+    static bool measureLoudness(mpv_handle *mpv, float *gainDb, const QAtomicInt *cancelled);
+
+    mutable QMutex m_mutex;
+    QString m_filePath;
+    QHash<QString, Record> m_records;
+    bool m_dirty;
+
+    QThreadPool m_pool;
+    QSharedPointer<QAtomicInt> m_cancelled; // 破棄時に立て、実行中のジョブを止める
+    QSet<QString> m_checked; // このセッションで確認済み / 確認中のファイル
+    int m_runningBatches;
+
+    static const int MAX_JOBS = 2;
+    static const int BATCH_SIZE = 16;
+    static const int MAX_RECORDS = 50000;
+    static const int LOAD_TIMEOUT_MS = 5000;
+    static const int MEASURE_TIMEOUT_MS = 60000;
+};
+
+#endif // METADATAINDEX_H
@@ -0,0 +1,208 @@
+#include "pcmplayer.h"
+#include "sdlfilestream.h"
+#include "gainkernels.h"
+#include <QDebug>
+#include <cstring>
+
+PcmPlayer::PcmPlayer()
+    : m_track(nullptr)
+    , m_next(nullptr)
+    , m_retired(nullptr)
+    , m_switchCount(0)
+    , m_cursor(0)
+    , m_seekFrame(-1)
+    , m_paused(0)
+    , m_endReported(false)
+    , m_format(AUDIO_S16SYS)
+    , m_channels(2)
+    , m_frequency(44100)
+    , m_frameBytes(4)
+{
+}
+
+PcmPlayer::~PcmPlayer()
+{
+    setTrack(nullptr);
+}
+
+PcmPlayer::DecodeResult PcmPlayer::decode(const QString &filePath, float gain, const QAtomicInt *cancelled)
+{
+    DecodeResult result;
+    if (cancelled && cancelled->loadRelaxed()) return result;
+
+    int frequency = 0;
+    Uint16 format = 0;
+    int channels = 0;
+    if (Mix_QuerySpec(&frequency, &format, &channels) == 0) return result; // デバイスが閉じている
+    const qint64 frameBytes = qint64(SDL_AUDIO_BITSIZE(format) / 8) * channels;
+
+    // ★ 長すぎる曲 (オーディオブックなど) はメモリに載せない。長さはデコーダを開くだけで分かる
+    SDL_RWops *rw = SdlFileStream::open(filePath);
+    if (!rw) return result;
+    Mix_Music *music = Mix_LoadMUS_RW(rw, 1);
+    if (!music) {
+        qDebug() << "PcmPlayer: Mix_LoadMUS_RW Error:" << Mix_GetError();
+        return result;
+    }
+    const double seconds = Mix_MusicDuration(music);
+    Mix_FreeMusic(music);
+    if (seconds <= 0 || seconds * frequency * frameBytes > MAX_DECODED_BYTES) {
+        result.tooLong = true;
+        return result;
+    }
+    if (cancelled && cancelled->loadRelaxed()) return result;
+
+    // 曲全体をデバイスの形式 (レート・チャンネル数も) に変換して読み込む (SDL_mixer 2.6 以降は MP3 / FLAC / Ogg も読める)
+    rw = SdlFileStream::open(filePath);
+    if (!rw) return result;
+    Mix_Chunk *chunk = Mix_LoadWAV_RW(rw, 1);
+    if (!chunk) {
+        qDebug() << "PcmPlayer: Mix_LoadWAV_RW Error:" << Mix_GetError();
+        return result;
+    }
+
+    result.track = new Track;
+    result.track->filePath = filePath;
+    result.track->chunk = chunk;
+    result.track->frames = chunk->alen / frameBytes;
+    result.track->gain = gain;
+    return result;
+}
+
+void PcmPlayer::free(Track *track)
+{
+    if (!track) return;
+    if (track->chunk) Mix_FreeChunk(track->chunk);
+    delete track;
+}
+
+void PcmPlayer::setOutputFormat(Uint16 format, int channels, int frequency)
+{
+    m_format = format;
+    m_channels = qMax(1, channels);
+    m_frequency = qMax(1, frequency);
+    m_frameBytes = qMax(1, SDL_AUDIO_BITSIZE(format) / 8) * m_channels;
+}
+
+void PcmPlayer::setTrack(Track *track)
+{
+    free(m_track.fetchAndStoreRelaxed(track));
+    free(m_next.fetchAndStoreRelaxed(nullptr));
+    collectRetired();
+    m_switchCount.storeRelaxed(0);
+    m_cursor.storeRelaxed(0);
+    m_seekFrame.storeRelaxed(-1);
+    m_paused.storeRelaxed(0);
+    m_endReported = false;
+}
+
+void PcmPlayer::collectRetired()
+{
+    Track *track = m_retired.fetchAndStoreAcquire(nullptr);
+    while (track) {
+        Track *next = track->retiredNext;
+        free(track);
+        track = next;
+    }
+}
+
+void PcmPlayer::seek(double seconds)
+{
+    const Track *track = m_track.loadAcquire();
+    if (!track) return;
+    m_seekFrame.storeRelease(qBound<qint64>(0, qint64(seconds * m_frequency), track->frames));
+}
+
+double PcmPlayer::position() const
+{
+    // 反映を待っているシーク先があればそれを出す (スライダーが前の位置へ戻らないように)
+    const qint64 seekFrame = m_seekFrame.loadAcquire();
+    return double(seekFrame >= 0 ? seekFrame : m_cursor.loadAcquire()) / m_frequency;
+}
+
+double PcmPlayer::duration() const
+{
+    const Track *track = m_track.loadAcquire();
+    return track ? double(track->frames) / m_frequency : 0.0;
+}
+
+int PcmPlayer::mix(Uint8 *stream, int len, float volumeFrom, float volumeTo)
+{
+    Track *track = m_track.loadRelaxed();
+    if (!track) return NoEvent;
+
+    const qint64 seekFrame = m_seekFrame.fetchAndStoreAcquire(-1);
+    if (seekFrame >= 0) {
+        m_cursor.storeRelease(seekFrame);
+        m_endReported = false;
+    }
+    if (m_paused.loadAcquire()) return NoEvent; // ストリームは無音のまま
+
+    int events = NoEvent;
+    qint64 cursor = m_cursor.loadRelaxed();
+    const int wanted = len / m_frameBytes;
+    int done = 0;
+    while (done < wanted) {
+        if (cursor >= track->frames) {
+            // ★ 次の曲が控えていれば、このバッファの続きのサンプルから切り替える (曲間が空かない)
+            Track *next = m_next.fetchAndStoreAcquire(nullptr);
+            if (!next) break;
+            retire(track);
+            track = next;
+            cursor = 0;
+            m_track.storeRelease(track);
+            m_cursor.storeRelease(0);
+            m_switchCount.ref();
+            m_endReported = false;
+            events |= TrackSwitched;
+            continue;
+        }
+
+        // ★ コピーしてゲインを掛けるだけ (曲の途中で切り替わっても、音量の傾きはバッファ全体で同じ)
+        const int frames = int(qMin<qint64>(wanted - done, track->frames - cursor));
+        Uint8 *out = stream + size_t(done) * m_frameBytes;
+        std::memcpy(out, track->chunk->abuf + cursor * m_frameBytes, size_t(frames) * m_frameBytes);
+        const float volumeStart = volumeFrom + (volumeTo - volumeFrom) * done / wanted;
+        const float volumeEnd = volumeFrom + (volumeTo - volumeFrom) * (done + frames) / wanted;
+        applyGain(out, frames, volumeStart * track->gain, volumeEnd * track->gain);
+        done += frames;
+        cursor += frames;
+        m_cursor.storeRelease(cursor);
+    }
+
+    // 次の曲が控えていれば、終わりは知らせずに次のバッファで切り替える
+    if (cursor >= track->frames && !m_endReported && !m_next.loadAcquire()) {
+        m_endReported = true;
+        events |= TrackEnded;
+    }
+    return events;
+}
+
+void PcmPlayer::retire(Track *track)
+{
+    // 解放はメインスレッドに任せる (ロックせずにリストの先頭へ積む)
+    Track *head = m_retired.loadRelaxed();
+    do {
+        track->retiredNext = head;
+    } while (!m_retired.testAndSetRelease(head, track, head));
+}
+
+void PcmPlayer::applyGain(Uint8 *samples, int frames, float gainFrom, float gainTo) const
+{
+    if (gainFrom == 1.0f && gainTo == 1.0f) return;
+
+    const int count = frames * m_channels;
+    switch (m_format) {
+    case AUDIO_S16SYS:
+        GainKernels::applyS16(reinterpret_cast<qint16*>(samples), count, m_channels, gainFrom, gainTo);
+        break;
+    case AUDIO_S32SYS:
+        GainKernels::applyS32(reinterpret_cast<qint32*>(samples), count, m_channels, gainFrom, gainTo);
+        break;
+    case AUDIO_F32SYS:
+        GainKernels::applyF32(reinterpret_cast<float*>(samples), count, m_channels, gainFrom, gainTo);
+        break;
+    default:
+        break; // 想定外の形式 (8bit / 逆エンディアン) には手を付けない
+    }
+}
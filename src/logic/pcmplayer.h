@@ -0,0 +1,87 @@
+#ifndef PCMPLAYER_H
+#define PCMPLAYER_H
+
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+#include <QString>
+#include <SDL_mixer.h>
+
+// デコード済みの PCM を再生する (Mix_HookMusic に渡すコールバックの中身)
+// - デコードはワーカースレッドで曲全体を済ませておき (decode)、オーディオスレッドの mix はコピーしてゲインを掛けるだけ
+//   重い形式でも、CPU の負荷が高くても、小さいバッファでも途切れない
+// - 位置は読み出し位置 (フレーム数) なので、シークはそれを書き換えるだけでサンプル単位で合う
+// - 次の曲を控えておけば (setNext)、mix が同じバッファの中で曲の最後のサンプルの直後から切り替える (ギャップレス)
+//   切り替えた前の曲はメインスレッドが collectRetired で解放する
+// - メモリに載せきれない長い曲はデコードしない (tooLong を返すので、呼び出し側が Mix_Music で少しずつ再生する)
+// ※ mix はオーディオスレッド、decode はワーカー、それ以外はメインスレッドから呼ぶ
+//    mix とは atomic な値だけでやり取りする (オーディオスレッドでロックを待たない)
+class PcmPlayer
+{
+public:
+    struct Track {
+        QString filePath;
+        Mix_Chunk *chunk = nullptr; // デバイスの形式の PCM
+        qint64 frames = 0;
+        float gain = 1.0f;          // 曲ごとのゲイン (ラウドネス補正。倍率)
+        Track *retiredNext = nullptr; // 解放待ちのリスト (mix が積む)
+    };
+    struct DecodeResult {
+        Track *track = nullptr;
+        bool tooLong = false; // 長すぎる (長さが分からない) のでデコードしなかった
+    };
+    enum Event { NoEvent = 0, TrackEnded = 1, TrackSwitched = 2 };
+
+    // 今開いているデバイスの形式にデコードする (ワーカースレッドで呼ぶ。cancelled が立てばデコードせずに空を返す)
+    static DecodeResult decode(const QString &filePath, float gain, const QAtomicInt *cancelled = nullptr);
+    static void free(Track *track);
+
+    PcmPlayer();
+    ~PcmPlayer();
+
+    // デバイスを開いたときに呼ぶ
+    void setOutputFormat(Uint16 format, int channels, int frequency);
+
+    // コールバックを外している (Mix_HookMusic(nullptr, nullptr) の後) ときだけ呼ぶ
+    // 今の曲 (控えている曲も) を解放して track の先頭から再生する (nullptr なら空にする)
+    void setTrack(Track *track);
+
+    // 次の曲を控える (nullptr なら取り下げる)。前に控えていた曲を返すので、呼び出し側で解放する
+    // (mix が既に切り替えていれば nullptr が返る)
+    Track *setNext(Track *track) { return m_next.fetchAndStoreOrdered(track); }
+    void collectRetired(); // mix が切り替えた前の曲を解放する
+    int switchCount() const { return m_switchCount.loadAcquire(); } // setTrack からの切り替えの回数
+    const Track *currentTrack() const { return m_track.loadAcquire(); } // 解放は collectRetired だけなので読んでよい
+
+    bool hasTrack() const { return m_track.loadAcquire() != nullptr; }
+    void setPaused(bool paused) { m_paused.storeRelease(paused ? 1 : 0); }
+    bool isPaused() const { return m_paused.loadAcquire() != 0; }
+    void seek(double seconds);
+    double position() const;
+    double duration() const;
+
+    // オーディオスレッド: stream (デバイスの形式、無音で埋められている) に書き込み、Event を返す
+    // 音量はバッファの先頭の volumeFrom から末尾の volumeTo へ変える (曲のゲインはその上に掛ける)
+    int mix(Uint8 *stream, int len, float volumeFrom, float volumeTo);
+
+    static const qint64 MAX_DECODED_BYTES = 192 * 1024 * 1024; // 約19分 (44.1kHz / 16bit / ステレオ)
+
+private:
+    void applyGain(Uint8 *samples, int frames, float gainFrom, float gainTo) const;
+    void retire(Track *track); // オーディオスレッド
+
+    QAtomicPointer<Track> m_track;   // 再生中の曲 (コールバック中は mix だけが書き換える)
+    QAtomicPointer<Track> m_next;    // 控えている曲 (取り出した側が持ち主になる)
+    QAtomicPointer<Track> m_retired; // 切り替え済みで解放を待つ曲のリスト
+    QAtomicInt m_switchCount;
+    QAtomicInteger<qint64> m_cursor;    // 次に出すフレーム
+    QAtomicInteger<qint64> m_seekFrame; // シーク先 (mix が次のバッファで反映する。なければ負)
+    QAtomicInt m_paused;
+    bool m_endReported; // 曲の終わりを知らせたか (オーディオスレッド専用)
+    Uint16 m_format;
+    int m_channels;
+    int m_frequency;
+    int m_frameBytes;
+};
+
+#endif // PCMPLAYER_H
@@ -133,81 +133,108 @@ void PlaylistManager::playTrackInternal(int trackIndex, int playlistIndex)
 
     // 再生すべき曲をシグナルで通知
     emit trackReadyToPlay(playlist.at(trackIndex), playlistIndex, trackIndex); //
+
+    // 次の曲を先読みできるように通知
+    updateUpcomingTrack();
 }
 
-void PlaylistManager::requestNextTrack()
+int PlaylistManager::resolveNextTrack()
 {
-    // 現在のプレイリストが空なら何もしない
-    if (getCurrentTrackCount() == 0) return;
+    const int trackCount = getCurrentTrackCount();
+    if (trackCount == 0) return -1;
 
-    int playlistIndex = m_currentPlaylistIndex;
-    QStringList& currentPlaylist = m_allPlaylists[playlistIndex];
-
-    // 1曲リピートの場合 (手動操作でもリピートを優先するか、スキップするかは設計次第ですが、
-    // 既存コードに合わせてリピート優先としています)
     if (m_currentLoopMode == RepeatOne) {
-        playTrackAtIndex(getCurrentTrackIndex(), playlistIndex);
-        return;
+        return getCurrentTrackIndex();
     }
 
-    int newIndex = -1;
-
     switch (m_shuffleMode) {
     case ShuffleOff: // 通常のシーケンシャル再生
     {
-        // ★履歴に関係なく、現在のリスト位置の「次」を取得
-        int currentIndex = getCurrentTrackIndex();
-        newIndex = currentIndex + 1;
-
-        if (newIndex >= currentPlaylist.size()) {
-            if (m_currentLoopMode == RepeatAll) {
-                newIndex = 0; // 全曲リピートなら最初に戻る
-            } else {
-                emit playbackShouldStop(); // ループなしなら停止
-                return;
-            }
+        int newIndex = getCurrentTrackIndex() + 1;
+        if (newIndex >= trackCount) {
+            newIndex = (m_currentLoopMode == RepeatAll) ? 0 : -1; // 全曲リピートなら最初に戻る
         }
+        return newIndex;
     }
-    break;
 
     case ShuffleNoRepeat: // 重複なしランダム再生
     {
         if (m_shuffledPlaylist.isEmpty()) generateShuffledPlaylist();
-
-        m_shuffledIndex++; // 再生リストの次の曲へ
-        if (m_shuffledIndex >= m_shuffledPlaylist.size()) {
-            // リストの最後まで再生しきった
-            if (m_currentLoopMode == RepeatAll) {
-                // リセットして再生成
-                int lastPlayedIndex = m_shuffledPlaylist.isEmpty() ? -1 : m_shuffledPlaylist.last();
-                generateShuffledPlaylist();
-                // 直前と同じ曲が先頭に来ないようにスワップ
-                if (!m_shuffledPlaylist.isEmpty() && m_shuffledPlaylist.size() > 1 &&
-                    m_shuffledPlaylist.first() == lastPlayedIndex) {
-                    m_shuffledPlaylist.swapItemsAt(0, 1);
-                }
-                m_shuffledIndex = 0;
-                newIndex = m_shuffledPlaylist.value(m_shuffledIndex, -1);
-            } else {
-                emit playbackShouldStop(); // ループなしなら停止
-                return;
+        if (m_shuffledIndex + 1 < m_shuffledPlaylist.size()) {
+            return m_shuffledPlaylist.value(m_shuffledIndex + 1, -1);
+        }
+        if (m_currentLoopMode != RepeatAll) return -1;
+
+        // リストの最後まで再生しきった -> 次の周回を先に作っておく
+        if (m_nextShuffleCycle.isEmpty()) {
+            const int lastPlayedIndex = m_shuffledPlaylist.isEmpty() ? -1 : m_shuffledPlaylist.last();
+            m_nextShuffleCycle = makeShuffledOrder(trackCount);
+            // 直前と同じ曲が先頭に来ないようにスワップ
+            if (m_nextShuffleCycle.size() > 1 && m_nextShuffleCycle.first() == lastPlayedIndex) {
+                m_nextShuffleCycle.swapItemsAt(0, 1);
             }
-        } else {
-            newIndex = m_shuffledPlaylist.value(m_shuffledIndex, -1);
         }
+        return m_nextShuffleCycle.value(0, -1);
     }
-    break;
 
-    case ShuffleRepeat: // 重複ありランダム再生
+    case ShuffleRepeat: // 重複ありランダム再生 (引いた結果は実際に再生するまで保持)
     {
-        newIndex = QRandomGenerator::global()->bounded(currentPlaylist.size());
+        if (m_pendingRandomTrack < 0 || m_pendingRandomTrack >= trackCount) {
+            m_pendingRandomTrack = QRandomGenerator::global()->bounded(trackCount);
+        }
+        return m_pendingRandomTrack;
+    }
+    }
+    return -1;
+}
+
+QString PlaylistManager::upcomingTrack()
+{
+    // ★ 再生中のプレイリストを表示しているときだけ、requestNextTrack() と同じ規則で決まる
+    if (m_playingPlaylistIndex < 0 || m_playingPlaylistIndex != m_currentPlaylistIndex) return QString();
+    const int nextIndex = resolveNextTrack();
+    return nextIndex >= 0 ? m_allPlaylists[m_currentPlaylistIndex].value(nextIndex) : QString();
+}
+
+void PlaylistManager::updateUpcomingTrack()
+{
+    emit upcomingTrackChanged(upcomingTrack());
+}
+
+void PlaylistManager::requestNextTrack()
+{
+    // 現在のプレイリストが空なら何もしない
+    if (getCurrentTrackCount() == 0) return;
+
+    int playlistIndex = m_currentPlaylistIndex;
+
+    // 1曲リピートの場合 (手動操作でもリピートを優先するか、スキップするかは設計次第ですが、
+    // 既存コードに合わせてリピート優先としています)
+    if (m_currentLoopMode == RepeatOne) {
+        playTrackAtIndex(getCurrentTrackIndex(), playlistIndex);
+        return;
     }
-    break;
+
+    // ★ 先読み (updateUpcomingTrack) と同じ規則で次の曲を決める
+    const int newIndex = resolveNextTrack();
+    if (newIndex < 0) {
+        emit playbackShouldStop(); // ループなしなら停止
+        return;
     }
 
-    if (newIndex != -1) {
-        playTrackAtIndex(newIndex, playlistIndex);
+    // 先に決めておいた分を確定させる
+    if (m_shuffleMode == ShuffleNoRepeat) {
+        if (m_shuffledIndex + 1 >= m_shuffledPlaylist.size()) {
+            m_shuffledPlaylist = m_nextShuffleCycle;
+            m_nextShuffleCycle.clear();
+            m_shuffledIndex = 0;
+        } else {
+            m_shuffledIndex++; // 再生リストの次の曲へ
+        }
     }
+    m_pendingRandomTrack = -1;
+
+    playTrackAtIndex(newIndex, playlistIndex);
 }
 
 void PlaylistManager::requestPreviousTrack()
@@ -256,6 +283,7 @@ void PlaylistManager::requestPreviousTrack()
 void PlaylistManager::setLoopMode(LoopMode mode)
 {
     m_currentLoopMode = mode;
+    updateUpcomingTrack();
 }
 
 void PlaylistManager::setShuffleMode(ShuffleMode mode)
@@ -264,13 +292,17 @@ void PlaylistManager::setShuffleMode(ShuffleMode mode)
     if (m_shuffleMode == ShuffleNoRepeat) {
         generateShuffledPlaylist();
     }
+    m_pendingRandomTrack = -1;
     clearPlayHistory();
+    updateUpcomingTrack();
 }
 
 void PlaylistManager::setCurrentPlaylistIndex(int index)
 {
-    if (index >= 0 && index < m_allPlaylists.size()) {
+    if (index >= 0 && index < m_allPlaylists.size() && index != m_currentPlaylistIndex) {
         m_currentPlaylistIndex = index;
+        // ★ 表示中のプレイリストが変わると次の曲も変わるため、先読みをやり直す
+        updateUpcomingTrack();
     }
 }
 
@@ -278,6 +310,7 @@ void PlaylistManager::stopPlayback()
 {
     m_playingPlaylistIndex = -1;
     // 現在のトラックインデックスはリセットしない（停止した場所を覚えておく）
+    updateUpcomingTrack();
 }
 
 // --- データ操作 ---
@@ -316,6 +349,9 @@ void PlaylistManager::addFilesToPlaylistChunked(const QStringList &files, int pl
         // "再生中" ではない場合、追加したファイルの先頭から再生を開始
         if (m_playingPlaylistIndex == -1) {
             playTrackAtIndex(originalItemCount, playlistIndex);
+        } else if (playlistIndex == m_playingPlaylistIndex) {
+            // 末尾に追加された曲が次の曲になることがある
+            updateUpcomingTrack();
         }
 
         m_asyncOperations--;
@@ -349,9 +385,11 @@ void PlaylistManager::removeIndices(int playlistIndex, const QList<int>& indices
     }
     emit playlistDataChanged(playlistIndex);
     if (m_shuffleMode == ShuffleNoRepeat) generateShuffledPlaylist();
+    m_pendingRandomTrack = -1;
     if (playlistIndex == m_currentPlaylistIndex) {
         clearPlayHistory();
     }
+    updateUpcomingTrack();
 }
 
 void PlaylistManager::clearPlaylist(int playlistIndex)
@@ -363,9 +401,11 @@ void PlaylistManager::clearPlaylist(int playlistIndex)
 
     emit playlistDataChanged(playlistIndex);
     if (m_shuffleMode == ShuffleNoRepeat) generateShuffledPlaylist();
+    m_pendingRandomTrack = -1;
     if (playlistIndex == m_currentPlaylistIndex) {
         clearPlayHistory();
     }
+    updateUpcomingTrack();
 }
 
 void PlaylistManager::clearPlayHistory()
@@ -408,23 +448,27 @@ void PlaylistManager::syncPlaylistOrder(int playlistIndex, int from, int to)
     if (playlistIndex == m_currentPlaylistIndex) {
         clearPlayHistory();
     }
+    updateUpcomingTrack();
 }
 
 void PlaylistManager::generateShuffledPlaylist()
 {
-    m_shuffledPlaylist.clear();
+    m_shuffledPlaylist = makeShuffledOrder(getCurrentTrackCount());
     m_shuffledIndex = 0;
+    m_nextShuffleCycle.clear();
 
-    int trackCount = getCurrentTrackCount();
-    if (trackCount == 0) return;
+    qDebug() << "Generated shuffled playlist:" << m_shuffledPlaylist;
+}
 
+QList<int> PlaylistManager::makeShuffledOrder(int trackCount)
+{
+    QList<int> order;
     for (int i = 0; i < trackCount; ++i) {
-        m_shuffledPlaylist.append(i);
+        order.append(i);
     }
 
     std::random_device rd;
     std::mt19937 g(rd());
-    std::shuffle(m_shuffledPlaylist.begin(), m_shuffledPlaylist.end(), g);
-
-    qDebug() << "Generated shuffled playlist:" << m_shuffledPlaylist;
+    std::shuffle(order.begin(), order.end(), g);
+    return order;
 }
@@ -35,6 +35,7 @@ public:
     bool canGoNext() const;
     bool canGoPrevious() const;
     int getCurrentTrackCount() const;
+    QString upcomingTrack(); // 曲の終了時に requestNextTrack() が選ぶ曲 (なければ空)
 
 public slots:
     // --- MainWindow (UI) や MediaManager からのイベントを処理するスロット ---
@@ -58,6 +59,7 @@ signals:
     void playbackShouldStop();
     void playlistDataChanged(int playlistIndex); // プレビュー更新用
     void loadingStateChanged(bool isLoading); // ファイル追加時のローディング用
+    void upcomingTrackChanged(const QString& filePath); // 次に再生される曲 (ギャップレス再生の先読み用。なければ空)
 
 private slots:
     void addFilesToPlaylistChunked(const QStringList &files, int playlistIndex, int startIndex);
@@ -66,7 +68,10 @@ private:
     void clearPlayHistory();
     void playTrackInternal(int trackIndex, int playlistIndex);
     void generateShuffledPlaylist();
+    static QList<int> makeShuffledOrder(int trackCount);
     int getCurrentTrackIndex() const;
+    int resolveNextTrack();
+    void updateUpcomingTrack();
 
     // --- データメンバ ---
     QList<QStringList> m_allPlaylists;
@@ -83,6 +88,9 @@ private:
     // --- シャッフル用 ---
     QList<int> m_shuffledPlaylist;
     int m_shuffledIndex;
+    // ★ 次の曲を先に決めておく (先読みした曲と実際に再生する曲を一致させるため)
+    QList<int> m_nextShuffleCycle; // 重複なしランダムの次の周回
+    int m_pendingRandomTrack = -1; // 重複ありランダムで引いておいた次の曲
 
     // --- 非同期処理用 ---
     int m_asyncOperations;
@@ -0,0 +1,482 @@
+#include "seekindex.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <cmath>
+#include <cstring>
+
+namespace {
+const quint32 INDEX_MAGIC = 0x58444953; // "SIDX"
+const quint32 INDEX_VERSION = 2; // 2: エンコーダ遅延を追加
+const qint64 HEADER_PROBE_BYTES = 4096; // 最初のフレームの後ろまで読めば Xing / VBRI は見つかる
+const qint64 MAX_RESYNC_BYTES = 64 * 1024; // 壊れたフレームの後で同期を探し直す範囲
+const int CANCEL_CHECK_FRAMES = 4096;
+const int DECODER_DELAY = 529;          // MP3 のデコーダ自体の遅延 (LAME タグの値に足して削る)
+const qint64 MAX_FRAME_BYTES = 1729;    // Layer II 384kbps / 32kHz
+const int MAX_RESERVOIR_BYTES = 511;    // デコーダが持ち越すビットリザーバ (main_data_begin の上限)
+
+struct FrameHeader {
+    int sampleRate = 0;
+    int samplesPerFrame = 0;
+    int length = 0;       // ヘッダを含むフレームのバイト数
+    int sideInfoSize = 0; // Xing ヘッダの位置を決める (Layer III のみ)
+    int layer = 0;
+    bool mpeg1 = false;
+    bool hasCrc = false;  // ヘッダの直後に CRC (2バイト) がある
+};
+
+quint32 readBE32(const uchar *p)
+{
+    return (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | quint32(p[3]);
+}
+
+quint16 readBE16(const uchar *p)
+{
+    return quint16((p[0] << 8) | p[1]);
+}
+
+// フレームヘッダ (4バイト) を読む。フリーフォーマット (ビットレート 0) は長さが分からないので扱わない
+bool parseFrameHeader(const uchar *p, FrameHeader *header)
+{
+    static const int bitrates[5][16] = {
+        { 0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448, 0 }, // MPEG1 Layer I
+        { 0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 0 },    // MPEG1 Layer II
+        { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0 },     // MPEG1 Layer III
+        { 0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256, 0 },    // MPEG2/2.5 Layer I
+        { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0 },         // MPEG2/2.5 Layer II/III
+    };
+    static const int rates[3] = { 44100, 48000, 32000 };
+
+    if (p[0] != 0xFF || (p[1] & 0xE0) != 0xE0) return false;
+    const int version = (p[1] >> 3) & 3; // 3: MPEG1, 2: MPEG2, 0: MPEG2.5
+    const int layer = 4 - ((p[1] >> 1) & 3); // 1, 2, 3 (4 は予約)
+    const int bitrateIndex = p[2] >> 4;
+    const int rateIndex = (p[2] >> 2) & 3;
+    if (version == 1 || layer == 4 || bitrateIndex == 0 || bitrateIndex == 15 || rateIndex == 3) return false;
+
+    const bool mpeg1 = version == 3;
+    const int row = mpeg1 ? layer - 1 : (layer == 1 ? 3 : 4);
+    const int bitrate = bitrates[row][bitrateIndex] * 1000;
+    const int rate = mpeg1 ? rates[rateIndex] : (version == 2 ? rates[rateIndex] / 2 : rates[rateIndex] / 4);
+    const int padding = (p[2] >> 1) & 1;
+    const bool mono = (p[3] >> 6) == 3;
+
+    header->sampleRate = rate;
+    if (layer == 1) {
+        header->samplesPerFrame = 384;
+        header->length = (12 * bitrate / rate + padding) * 4;
+    } else {
+        header->samplesPerFrame = (layer == 3 && !mpeg1) ? 576 : 1152;
+        header->length = header->samplesPerFrame / 8 * bitrate / rate + padding;
+    }
+    header->sideInfoSize = layer != 3 ? 0 : (mpeg1 ? (mono ? 17 : 32) : (mono ? 9 : 17));
+    header->layer = layer;
+    header->mpeg1 = mpeg1;
+    header->hasCrc = (p[1] & 1) == 0;
+    return header->length > 4;
+}
+
+// ID3v2 タグの大きさ (なければ 0)
+qint64 id3v2Size(const uchar *p, qint64 size)
+{
+    if (size < 10 || std::memcmp(p, "ID3", 3) != 0) return 0;
+    const qint64 tagSize = (qint64(p[6] & 0x7F) << 21) | ((p[7] & 0x7F) << 14) | ((p[8] & 0x7F) << 7) | (p[9] & 0x7F);
+    return 10 + tagSize + ((p[5] & 0x10) ? 10 : 0); // フッタ付き
+}
+
+// start 以降で、次のフレームも続いている最初のフレームを探す (偶然の 0xFF を避ける)
+qint64 findFirstFrame(const uchar *p, qint64 size, qint64 start, qint64 limit, FrameHeader *header)
+{
+    for (qint64 i = start; i + 4 <= size && i < start + limit; ++i) {
+        if (!parseFrameHeader(p + i, header)) continue;
+        const qint64 next = i + header->length;
+        FrameHeader nextHeader;
+        if (next + 4 > size) return i; // 1フレームだけのファイル
+        if (parseFrameHeader(p + next, &nextHeader) && nextHeader.sampleRate == header->sampleRate) return i;
+    }
+    return -1;
+}
+
+// 音声ではない情報フレーム (Xing / Info / VBRI) か
+bool isInfoFrame(const uchar *p, qint64 available, const FrameHeader &header)
+{
+    const qint64 xing = 4 + header.sideInfoSize;
+    if (xing + 4 <= available && (std::memcmp(p + xing, "Xing", 4) == 0 || std::memcmp(p + xing, "Info", 4) == 0)) {
+        return true;
+    }
+    return 36 + 4 <= available && std::memcmp(p + 36, "VBRI", 4) == 0;
+}
+
+// Xing / Info フレームの LAME タグから、エンコーダ遅延とパディング (サンプル数) を読む
+bool readLameTag(const uchar *p, qint64 available, const FrameHeader &header, int *delay, int *padding)
+{
+    const qint64 xing = 4 + header.sideInfoSize;
+    if (xing + 8 > available || (std::memcmp(p + xing, "Xing", 4) != 0 && std::memcmp(p + xing, "Info", 4) != 0)) {
+        return false;
+    }
+    const quint32 flags = readBE32(p + xing + 4);
+    qint64 pos = xing + 8;
+    if (flags & 1) pos += 4;   // フレーム数
+    if (flags & 2) pos += 4;   // バイト数
+    if (flags & 4) pos += 100; // 目次
+    if (flags & 8) pos += 4;   // 品質
+    // エンコーダ名 (LAME / ffmpeg は Lavc・Lavf) の 21 バイト目から 12bit ずつ
+    if (pos + 24 > available) return false;
+    const uchar *tag = p + pos;
+    if (std::memcmp(tag, "LAME", 4) != 0 && std::memcmp(tag, "Lavc", 4) != 0 && std::memcmp(tag, "Lavf", 4) != 0) return false;
+    *delay = (tag[21] << 4) | (tag[22] >> 4);
+    *padding = ((tag[22] & 0x0F) << 8) | tag[23];
+    return true;
+}
+
+int sideInfoOffset(const FrameHeader &header)
+{
+    return 4 + (header.hasCrc ? 2 : 0);
+}
+
+// main_data_begin (このフレームのデータがビットリザーバの何バイト前から始まるか。Layer III 以外は 0)
+int mainDataBegin(const uchar *p, const FrameHeader &header)
+{
+    if (header.layer != 3) return 0;
+    const uchar *side = p + sideInfoOffset(header);
+    return header.mpeg1 ? ((side[0] << 1) | (side[1] >> 7)) : side[0];
+}
+
+// ヘッダの後ろ 2 バイトとサイド情報の CRC-16 (多項式 0x8005)
+quint16 frameCrc(const uchar *p, const FrameHeader &header)
+{
+    quint16 crc = 0xFFFF;
+    auto feed = [&crc](uchar byte) {
+        for (int bit = 7; bit >= 0; --bit) {
+            const bool carry = ((crc >> 15) & 1) != ((byte >> bit) & 1);
+            crc = quint16(crc << 1);
+            if (carry) crc ^= 0x8005;
+        }
+    };
+    feed(p[2]);
+    feed(p[3]);
+    for (int i = 0; i < header.sideInfoSize; ++i) feed(p[6 + i]);
+    return crc;
+}
+
+// 予備のフレームに書き換える: サイド情報を消して (何も読まない無音のフレーム) main_data_begin だけ残す
+// メインデータのバイトには触らないので、後ろのフレームはビットリザーバから元どおりに読める
+void patchPrerollFrame(uchar *p, const FrameHeader &header, int dataBegin)
+{
+    uchar *side = p + sideInfoOffset(header);
+    std::memset(side, 0, size_t(header.sideInfoSize));
+    if (header.mpeg1) {
+        side[0] = uchar(dataBegin >> 1);
+        side[1] = uchar((dataBegin & 1) << 7);
+    } else {
+        side[0] = uchar(dataBegin);
+    }
+    if (header.hasCrc) {
+        const quint16 crc = frameCrc(p, header);
+        p[4] = uchar(crc >> 8);
+        p[5] = uchar(crc & 0xFF);
+    }
+}
+}
+
+double SeekIndex::duration() const
+{
+    if (m_sampleRate <= 0) return 0;
+    return double(m_frameCount) * m_samplesPerFrame / m_sampleRate;
+}
+
+double SeekIndex::trimmedDuration() const
+{
+    if (m_sampleRate <= 0) return 0;
+    return double(qMax<qint64>(0, m_frameCount * m_samplesPerFrame - m_encoderDelay - m_encoderPadding)) / m_sampleRate;
+}
+
+SeekIndex::Start SeekIndex::prepareStart(const QString &filePath, double seconds, int delaySamples) const
+{
+    Start start;
+    if (!m_exact || !isValid()) return start;
+
+    // 目的のサンプルを含むフレームと、その手前で実際にデコードする最初のフレーム
+    // (デコーダが先頭で削っていたサンプルのぶん後ろ。フレームの番号は情報フレームを数えない)
+    const qint64 target = qint64(std::floor(qMax(0.0, seconds) * m_sampleRate)) + delaySamples;
+    const qint64 targetFrame = qMin(target / m_samplesPerFrame, m_frameCount - 1);
+    const qint64 firstReal = targetFrame - WARMUP_FRAMES;
+    if (firstReal <= MAX_RESERVOIR_FRAMES) {
+        // 曲の先頭の近くはファイルごと開き直す (タグもそのままなので、時刻は元の曲と同じ)
+        start.offset = 0;
+        return start;
+    }
+
+    // ★ 割り算だけで要素が決まる (先頭からたどらない)。そこから firstReal までのヘッダとサイド情報を読む
+    const int entry = int(qMin<qint64>((firstReal - MAX_RESERVOIR_FRAMES) / FRAME_STRIDE, m_offsets.size() - 1));
+    const qint64 entryFrame = qint64(entry) * FRAME_STRIDE;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(m_offsets.at(entry))) return start;
+    QByteArray data = file.read((firstReal - entryFrame + 1) * MAX_FRAME_BYTES);
+    const uchar *p = reinterpret_cast<const uchar *>(data.constData());
+
+    struct Frame {
+        qint64 pos = 0;
+        FrameHeader header;
+        int dataBegin = 0; // main_data_begin
+        int dataBytes = 0; // このフレームのメインデータのバイト数
+    };
+    QVector<Frame> frames;
+    frames.reserve(int(firstReal - entryFrame + 1));
+    qint64 pos = 0;
+    for (qint64 i = entryFrame; i <= firstReal; ++i) {
+        Frame frame;
+        frame.pos = pos;
+        // 索引を作ったときに同期を探し直したところ (壊れたフレーム) はデコーダのシークに任せる
+        if (pos + 6 + 32 > data.size() || !parseFrameHeader(p + pos, &frame.header)
+            || frame.header.sampleRate != m_sampleRate || frame.header.samplesPerFrame != m_samplesPerFrame) {
+            qDebug() << "SeekIndex: unexpected frame at" << m_offsets.at(entry) + pos << filePath;
+            return start;
+        }
+        frame.dataBegin = mainDataBegin(p + pos, frame.header);
+        frame.dataBytes = qMax(0, frame.header.length - sideInfoOffset(frame.header) - frame.header.sideInfoSize);
+        frames.append(frame);
+        pos += frame.header.length;
+    }
+
+    // 予備のフレームの数を決める: 予備のフレームのメインデータだけで firstReal のビットリザーバが埋まる最少の数
+    // (デコーダが持ち越すのは直前の main_data_begin ぶんと、そのフレームのデータだけなので順に積み上げて数える)
+    const int last = frames.size() - 1;
+    const int maxDataBegin = frames.at(last).header.mpeg1 ? 511 : 255;
+    auto reservoirFrom = [&frames, last, maxDataBegin](int first) {
+        int reservoir = 0;
+        for (int j = first; j < last; ++j) {
+            reservoir = qMin(MAX_RESERVOIR_BYTES, qMin(reservoir, maxDataBegin) + frames.at(j).dataBytes);
+        }
+        return reservoir;
+    };
+    int first = last;
+    while (reservoirFrom(first) < frames.at(last).dataBegin) {
+        if (--first < 0 || last - first > MAX_RESERVOIR_FRAMES) return start;
+    }
+
+    // 予備のフレームを書き換えて head にする (main_data_begin は持ち越せるぶんだけ指す)
+    const qint64 headBegin = frames.at(first).pos;
+    uchar *out = reinterpret_cast<uchar *>(data.data());
+    int reservoir = 0;
+    for (int j = first; j < last; ++j) {
+        const int dataBegin = qMin(reservoir, maxDataBegin);
+        patchPrerollFrame(out + frames.at(j).pos, frames.at(j).header, dataBegin);
+        reservoir = qMin(MAX_RESERVOIR_BYTES, dataBegin + frames.at(j).dataBytes);
+    }
+    start.offset = m_offsets.at(entry) + headBegin;
+    start.head = data.mid(int(headBegin), int(frames.at(last).pos - headBegin));
+    start.seconds = double((entryFrame + first) * m_samplesPerFrame - delaySamples) / m_sampleRate;
+    return start;
+}
+
+SeekIndex SeekIndex::fromHeader(const QString &filePath)
+{
+    SeekIndex index;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return index;
+
+    // ID3v2 (カバー画像で大きいことがある) は読み飛ばす
+    QByteArray head = file.read(10);
+    const qint64 start = id3v2Size(reinterpret_cast<const uchar *>(head.constData()), head.size());
+    if (!file.seek(start)) return index;
+    const QByteArray data = file.read(HEADER_PROBE_BYTES);
+    const uchar *p = reinterpret_cast<const uchar *>(data.constData());
+
+    FrameHeader header;
+    const qint64 at = findFirstFrame(p, data.size(), 0, data.size(), &header);
+    if (at < 0) return index;
+    const uchar *frame = p + at;
+    const qint64 available = data.size() - at;
+    const qint64 frameOffset = start + at;
+
+    int delay = 0, padding = 0;
+    if (readLameTag(frame, available, header, &delay, &padding)) {
+        index.m_encoderDelay = delay + DECODER_DELAY;
+        index.m_encoderPadding = qMax(0, padding - DECODER_DELAY);
+    }
+
+    const qint64 xing = 4 + header.sideInfoSize;
+    if (xing + 8 <= available && (std::memcmp(frame + xing, "Xing", 4) == 0 || std::memcmp(frame + xing, "Info", 4) == 0)) {
+        // Xing: 位置をファイルの 1% ごとの割合 (0-255) で持つ
+        const quint32 flags = readBE32(frame + xing + 4);
+        qint64 pos = xing + 8;
+        qint64 frames = 0;
+        qint64 bytes = file.size() - frameOffset;
+        if (flags & 1) { if (pos + 4 > available) return index; frames = readBE32(frame + pos); pos += 4; }
+        if (flags & 2) { if (pos + 4 > available) return index; bytes = qMax<qint64>(readBE32(frame + pos), 1); pos += 4; }
+        if (!(flags & 4) || frames <= 0 || pos + 100 > available) return index;
+
+        index.m_offsets.resize(100);
+        for (int i = 0; i < 100; ++i) index.m_offsets[i] = frameOffset + qint64(frame[pos + i]) * bytes / 256;
+        index.m_frameCount = frames;
+        index.m_framesPerEntry = frames / 100.0;
+    } else if (36 + 26 <= available && std::memcmp(frame + 36, "VBRI", 4) == 0) {
+        // VBRI: framesPerEntry フレームごとのバイト数 (scale 倍) の並び
+        const uchar *vbri = frame + 36;
+        const qint64 frames = readBE32(vbri + 14);
+        const int entries = readBE16(vbri + 18);
+        const int scale = readBE16(vbri + 20);
+        const int entrySize = readBE16(vbri + 22);
+        const int framesPerEntry = readBE16(vbri + 24);
+        if (frames <= 0 || entries <= 0 || entrySize < 1 || entrySize > 4 || framesPerEntry <= 0
+            || 36 + 26 + qint64(entries) * entrySize > available) {
+            return index;
+        }
+
+        qint64 offset = frameOffset + header.length; // 情報フレームの次から
+        index.m_offsets.reserve(entries + 1);
+        index.m_offsets.append(offset);
+        for (int i = 0; i < entries; ++i) {
+            quint32 value = 0;
+            for (int k = 0; k < entrySize; ++k) value = (value << 8) | vbri[26 + i * entrySize + k];
+            offset += qint64(value) * scale;
+            index.m_offsets.append(offset);
+        }
+        index.m_frameCount = frames;
+        index.m_framesPerEntry = framesPerEntry;
+    } else {
+        return index; // 目次なし (CBR など)
+    }
+
+    index.m_sampleRate = header.sampleRate;
+    index.m_samplesPerFrame = header.samplesPerFrame;
+    index.m_exact = false;
+    return index;
+}
+
+SeekIndex SeekIndex::build(const QString &filePath, const QAtomicInt *cancelled)
+{
+    SeekIndex index = loadCache(filePath);
+    if (index.isValid()) return index;
+
+    index = scan(filePath, cancelled);
+    if (index.isValid()) saveCache(filePath, index);
+    return index;
+}
+
+SeekIndex SeekIndex::scan(const QString &filePath, const QAtomicInt *cancelled)
+{
+    SeekIndex index;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return index;
+
+    // ★ マップしてヘッダだけを飛び飛びに読む (音声データはデコードしない)
+    const qint64 size = file.size();
+    uchar *map = size > 0 ? file.map(0, size) : nullptr;
+    if (!map) {
+        qDebug() << "SeekIndex: failed to map" << filePath << file.errorString();
+        return index;
+    }
+
+    FrameHeader first;
+    qint64 pos = findFirstFrame(map, size, id3v2Size(map, size), MAX_RESYNC_BYTES, &first);
+    if (pos < 0) {
+        file.unmap(map);
+        return index;
+    }
+    if (isInfoFrame(map + pos, size - pos, first)) {
+        int delay = 0, padding = 0;
+        if (readLameTag(map + pos, size - pos, first, &delay, &padding)) {
+            index.m_encoderDelay = delay + DECODER_DELAY;
+            index.m_encoderPadding = qMax(0, padding - DECODER_DELAY);
+        }
+        pos += first.length;
+    }
+
+    qint64 frames = 0;
+    while (pos + 4 <= size) {
+        FrameHeader header;
+        if (!parseFrameHeader(map + pos, &header) || header.sampleRate != first.sampleRate
+            || header.samplesPerFrame != first.samplesPerFrame) {
+            // 末尾のタグか、壊れたフレーム (同期を探し直す)
+            if (std::memcmp(map + pos, "TAG", 3) == 0 || (pos + 8 <= size && std::memcmp(map + pos, "APETAGEX", 8) == 0)) break;
+            const qint64 next = findFirstFrame(map, size, pos + 1, MAX_RESYNC_BYTES, &header);
+            if (next < 0) break;
+            pos = next;
+            continue;
+        }
+        if (pos + header.length > size) break; // 途中で切れた最後のフレーム
+
+        if (frames % FRAME_STRIDE == 0) index.m_offsets.append(pos);
+        ++frames;
+        pos += header.length;
+
+        if (cancelled && frames % CANCEL_CHECK_FRAMES == 0 && cancelled->loadRelaxed()) {
+            file.unmap(map);
+            return SeekIndex();
+        }
+    }
+    file.unmap(map);
+
+    if (frames == 0) return SeekIndex();
+    index.m_sampleRate = first.sampleRate;
+    index.m_samplesPerFrame = first.samplesPerFrame;
+    index.m_frameCount = frames;
+    index.m_framesPerEntry = FRAME_STRIDE;
+    index.m_exact = true;
+    return index;
+}
+
+QString SeekIndex::cacheFilePath(const QString &filePath)
+{
+    const QByteArray hash = QCryptographicHash::hash(QDir::cleanPath(filePath).toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/seekindex/" + QString::fromLatin1(hash) + ".idx";
+}
+
+SeekIndex SeekIndex::loadCache(const QString &filePath)
+{
+    SeekIndex index;
+    QFile file(cacheFilePath(filePath));
+    if (!file.open(QIODevice::ReadOnly)) return index;
+
+    QDataStream in(&file);
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if (magic != INDEX_MAGIC || version != INDEX_VERSION) return index;
+
+    // 曲が書き換えられていれば使わない
+    const QFileInfo info(filePath);
+    QDateTime lastModified;
+    qint64 size = 0;
+    in >> lastModified >> size;
+    if (lastModified != info.lastModified() || size != info.size()) return index;
+
+    qint32 sampleRate = 0, samplesPerFrame = 0, encoderDelay = 0, encoderPadding = 0;
+    in >> sampleRate >> samplesPerFrame >> encoderDelay >> encoderPadding >> index.m_frameCount >> index.m_offsets;
+    if (in.status() != QDataStream::Ok || samplesPerFrame <= 0) {
+        qDebug() << "SeekIndex: broken cache file, ignored" << file.fileName();
+        return SeekIndex();
+    }
+    index.m_sampleRate = sampleRate;
+    index.m_samplesPerFrame = samplesPerFrame;
+    index.m_encoderDelay = encoderDelay;
+    index.m_encoderPadding = encoderPadding;
+    index.m_framesPerEntry = FRAME_STRIDE;
+    index.m_exact = true;
+    return index;
+}
+
+void SeekIndex::saveCache(const QString &filePath, const SeekIndex &index)
+{
+    const QString cachePath = cacheFilePath(filePath);
+    QDir().mkpath(QFileInfo(cachePath).absolutePath());
+    QSaveFile file(cachePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "SeekIndex: failed to save" << cachePath << file.errorString();
+        return;
+    }
+
+    const QFileInfo info(filePath);
+    QDataStream out(&file);
+    out << INDEX_MAGIC << INDEX_VERSION << info.lastModified() << info.size()
+        << qint32(index.m_sampleRate) << qint32(index.m_samplesPerFrame)
+        << qint32(index.m_encoderDelay) << qint32(index.m_encoderPadding) << index.m_frameCount << index.m_offsets;
+    file.commit();
+}
@@ -0,0 +1,62 @@
+#ifndef SEEKINDEX_H
+#define SEEKINDEX_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+// MP3 のシーク索引 (時刻 -> フレームの位置)
+// - VBR の MP3 は時刻からバイト位置を計算できないので、デコーダのシークは不正確か先頭からのデコードになる
+// - 索引があれば目的の時刻の少し手前のフレームを O(1) で引け、そこから開き直して残りだけデコードすればよい
+// - 開き直した曲には LAME タグがないので、デコーダが先頭で削っていたエンコーダ遅延は時刻の計算で補う
+// - Xing / VBRI ヘッダの目次 (概算) はすぐに読め、フレームを数えた索引 (正確) はファイルごとにキャッシュする
+// ※ スレッドセーフ (状態を持たない。scan はワーカースレッドで呼ぶ)
+class SeekIndex
+{
+public:
+    // 開き直す位置
+    struct Start {
+        qint64 offset = -1;  // ファイル先頭からのバイト位置 (フレームの先頭。負なら開き直せない)
+        QByteArray head;     // offset から置き換えて見せるバイト列 (書き換えた予備のフレーム)
+        double seconds = 0;  // 開き直した曲の最初のサンプルの時刻
+    };
+
+    bool isValid() const { return m_sampleRate > 0 && !m_offsets.isEmpty(); }
+    bool isExact() const { return m_exact; } // フレームを数えた索引なら true (目次からの概算なら false)
+    double duration() const;        // 全フレームの長さ
+    double trimmedDuration() const; // LAME タグの遅延とパディングを削った長さ (削るデコーダならこちら)
+    int encoderDelay() const { return m_encoderDelay; } // 削るデコーダが曲の先頭で捨てるサンプル数 (タグがなければ 0)
+
+    // seconds を開き直す位置を決める (正確な索引のみ。ファイルを少し読むのでワーカースレッドで呼ぶ)
+    // ★ 予備のフレームはサイド情報を消して無音にし、ビットリザーバのデータはそのまま残す。
+    //    どのデコーダも予備のフレームを落とさず1フレームずつ出すので、出てきたサンプル数から時刻がずれない
+    // delaySamples は元の曲を開いたデコーダが先頭で削っていたサンプル数 (削らないデコーダなら 0)
+    Start prepareStart(const QString &filePath, double seconds, int delaySamples) const;
+
+    // Xing / VBRI ヘッダの目次から作る (ヘッダがなければ無効)
+    static SeekIndex fromHeader(const QString &filePath);
+    // キャッシュがあれば読み、なければ全フレームのヘッダを数えて作り、キャッシュする (cancelled が立てば中断して無効)
+    static SeekIndex build(const QString &filePath, const QAtomicInt *cancelled = nullptr);
+
+    static const int FRAME_STRIDE = 32;  // 正確な索引で位置を記録する間隔 (フレーム数。約0.8秒)
+    static const int WARMUP_FRAMES = 1;  // 目的のフレームの手前で実際にデコードするフレーム数 (MDCT の重なりを埋める)
+    static const int MAX_RESERVOIR_FRAMES = 16; // ビットリザーバを埋める予備のフレームの上限
+
+private:
+    static SeekIndex scan(const QString &filePath, const QAtomicInt *cancelled);
+    static SeekIndex loadCache(const QString &filePath);
+    static void saveCache(const QString &filePath, const SeekIndex &index);
+    static QString cacheFilePath(const QString &filePath);
+
+    int m_sampleRate = 0;
+    int m_samplesPerFrame = 0;
+    qint64 m_frameCount = 0;
+    double m_framesPerEntry = 0; // m_offsets の1要素あたりのフレーム数
+    QVector<qint64> m_offsets;   // i * m_framesPerEntry 番目のフレームの位置
+    int m_encoderDelay = 0;      // デコーダの遅延 (529) を含む
+    int m_encoderPadding = 0;
+    bool m_exact = false;
+};
+
+#endif // SEEKINDEX_H
@@ -71,6 +71,11 @@ void SettingsManager::loadSettings()
     m_settings.scanSubdirectories = settings.value("scanSubdirectories", false).toBool();
     m_settings.fileScanLimit = settings.value("fileScanLimit", 2000).toInt();
     m_settings.autoUpdatePreviews = settings.value("autoUpdatePreviews", true).toBool();
+    m_settings.continueToSiblingFolder = settings.value("continueToSiblingFolder", false).toBool();
+    m_settings.panoramaAutoScrollSpeed = settings.value("panoramaAutoScrollSpeed", 0).toInt();
+    m_settings.audioNativeRate = settings.value("audioNativeRate", false).toBool();
+    m_settings.audioLowLatency = settings.value("audioLowLatency", false).toBool();
+    m_settings.normalizeLoudness = settings.value("normalizeLoudness", true).toBool();
     m_settings.theme = settings.value("theme", "light").toString();
     m_settings.lastVolume = settings.value("lastVolume", 32).toInt();
     m_settings.contextMenuEnabled = settings.value("contextMenuEnabled", false).toBool();
@@ -132,6 +137,11 @@ void SettingsManager::saveSettings()
     settings.setValue("scanSubdirectories", m_settings.scanSubdirectories);
     settings.setValue("fileScanLimit", m_settings.fileScanLimit);
     settings.setValue("autoUpdatePreviews", m_settings.autoUpdatePreviews);
+    settings.setValue("continueToSiblingFolder", m_settings.continueToSiblingFolder);
+    settings.setValue("panoramaAutoScrollSpeed", m_settings.panoramaAutoScrollSpeed);
+    settings.setValue("audioNativeRate", m_settings.audioNativeRate);
+    settings.setValue("audioLowLatency", m_settings.audioLowLatency);
+    settings.setValue("normalizeLoudness", m_settings.normalizeLoudness);
     settings.setValue("contextMenuEnabled", m_settings.contextMenuEnabled);
     settings.setValue("theme", m_settings.theme);
     settings.setValue("switchOnOpenFile", static_cast<int>(m_settings.switchOnOpenFile));
@@ -24,6 +24,11 @@ struct AppSettings {
     bool scanSubdirectories = false;
     int fileScanLimit = 2000;
     bool autoUpdatePreviews = true;
+    bool continueToSiblingFolder = false; // フォルダの最後で次のフォルダへ進む
+    int panoramaAutoScrollSpeed = 0;      // パノラマのスライドショーを連続スクロールにする速度 (px/秒, 0で無効)
+    bool audioNativeRate = false;         // 曲のサンプリングレートで出力デバイスを開く (再サンプリングしない)
+    bool audioLowLatency = false;         // 出力バッファを小さくして遅延を減らす
+    bool normalizeLoudness = true;        // 曲ごとのラウドネス (ReplayGain / 実測) で音量を揃える
     QString theme = "dark";
     QString lastViewedFile;
     QString lastBookshelfPath;
@@ -0,0 +1,312 @@
+#include "thumbnailstore.h"
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QStandardPaths>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+// パックファイルのレイアウト
+// [FileHeader] [RecordHeader + ピクセル (slotEdge * slotEdge * 4)] [RecordHeader + ...] ...
+struct FileHeader {
+    quint32 magic;
+    quint32 version;
+    quint32 slotEdge;
+    quint32 overwrites; // 満杯になってから上書きしたレコード数 (次に上書きするスロットもこれで決まる)
+};
+
+struct RecordHeader {
+    quint32 magic;
+    quint16 width;
+    quint16 height;
+    quint64 key;
+};
+
+const quint32 FILE_MAGIC = 0x54565351;   // "QSVT"
+const quint32 RECORD_MAGIC = 0x544F4C53; // "SLOT"
+const quint32 FILE_VERSION = 1;
+const qint64 FILE_HEADER_SIZE = sizeof(FileHeader);
+const qint64 RECORD_HEADER_SIZE = sizeof(RecordHeader);
+const int LOCK_TIMEOUT_MS = 1000;
+}
+
+ThumbnailStore::ThumbnailStore(const QString &storeName, int slotEdge, int maxRecordsPerPack)
+    : m_slotEdge(slotEdge)
+    , m_recordSize(RECORD_HEADER_SIZE + qint64(slotEdge) * slotEdge * 4)
+    , m_maxRecords(maxRecordsPerPack)
+{
+    m_rootPath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/" + storeName;
+}
+
+ThumbnailStore::~ThumbnailStore()
+{
+    for (Pack *pack : std::as_const(m_packs)) closePack(pack);
+}
+
+QString ThumbnailStore::packFilePath(const QString &dirPath) const
+{
+    const QByteArray hash = QCryptographicHash::hash(dirPath.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return m_rootPath + "/" + QString::fromLatin1(hash) + ".pack";
+}
+
+quint64 ThumbnailStore::makeKey(const QString &fileName, const QDateTime &lastModified, qint64 size)
+{
+    // qHash はプロセスごとにシードが変わるので、インスタンス間で共有できる固定のハッシュを使う
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(fileName.toUtf8());
+    const qint64 values[2] = { lastModified.toMSecsSinceEpoch(), size };
+    hash.addData(QByteArrayView(reinterpret_cast<const char *>(values), sizeof(values)));
+    return qFromLittleEndian<quint64>(hash.result().constData());
+}
+
+QString ThumbnailStore::dirKeyOf(const QString &filePath, const QString &packDir)
+{
+    const QString dirPath = packDir.isEmpty() ? QFileInfo(filePath).absolutePath() : packDir;
+    return QDir::cleanPath(QDir(dirPath).absolutePath());
+}
+
+QString ThumbnailStore::keyNameOf(const QString &filePath, const QString &dirKey)
+{
+    // パックのディレクトリからの相対パス (同じディレクトリのファイルならファイル名)
+    return QDir(dirKey).relativeFilePath(QFileInfo(filePath).absoluteFilePath());
+}
+
+ThumbnailStore::Pack *ThumbnailStore::openPack(const QString &dirKey)
+{
+    if (Pack *pack = m_packs.value(dirKey)) {
+        m_recentPacks.removeOne(dirKey);
+        m_recentPacks.prepend(dirKey);
+        return pack;
+    }
+
+    // ★ 読むだけなので作らない (パックがなければ見つからないのと同じ。作るのは insert だけ)
+    const QString filePath = packFilePath(dirKey);
+    QFile *file = new QFile(filePath);
+    if (!file->exists() || !file->open(QIODevice::ReadOnly)) {
+        delete file;
+        return nullptr;
+    }
+
+    // ヘッダの確認 (形式違いなら、insert が作り直すまで使わない)
+    FileHeader header = {};
+    const bool valid = file->size() >= FILE_HEADER_SIZE
+                       && file->read(reinterpret_cast<char *>(&header), FILE_HEADER_SIZE) == FILE_HEADER_SIZE
+                       && header.magic == FILE_MAGIC && header.version == FILE_VERSION
+                       && header.slotEdge == quint32(m_slotEdge);
+    if (!valid) {
+        delete file;
+        return nullptr;
+    }
+
+    Pack *pack = new Pack;
+    pack->file = file;
+    pack->indexedSize = FILE_HEADER_SIZE;
+    remap(pack);
+    indexRecords(pack);
+    pack->seenOverwrites = overwritesOf(pack);
+
+    m_packs.insert(dirKey, pack);
+    m_recentPacks.prepend(dirKey);
+
+    // 開いたままにするパックの数を制限 (ファイルハンドル / マップの節約)
+    while (m_recentPacks.size() > MAX_OPEN_PACKS) {
+        closePack(m_packs.take(m_recentPacks.takeLast()));
+    }
+    return pack;
+}
+
+void ThumbnailStore::closePack(Pack *pack)
+{
+    if (!pack) return;
+    if (pack->map) pack->file->unmap(pack->map);
+    pack->file->close();
+    delete pack->file;
+    delete pack;
+}
+
+bool ThumbnailStore::remap(Pack *pack)
+{
+    const qint64 size = pack->file->size();
+    if (pack->map && size == pack->mappedSize) return true;
+
+    if (pack->map) {
+        pack->file->unmap(pack->map);
+        pack->map = nullptr;
+        pack->mappedSize = 0;
+    }
+    if (size <= FILE_HEADER_SIZE) return false;
+
+    pack->map = pack->file->map(0, size);
+    if (!pack->map) {
+        qDebug() << "ThumbnailStore: failed to map" << pack->file->fileName();
+        return false;
+    }
+    pack->mappedSize = size;
+    return true;
+}
+
+quint32 ThumbnailStore::overwritesOf(const Pack *pack)
+{
+    if (!pack->map) return 0;
+    FileHeader header;
+    std::memcpy(&header, pack->map, FILE_HEADER_SIZE);
+    return header.overwrites;
+}
+
+void ThumbnailStore::refresh(Pack *pack)
+{
+    // 他のインスタンスが追記していれば取り込む
+    if (pack->file->size() > pack->mappedSize && remap(pack)) indexRecords(pack);
+
+    // 上書きされたスロットがあれば、インデックスを作り直す (ヘッダだけ読む)
+    const quint32 overwrites = overwritesOf(pack);
+    if (overwrites != pack->seenOverwrites) {
+        pack->index.clear();
+        pack->indexedSize = FILE_HEADER_SIZE;
+        indexRecords(pack);
+        pack->seenOverwrites = overwrites;
+    }
+}
+
+void ThumbnailStore::indexRecords(Pack *pack)
+{
+    if (!pack->map) return;
+
+    // 末尾に追記されたレコードだけを読む (ピクセルには触れない)
+    while (pack->indexedSize + m_recordSize <= pack->mappedSize) {
+        RecordHeader header;
+        std::memcpy(&header, pack->map + pack->indexedSize, RECORD_HEADER_SIZE);
+        if (header.magic == RECORD_MAGIC) {
+            pack->index.insert(header.key, pack->indexedSize); // 後のレコードが優先
+        }
+        pack->indexedSize += m_recordSize;
+    }
+}
+
+QImage ThumbnailStore::find(const QString &filePath, const QDateTime &lastModified, qint64 size, const QString &packDir)
+{
+    const QString dirKey = dirKeyOf(filePath, packDir);
+    const quint64 key = makeKey(keyNameOf(filePath, dirKey), lastModified, size);
+
+    QMutexLocker locker(&m_mutex);
+    Pack *pack = openPack(dirKey);
+    if (!pack) return QImage();
+
+    if (!pack->index.contains(key)) refresh(pack);
+
+    const qint64 offset = pack->index.value(key, -1);
+    if (offset < 0 || !pack->map || offset + m_recordSize > pack->mappedSize) return QImage();
+    if (m_writingSlots.value(pack->file->fileName(), -1) == offset) return QImage();
+
+    RecordHeader header;
+    std::memcpy(&header, pack->map + offset, RECORD_HEADER_SIZE);
+    if (header.magic != RECORD_MAGIC || header.key != key) {
+        pack->index.remove(key); // 他のインスタンスに上書きされたスロット
+        return QImage();
+    }
+    if (header.width == 0 || header.height == 0 || header.width > m_slotEdge || header.height > m_slotEdge) {
+        return QImage();
+    }
+
+    // マップされたピクセルをそのまま参照し、アンマップに備えてコピーして返す
+    const uchar *pixels = pack->map + offset + RECORD_HEADER_SIZE;
+    return QImage(pixels, header.width, header.height, header.width * 4,
+                  QImage::Format_ARGB32_Premultiplied).copy();
+}
+
+void ThumbnailStore::insert(const QString &filePath, const QDateTime &lastModified, qint64 size, const QImage &image,
+                            const QString &packDir)
+{
+    if (image.isNull()) return;
+
+    QImage thumb = image;
+    if (thumb.width() > m_slotEdge || thumb.height() > m_slotEdge) {
+        thumb = thumb.scaled(m_slotEdge, m_slotEdge, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    thumb = thumb.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+    const QString dirKey = dirKeyOf(filePath, packDir);
+    RecordHeader header = { RECORD_MAGIC, quint16(thumb.width()), quint16(thumb.height()),
+                            makeKey(keyNameOf(filePath, dirKey), lastModified, size) };
+
+    QByteArray record(m_recordSize, 0);
+    std::memcpy(record.data(), &header, RECORD_HEADER_SIZE);
+    const int rowBytes = thumb.width() * 4;
+    for (int y = 0; y < thumb.height(); ++y) {
+        std::memcpy(record.data() + RECORD_HEADER_SIZE + qint64(y) * rowBytes, thumb.constScanLine(y), rowBytes);
+    }
+
+    const quint64 key = header.key;
+    if (!QDir().mkpath(m_rootPath)) {
+        qDebug() << "ThumbnailStore: failed to create" << m_rootPath;
+        return;
+    }
+    const QString packPath = packFilePath(dirKey);
+
+    // ★ ロックの待ちと書き込みは m_mutex の外で行う (描画中の find() を待たせない)
+    QMutexLocker writeLocker(&m_writeMutex);
+    QLockFile lock(packPath + ".lock"); // 書き込みはインスタンス間で排他する
+    if (!lock.tryLock(LOCK_TIMEOUT_MS)) return;
+
+    QFile file(packPath);
+    if (!file.open(QIODevice::ReadWrite)) {
+        qDebug() << "ThumbnailStore: failed to open" << packPath << file.errorString();
+        return;
+    }
+
+    // ★ ヘッダはロックを取ってから確認する (待っている間に他のインスタンスが作って追記していることがある)
+    //    新規 / 形式違いのときだけ作り直す
+    FileHeader fileHeader = {};
+    const bool valid = file.read(reinterpret_cast<char *>(&fileHeader), FILE_HEADER_SIZE) == FILE_HEADER_SIZE
+                       && fileHeader.magic == FILE_MAGIC && fileHeader.version == FILE_VERSION
+                       && fileHeader.slotEdge == quint32(m_slotEdge);
+    if (!valid) {
+        fileHeader = { FILE_MAGIC, FILE_VERSION, quint32(m_slotEdge), 0 };
+        if (!file.resize(0) || !file.seek(0)
+            || file.write(reinterpret_cast<const char *>(&fileHeader), FILE_HEADER_SIZE) != FILE_HEADER_SIZE) {
+            qDebug() << "ThumbnailStore: failed to initialize" << packPath;
+            return;
+        }
+    }
+
+    // 途中で書き込みが中断されたレコードがあれば上書きする
+    qint64 end = file.size();
+    end = FILE_HEADER_SIZE + ((end - FILE_HEADER_SIZE) / m_recordSize) * m_recordSize;
+    const quint32 overwritesBefore = fileHeader.overwrites;
+    const bool append = (end - FILE_HEADER_SIZE) / m_recordSize < m_maxRecords;
+    qint64 offset = end;
+    if (!append) {
+        // ★ 満杯なら古い順にスロットを使い回す (書き込みは捨てない)
+        offset = FILE_HEADER_SIZE + qint64(fileHeader.overwrites % m_maxRecords) * m_recordSize;
+        ++fileHeader.overwrites;
+        QMutexLocker locker(&m_mutex);
+        m_writingSlots.insert(packPath, offset);
+    }
+
+    // レコードを書いてから、ヘッダの上書き回数を進める
+    bool written = file.seek(offset) && file.write(record) == m_recordSize;
+    if (written && !append) {
+        written = file.seek(0) && file.write(reinterpret_cast<const char *>(&fileHeader), FILE_HEADER_SIZE) == FILE_HEADER_SIZE;
+    }
+    file.close();
+    lock.unlock();
+    if (!written) qDebug() << "ThumbnailStore: failed to write" << packPath;
+
+    QMutexLocker locker(&m_mutex);
+    m_writingSlots.remove(packPath);
+    Pack *pack = openPack(dirKey);
+    if (!pack || !written) return;
+    if (append) {
+        if (remap(pack)) indexRecords(pack);
+    } else if (pack->seenOverwrites == overwritesBefore) {
+        // 自分の上書きだけならインデックスを直接更新する (古いキーは find() が照合して捨てる)
+        pack->seenOverwrites = fileHeader.overwrites;
+        pack->index.insert(key, offset);
+    } else {
+        refresh(pack);
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef THUMBNAILSTORE_H
+#define THUMBNAILSTORE_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+class QFile;
+
+// ディスク上のサムネイルストア
+// - ディレクトリごとに1つのパックファイル (固定サイズのスロットを追記していく) を持ち、メモリマップして読む
+// - キーは パス + 更新日時 + サイズ (ファイルが更新されれば別キーになり、古いスロットは使われなくなる)
+// - パックが満杯になったら古い順にスロットを上書きして使い回す (使われなくなったスロットもいずれ回収される)
+// - ピクセルは ARGB32_Premultiplied のまま保存するので、読み込み時にデコードは不要
+// - 追記は QLockFile で排他するので、複数のアプリインスタンスで同じストアを共有できる
+// ※ スレッドセーフ (ワーカースレッドからも呼んでよい)
+class ThumbnailStore
+{
+public:
+    // storeName: キャッシュディレクトリ内の保存先 (スロットの大きさが違うストアは別にする)
+    explicit ThumbnailStore(const QString &storeName = QStringLiteral("thumbnails"), int slotEdge = SLOT_EDGE,
+                            int maxRecordsPerPack = MAX_RECORDS_PER_PACK);
+    ~ThumbnailStore();
+
+    // packDir: 保存先のパックのディレクトリ (省略時はファイルのディレクトリ)。
+    //          フォルダの表紙は一覧しているディレクトリのパックにまとめる (1画面でパックを1つだけ開く)
+    // find は読むだけでファイルを作らない。見つからなければ null の QImage を返す
+    QImage find(const QString &filePath, const QDateTime &lastModified, qint64 size, const QString &packDir = QString());
+    void insert(const QString &filePath, const QDateTime &lastModified, qint64 size, const QImage &image,
+                const QString &packDir = QString());
+
+    int slotEdge() const { return m_slotEdge; }
+
+    static const int SLOT_EDGE = 64; // 既定のスロット1辺の最大ピクセル数 (本棚のアイコンサイズ)
+    static const int MAX_RECORDS_PER_PACK = 4096; // 既定の上限。これを超えたら古いスロットから上書きする
+
+private:
+    struct Pack {
+        QFile *file = nullptr;
+        uchar *map = nullptr;
+        qint64 mappedSize = 0;
+        qint64 indexedSize = 0;        // ここまでのレコードをインデックス済み
+        quint32 seenOverwrites = 0;    // インデックスに反映済みの上書き回数 (ヘッダの値と違えば作り直す)
+        QHash<quint64, qint64> index;  // キー -> レコードのオフセット
+    };
+
+    Pack *openPack(const QString &dirKey); // なければ作らずに nullptr
+    void closePack(Pack *pack);
+    bool remap(Pack *pack);
+    void indexRecords(Pack *pack);
+    void refresh(Pack *pack);
+    static quint32 overwritesOf(const Pack *pack);
+    QString packFilePath(const QString &dirPath) const;
+    static QString dirKeyOf(const QString &filePath, const QString &packDir);
+    static QString keyNameOf(const QString &filePath, const QString &dirKey);
+    static quint64 makeKey(const QString &fileName, const QDateTime &lastModified, qint64 size);
+
+    QMutex m_mutex;      // パックとインデックス (find は描画中にも呼ばれるので、ファイルへの書き込み中は持たない)
+    QMutex m_writeMutex; // このインスタンス内の書き込みの順番 (インスタンス間は QLockFile)
+    QString m_rootPath;
+    int m_slotEdge;
+    qint64 m_recordSize;  // RecordHeader + スロット (m_slotEdge * m_slotEdge * 4)
+    int m_maxRecords;
+    QHash<QString, Pack *> m_packs;
+    QStringList m_recentPacks; // LRU (先頭が最新)
+    QHash<QString, qint64> m_writingSlots; // パックファイル -> 上書き中のスロット (読まない)
+
+    static const int MAX_OPEN_PACKS = 16;
+};
+
+#endif // THUMBNAILSTORE_H
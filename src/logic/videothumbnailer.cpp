@@ -0,0 +1,290 @@
+#include "videothumbnailer.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QSemaphore>
+#include <QtConcurrent/qtconcurrentrun.h>
+#include <QtConcurrent/qtconcurrenttask.h>
+
+#include <mpv/client.h>
+#include <mpv/render.h>
+
+namespace {
+const double COVER_POSITION = 0.1; // 表紙は冒頭の黒画面を避けて全体の 10% の位置から取る
+
+// 描画コンテキストの更新通知 (mpv の内部スレッドから呼ばれる)
+void onRenderUpdate(void *ctx)
+{
+    static_cast<QSemaphore *>(ctx)->release();
+}
+
+// 指定のイベントが来るまで待つ (ファイルが終わった / 時間切れなら false)
+bool waitForEvent(mpv_handle *mpv, mpv_event_id id, int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (true) {
+        const qint64 remaining = timeoutMs - timer.elapsed();
+        if (remaining <= 0) return false;
+        const mpv_event *event = mpv_wait_event(mpv, remaining / 1000.0);
+        if (event->event_id == id) return true;
+        if (event->event_id == MPV_EVENT_END_FILE || event->event_id == MPV_EVENT_SHUTDOWN) return false;
+    }
+}
+
+// 次に描画できるフレームが届くのを待って、size の大きさで描画する
+QImage renderFrame(mpv_render_context *render, QSemaphore *updates, const QSize &size, int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (!(mpv_render_context_update(render) & MPV_RENDER_UPDATE_FRAME)) {
+        const qint64 remaining = timeoutMs - timer.elapsed();
+        if (remaining <= 0 || !updates->tryAcquire(1, int(remaining))) return QImage();
+    }
+
+    // ★ 行の先頭を 64 バイト境界に揃えると mpv 側の変換が速い
+    const size_t stride = (size_t(size.width()) * 4 + 63) & ~size_t(63);
+    QByteArray buffer(int(stride * size.height() + 64), Qt::Uninitialized);
+    uchar *pixels = reinterpret_cast<uchar *>((quintptr(buffer.data()) + 63) & ~quintptr(63));
+
+    int renderSize[2] = { size.width(), size.height() };
+    mpv_render_param params[] = {
+        { MPV_RENDER_PARAM_SW_SIZE, renderSize },
+        { MPV_RENDER_PARAM_SW_FORMAT, const_cast<char *>("bgr0") }, // リトルエンディアンの RGB32 と同じ並び
+        { MPV_RENDER_PARAM_SW_STRIDE, const_cast<size_t *>(&stride) },
+        { MPV_RENDER_PARAM_SW_POINTER, pixels },
+        { MPV_RENDER_PARAM_INVALID, nullptr },
+    };
+    if (mpv_render_context_render(render, params) < 0) return QImage();
+
+    return QImage(pixels, size.width(), size.height(), int(stride), QImage::Format_RGB32).copy();
+}
+}
+
+VideoThumbnailer::VideoThumbnailer(QObject *parent)
+    : QObject(parent)
+    , m_store(new ThumbnailStore)
+    , m_previewStore(new ThumbnailStore(QStringLiteral("video-previews"), PREVIEW_EDGE, PREVIEW_RECORDS_PER_PACK))
+    , m_cancelled(new QAtomicInt(0))
+{
+    m_pool.setMaxThreadCount(MAX_JOBS);
+    m_covers.setMaxCost(COVER_CACHE_SIZE);
+    m_previews.setMaxCost(PREVIEW_CACHE_BYTES);
+}
+
+VideoThumbnailer::~VideoThumbnailer()
+{
+    // 未着手のジョブは捨て、実行中のジョブはフレームの区切りで止めさせる
+    m_cancelled->storeRelaxed(1);
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+VideoThumbnailer::FileKey VideoThumbnailer::fileKey(const QString &filePath)
+{
+    auto it = m_fileKeys.constFind(filePath);
+    if (it != m_fileKeys.constEnd()) return *it;
+
+    const QFileInfo info(filePath);
+    FileKey key;
+    key.lastModified = info.lastModified();
+    key.size = info.size();
+    m_fileKeys.insert(filePath, key);
+    return key;
+}
+
+QString VideoThumbnailer::framePath(const QString &filePath, int index)
+{
+    return filePath + QString("#%1").arg(index);
+}
+
+bool VideoThumbnailer::isVideoFile(const QString &filePath)
+{
+    static const QStringList videoExtensions = {"mp4", "mkv", "avi", "mov", "wmv"};
+    return videoExtensions.contains(QFileInfo(filePath).suffix().toLower());
+}
+
+void VideoThumbnailer::request(const QString &filePath)
+{
+    if (filePath.isEmpty() || m_pending.contains(filePath)) return;
+    m_pending.insert(filePath);
+    m_failedCovers.remove(filePath);
+    forgetLookups(filePath);
+
+    // ファイルが更新されていれば作り直せるよう、キーは要求のたびに読み直す
+    m_fileKeys.remove(filePath);
+    const FileKey key = fileKey(filePath);
+    QSharedPointer<ThumbnailStore> store = m_store;
+    QSharedPointer<ThumbnailStore> previewStore = m_previewStore;
+    QSharedPointer<QAtomicInt> cancelled = m_cancelled;
+
+    // ★ 再生中の動画のプレビューは、一覧に並んだ動画の表紙より先に作る
+    auto future = QtConcurrent::task([filePath, key, store, previewStore, cancelled]() {
+        // 表紙と最後のプレビューまで揃っていれば作成済み
+        if (!previewStore->find(framePath(filePath, PREVIEW_FRAMES - 1), key.lastModified, key.size).isNull()
+            && !store->find(filePath, key.lastModified, key.size).isNull()) {
+            return true;
+        }
+        return generate(filePath, key, store.data(), previewStore.data(), true, cancelled.data());
+    }).onThreadPool(m_pool).withPriority(1).spawn();
+    watchJob(future, filePath, false);
+}
+
+void VideoThumbnailer::requestCover(const QString &filePath)
+{
+    if (filePath.isEmpty() || m_pending.contains(filePath) || m_pendingCovers.contains(filePath)
+        || m_failedCovers.contains(filePath)) {
+        return;
+    }
+    m_pendingCovers.insert(filePath);
+
+    const FileKey key = fileKey(filePath);
+    QSharedPointer<ThumbnailStore> store = m_store;
+    QSharedPointer<QAtomicInt> cancelled = m_cancelled;
+    auto future = QtConcurrent::run(&m_pool, [filePath, key, store, cancelled]() {
+        if (!store->find(filePath, key.lastModified, key.size).isNull()) return true;
+        return generate(filePath, key, store.data(), nullptr, false, cancelled.data());
+    });
+    watchJob(future, filePath, true);
+}
+
+void VideoThumbnailer::watchJob(const QFuture<bool> &future, const QString &filePath, bool coverOnly)
+{
+    auto watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher, filePath, coverOnly]() {
+        const bool ok = watcher->result();
+        watcher->deleteLater();
+        if (coverOnly) {
+            m_pendingCovers.remove(filePath);
+            if (!ok) m_failedCovers.insert(filePath);
+        } else {
+            m_pending.remove(filePath);
+        }
+        if (ok) {
+            forgetLookups(filePath);
+            emit thumbnailsReady(filePath);
+        }
+    });
+    watcher->setFuture(future);
+}
+
+void VideoThumbnailer::forgetLookups(const QString &filePath)
+{
+    m_covers.remove(filePath);
+    for (int index = 0; index < PREVIEW_FRAMES; ++index) m_previews.remove(framePath(filePath, index));
+}
+
+QImage VideoThumbnailer::cover(const QString &filePath)
+{
+    if (const QImage *cached = m_covers.object(filePath)) return *cached;
+
+    const FileKey key = fileKey(filePath);
+    const QImage image = m_store->find(filePath, key.lastModified, key.size);
+    m_covers.insert(filePath, new QImage(image));
+    return image;
+}
+
+QImage VideoThumbnailer::previewAt(const QString &filePath, qint64 positionMs, qint64 durationMs)
+{
+    if (filePath.isEmpty() || durationMs <= 0) return QImage();
+
+    // 位置を含む区間のフレーム (フレームは各区間の中央から取っている)
+    const int index = qBound(0, int(positionMs * PREVIEW_FRAMES / durationMs), PREVIEW_FRAMES - 1);
+    const QString path = framePath(filePath, index);
+    if (const QImage *cached = m_previews.object(path)) return *cached;
+
+    const FileKey key = fileKey(filePath);
+    const QImage image = m_previewStore->find(path, key.lastModified, key.size);
+    m_previews.insert(path, new QImage(image), qMax<qsizetype>(1, image.sizeInBytes()));
+    return image;
+}
+
+bool VideoThumbnailer::generate(const QString &filePath, const FileKey &key, ThumbnailStore *coverStore,
+                                ThumbnailStore *previewStore, bool withPreviews, const QAtomicInt *cancelled)
+{
+    mpv_handle *mpv = mpv_create();
+    if (!mpv) return false;
+
+    // 画面にも音にも出さず、ソフトウェア描画 API にだけフレームを渡す
+    mpv_set_option_string(mpv, "vo", "libmpv");
+    mpv_set_option_string(mpv, "audio", "no");
+    mpv_set_option_string(mpv, "sub", "no");
+    mpv_set_option_string(mpv, "pause", "yes");
+    mpv_set_option_string(mpv, "hr-seek", "yes");
+    mpv_set_option_string(mpv, "hwdec", "no");
+    mpv_set_option_string(mpv, "vd-lavc-skiploopfilter", "all"); // 縮小表示なので画質より速度
+    mpv_set_option_string(mpv, "config", "no");
+    mpv_set_option_string(mpv, "load-scripts", "no");
+    mpv_set_option_string(mpv, "terminal", "no");
+    if (mpv_initialize(mpv) < 0) {
+        mpv_terminate_destroy(mpv);
+        return false;
+    }
+
+    mpv_render_param createParams[] = {
+        { MPV_RENDER_PARAM_API_TYPE, const_cast<char *>(MPV_RENDER_API_TYPE_SW) },
+        { MPV_RENDER_PARAM_INVALID, nullptr },
+    };
+    mpv_render_context *render = nullptr;
+    if (mpv_render_context_create(&render, mpv, createParams) < 0) {
+        qDebug() << "VideoThumbnailer: failed to create render context";
+        mpv_terminate_destroy(mpv);
+        return false;
+    }
+    QSemaphore updates;
+    mpv_render_context_set_update_callback(render, onRenderUpdate, &updates);
+
+    bool ok = false;
+    const QByteArray path = filePath.toUtf8();
+    const char *loadArgs[] = { "loadfile", path.constData(), nullptr };
+    if (mpv_command(mpv, loadArgs) >= 0 && waitForEvent(mpv, MPV_EVENT_FILE_LOADED, LOAD_TIMEOUT_MS)
+        && waitForEvent(mpv, MPV_EVENT_PLAYBACK_RESTART, LOAD_TIMEOUT_MS)) {
+        double duration = 0;
+        qint64 width = 0, height = 0;
+        mpv_get_property(mpv, "duration", MPV_FORMAT_DOUBLE, &duration);
+        mpv_get_property(mpv, "dwidth", MPV_FORMAT_INT64, &width);
+        mpv_get_property(mpv, "dheight", MPV_FORMAT_INT64, &height);
+
+        if (duration > 0 && width > 0 && height > 0) {
+            // 表紙はプレビューの大きさで取り、ストアが自分のスロットの大きさへ縮める
+            const int edge = withPreviews ? previewStore->slotEdge() : coverStore->slotEdge();
+            const QSize size = QSize(int(width), int(height)).scaled(edge, edge, Qt::KeepAspectRatio).expandedTo(QSize(1, 1));
+
+            // -1: 表紙、0..: 等間隔のプレビュー (各区間の中央)
+            const int frameCount = withPreviews ? PREVIEW_FRAMES : 0;
+            ok = true;
+            for (int index = -1; index < frameCount && ok; ++index) {
+                if (cancelled->loadRelaxed()) {
+                    ok = false;
+                    break;
+                }
+                const double seconds = index < 0 ? duration * COVER_POSITION : duration * (index + 0.5) / PREVIEW_FRAMES;
+                const QByteArray target = QByteArray::number(seconds, 'f', 3);
+                const char *seekArgs[] = { "seek", target.constData(), "absolute+exact", nullptr };
+
+                // 前のフレームの通知を捨ててからシークする
+                mpv_render_context_update(render);
+                updates.tryAcquire(updates.available());
+                if (mpv_command(mpv, seekArgs) < 0 || !waitForEvent(mpv, MPV_EVENT_PLAYBACK_RESTART, FRAME_TIMEOUT_MS)) {
+                    ok = false;
+                    break;
+                }
+
+                const QImage frame = renderFrame(render, &updates, size, FRAME_TIMEOUT_MS);
+                if (frame.isNull()) {
+                    ok = false;
+                    break;
+                }
+                if (index < 0) coverStore->insert(filePath, key.lastModified, key.size, frame);
+                else previewStore->insert(framePath(filePath, index), key.lastModified, key.size, frame);
+            }
+        }
+    }
+    if (!ok && !cancelled->loadRelaxed()) qDebug() << "VideoThumbnailer: failed to extract frames" << filePath;
+
+    // 描画コンテキストはハンドルより先に解放する
+    mpv_render_context_free(render);
+    mpv_terminate_destroy(mpv);
+    return ok;
+}
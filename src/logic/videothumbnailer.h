@@ -0,0 +1,81 @@
+#ifndef VIDEOTHUMBNAILER_H
+#define VIDEOTHUMBNAILER_H
+
+#include <QAtomicInt>
+#include <QCache>
+#include <QDateTime>
+#include <QFuture>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+#include <QThreadPool>
+
+#include "thumbnailstore.h"
+
+// 動画のサムネイル (表紙 + シークプレビュー用のフレーム) を作る
+// - libmpv のソフトウェア描画 API で、ウィンドウも GPU も使わずにフレームを取り出す
+// - 表紙は動画のパスをキーに本棚と同じサムネイルストアへ、プレビューは "パス#番号" をキーに
+//   スロットの大きいプレビュー用のストアへ保存する (再起動後も有効)
+// - 生成は同時実行数を絞った専用のスレッドプールで行う (再生中の動画のプレビューを一覧の表紙より先に)
+class VideoThumbnailer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit VideoThumbnailer(QObject *parent = nullptr);
+    ~VideoThumbnailer();
+
+    // 表紙とプレビューを作る (作成済み / 作成中なら何もしない)
+    void request(const QString &filePath);
+    // 表紙だけを作る (一覧に表示された動画用。作成済み / 作成中 / 失敗済みなら何もしない)
+    void requestCover(const QString &filePath);
+
+    // ストアから引くだけ (デコードしない)。なければ null
+    QImage cover(const QString &filePath);
+    QImage previewAt(const QString &filePath, qint64 positionMs, qint64 durationMs);
+
+    static bool isVideoFile(const QString &filePath);
+
+    static const int PREVIEW_FRAMES = 40; // 動画全体を等間隔に分けたプレビューの枚数
+    static const int PREVIEW_EDGE = 192;  // プレビューの1辺の最大ピクセル数 (シークバーの上に出す大きさ)
+
+signals:
+    void thumbnailsReady(const QString &filePath);
+
+private:
+    struct FileKey {
+        QDateTime lastModified;
+        qint64 size = 0;
+    };
+    FileKey fileKey(const QString &filePath);
+    static QString framePath(const QString &filePath, int index);
+    void watchJob(const QFuture<bool> &future, const QString &filePath, bool coverOnly);
+    void forgetLookups(const QString &filePath);
+    static bool generate(const QString &filePath, const FileKey &key, ThumbnailStore *coverStore,
+                         ThumbnailStore *previewStore, bool withPreviews, const QAtomicInt *cancelled);
+
+    QThreadPool m_pool;
+    QSharedPointer<ThumbnailStore> m_store;        // 表紙 (本棚と同じストア)
+    QSharedPointer<ThumbnailStore> m_previewStore; // プレビュー (PREVIEW_EDGE のスロット)
+    QSharedPointer<QAtomicInt> m_cancelled; // 破棄時に立て、実行中のジョブを途中で止める
+    QSet<QString> m_pending;        // 表紙 + プレビュー
+    QSet<QString> m_pendingCovers;  // 表紙だけ
+    QSet<QString> m_failedCovers;   // 取り出せなかった動画 (一覧の描画のたびに作り直さない)
+    QHash<QString, FileKey> m_fileKeys; // ホバーのたびにファイル情報を読まないよう覚えておく
+    // ★ 一覧の描画やシークバーのホバーのたびにストアを引かないよう、見つからなかったことも含めて覚えておく
+    //    (null の QImage = ストアにない。作り終えたら forgetLookups で捨てる)
+    QCache<QString, QImage> m_covers;   // パス -> 表紙
+    QCache<QString, QImage> m_previews; // "パス#番号" -> プレビュー (コスト = バイト数)
+
+    static const int MAX_JOBS = 2;
+    static const int PREVIEW_RECORDS_PER_PACK = 20 * PREVIEW_FRAMES; // 1フォルダあたり動画20本ぶん
+    static const int COVER_CACHE_SIZE = 256;
+    static const int PREVIEW_CACHE_BYTES = 16 * 1024 * 1024;
+    static const int LOAD_TIMEOUT_MS = 5000;
+    static const int FRAME_TIMEOUT_MS = 2000;
+};
+
+#endif // VIDEOTHUMBNAILER_H
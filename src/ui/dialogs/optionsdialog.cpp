@@ -28,6 +28,11 @@ OptionsDialog::OptionsDialog(const AppSettings &currentSettings, QWidget *parent
     ui->scanSubdirectoriesCheckBox->setChecked(currentSettings.scanSubdirectories);
     ui->fileScanLimitSpinBox->setValue(currentSettings.fileScanLimit);
     ui->autoUpdatePreviewsCheckBox->setChecked(currentSettings.autoUpdatePreviews);
+    ui->continueToSiblingFolderCheckBox->setChecked(currentSettings.continueToSiblingFolder);
+    ui->autoScrollSpeedSpinBox->setValue(currentSettings.panoramaAutoScrollSpeed);
+    ui->audioNativeRateCheckBox->setChecked(currentSettings.audioNativeRate);
+    ui->audioLowLatencyCheckBox->setChecked(currentSettings.audioLowLatency);
+    ui->normalizeLoudnessCheckBox->setChecked(currentSettings.normalizeLoudness);
     ui->contextMenuCheckBox->setChecked(currentSettings.contextMenuEnabled);
     ui->comboSwitchOpenFile->addItem("自動 (推奨)", QVariant::fromValue(VideoSwitchPolicy::Default));
     ui->comboSwitchOpenFile->addItem("常に切り替える", QVariant::fromValue(VideoSwitchPolicy::Always));
@@ -74,6 +79,11 @@ AppSettings OptionsDialog::getSettings() const
     newSettings.scanSubdirectories = ui->scanSubdirectoriesCheckBox->isChecked();
     newSettings.fileScanLimit = ui->fileScanLimitSpinBox->value();
     newSettings.autoUpdatePreviews = ui->autoUpdatePreviewsCheckBox->isChecked();
+    newSettings.continueToSiblingFolder = ui->continueToSiblingFolderCheckBox->isChecked();
+    newSettings.panoramaAutoScrollSpeed = ui->autoScrollSpeedSpinBox->value();
+    newSettings.audioNativeRate = ui->audioNativeRateCheckBox->isChecked();
+    newSettings.audioLowLatency = ui->audioLowLatencyCheckBox->isChecked();
+    newSettings.normalizeLoudness = ui->normalizeLoudnessCheckBox->isChecked();
     newSettings.theme = ui->themeComboBox->currentData().toString();
     newSettings.contextMenuEnabled = ui->contextMenuCheckBox->isChecked();
     newSettings.switchOnOpenFile = static_cast<VideoSwitchPolicy>(ui->comboSwitchOpenFile->currentData().toInt());
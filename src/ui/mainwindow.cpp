@@ -11,6 +11,7 @@
 
 #include "aboutdialog.h"
 #include "bookshelfwidget.h"
+#include "directorysnapshotcache.h"
 #include "filescanner.h"
 #include "foldertreewidget.h"
 #include "musicplaylistwidget.h"
@@ -19,6 +20,8 @@
 #include "ui_mainwindow.h"
 #include "optionsdialog.h"
 #include "mediamanager.h"
+#include "videothumbnailer.h"
+#include "metadataindex.h"
 #include "playlistmanager.h"
 #include "imageviewcontroller.h"
 #include "mediaitemdelegate.h"
@@ -65,6 +68,7 @@
 #include <QToolButton>
 #include <QWheelEvent>
 #include <QWindow>
+#include <cmath>
 
 #if defined(Q_OS_WIN)
 #include <shlobj.h>
@@ -159,10 +163,16 @@ void MainWindow::setupManagers()
     // --- 再生エンジン ---
     WId wid = ui->videoContainer->winId();
     m_mediaManager = new MediaManager(wid, this);
+    m_videoThumbnailer = new VideoThumbnailer(this);
+    m_metadataIndex = new MetadataIndex(this);
 
     // --- ファイルスキャン管理 ---
     m_fileScanner = new FileScanner(this);
 
+    // --- ディレクトリ一覧キャッシュ (本棚とビューワーで共有) ---
+    m_directoryCache = new DirectorySnapshotCache(this);
+    m_imageViewController->setDirectoryCache(m_directoryCache);
+
     // --- テーマ管理 ---
     m_themeManager = new ThemeManager(this);
     m_themeManager->loadAllIcons();
@@ -272,6 +282,7 @@ void MainWindow::setupUiComponents()
         "tiff", "wbmp", "webp", "xbm", "xpm"
     };
     m_imageViewController->setImageExtensions(m_imageExtensions);
+    m_directoryCache->setImageExtensions(m_imageExtensions);
     m_playlistExtensions << "qpl" << "qsl";
     m_allMediaExtensions = m_audioExtensions + m_videoExtensions + m_imageExtensions + m_playlistExtensions;
 
@@ -301,6 +312,15 @@ void MainWindow::setupUiComponents()
     // 1. MusicPlaylistWidgetを作成 (PlaylistManagerを渡す)
     m_musicPlaylistWidget = new MusicPlaylistWidget(m_playlistManager, this);
 
+    // ★ 動画の行には表紙を描く (描画された行だけが表紙を要求する)
+    m_musicPlaylistWidget->setThumbnailLookup([this](const QString &filePath) {
+        if (!VideoThumbnailer::isVideoFile(filePath)) return QImage();
+        const QImage cover = m_videoThumbnailer->cover(filePath);
+        if (cover.isNull()) m_videoThumbnailer->requestCover(filePath);
+        return cover;
+    });
+    connect(m_videoThumbnailer, &VideoThumbnailer::thumbnailsReady, m_musicPlaylistWidget, &MusicPlaylistWidget::refreshThumbnails);
+
     // 2. スプリッター(splitter_2)の先頭に追加
     ui->splitter_2->insertWidget(0, m_musicPlaylistWidget);
 
@@ -397,6 +417,9 @@ void MainWindow::setupUiComponents()
     // 2. 新しい BookshelfWidget を作成
     m_bookshelfWidget = new BookshelfWidget(this);
     m_bookshelfWidget->setImageExtensions(m_imageExtensions);
+    m_bookshelfWidget->setVideoExtensions(m_videoExtensions);
+    m_bookshelfWidget->setVideoThumbnailer(m_videoThumbnailer);
+    m_bookshelfWidget->setDirectoryCache(m_directoryCache);
 
     // 3. BookshelfWidget をレイアウトの先頭に追加
     ui->verticalLayout_2->insertWidget(0, m_bookshelfWidget);
@@ -777,6 +800,13 @@ void MainWindow::setupConnections()
     connect(compactControlBar, &ControlBar::volumeChanged, m_mediaManager, &MediaManager::setVolume);
     connect(compactControlBar, &ControlBar::playlistButtonClicked, this, &MainWindow::startPlaybackOnPlaylist);
 
+    // シークバーのホバープレビュー (再生中の動画のフレームをストアから引く)
+    auto seekPreviewLookup = [this](int position, int duration) {
+        return m_videoThumbnailer->previewAt(m_currentVideoPath, position, duration);
+    };
+    m_controlBar->setSeekPreviewLookup(seekPreviewLookup);
+    compactControlBar->setSeekPreviewLookup(seekPreviewLookup);
+
     connect(m_compactWindow, &CompactWindow::switchToFullModeRequested, this, &MainWindow::switchToFullMode);
     connect(m_compactWindow, &CompactWindow::closed, this, &MainWindow::switchToFullMode);
 
@@ -796,12 +826,33 @@ void MainWindow::setupConnections()
     connect(m_mediaManager, &MediaManager::positionChanged, compactControlBar, &ControlBar::setProgressPosition);
     connect(m_mediaManager, &MediaManager::durationChanged, compactControlBar, &ControlBar::setProgressDuration);
     connect(m_mediaManager, &MediaManager::timeLabelChanged, compactControlBar, &ControlBar::setTimeLabel);
+    connect(m_mediaManager, &MediaManager::audioOutputChanged, m_controlBar, &ControlBar::setAudioOutputInfo);
+    connect(m_mediaManager, &MediaManager::audioOutputChanged, compactControlBar, &ControlBar::setAudioOutputInfo);
 
     // PlaylistManager
     connect(m_playlistManager, &PlaylistManager::trackReadyToPlay, this, &MainWindow::onTrackReadyToPlay);
     connect(m_playlistManager, &PlaylistManager::playbackShouldStop, this, &MainWindow::onPlaybackShouldStop);
     connect(m_playlistManager, &PlaylistManager::playlistDataChanged, this, &MainWindow::onPlaylistDataChanged);
     connect(m_playlistManager, &PlaylistManager::loadingStateChanged, this, &MainWindow::onMediaLoadingStateChanged);
+    connect(m_playlistManager, &PlaylistManager::upcomingTrackChanged, m_mediaManager, &MediaManager::preloadNextTrack);
+    m_mediaManager->setUpcomingTrackLookup([this]() { return m_playlistManager->upcomingTrack(); });
+
+    // MetadataIndex (届いた情報はまとめて行と合計時間に反映する)
+    connect(m_metadataIndex, &MetadataIndex::metadataReady, this, [this](const QStringList &filePaths) {
+        for (const QString &filePath : filePaths) m_pendingMetadataPaths.insert(filePath);
+        if (m_metadataRefreshScheduled) return;
+        m_metadataRefreshScheduled = true;
+        QTimer::singleShot(METADATA_REFRESH_DELAY_MS, this, &MainWindow::refreshPlaylistMetadata);
+    });
+    // ★ 曲ごとのラウドネス補正 (記録がなければ補正しない)
+    m_mediaManager->setTrackGainLookup([this](const QString &filePath) {
+        MetadataIndex::Metadata metadata;
+        if (!m_settingsManager->settings().normalizeLoudness || !m_metadataIndex->lookup(filePath, &metadata)
+            || !metadata.hasGain) {
+            return 1.0f;
+        }
+        return std::pow(10.0f, metadata.gainDb / 20.0f);
+    });
 
     // ImageViewController
     connect(m_imageViewController, &ImageViewController::mediaViewStatesChanged, this, &MainWindow::onMediaViewStatesChanged);
@@ -1260,6 +1311,9 @@ void MainWindow::performInitialUiUpdate()
 
     // 1. ビュー状態の復元
     m_imageViewController->setViewStates(s.isPanoramaMode, s.fitMode, s.layoutDirection);
+    m_imageViewController->setContinueToSiblingDirectory(s.continueToSiblingFolder);
+    m_imageViewController->setAutoScrollSpeed(s.panoramaAutoScrollSpeed);
+    m_mediaManager->setAudioOutputOptions(s.audioNativeRate, s.audioLowLatency);
 
     updateMediaViewStates();
     updateControlBarStates();
@@ -1311,6 +1365,7 @@ void MainWindow::onTrackReadyToPlay(const QString& filePath, int playlistIndex,
     addFileToRecentList(filePath);
     QFileInfo fileInfo(filePath);
     m_currentTrackTitle = fileInfo.fileName();
+    m_currentVideoPath.clear();
 
     QString suffix = fileInfo.suffix().toLower();
     bool shouldSwitchPage = false;
@@ -1320,6 +1375,10 @@ void MainWindow::onTrackReadyToPlay(const QString& filePath, int playlistIndex,
         qDebug() << "  Type: Video Detected";
         ui->videoFilePathLineEdit->setText(filePath);
 
+        // ★ 表紙とシークプレビューをバックグラウンドで作る (作成済みならストアから引くだけ)
+        m_currentVideoPath = filePath;
+        m_videoThumbnailer->request(filePath);
+
         // ★ 設定に基づいた切り替え判定ロジック
         VideoSwitchPolicy policy = VideoSwitchPolicy::Default;
         const AppSettings& settings = m_settingsManager->settings();
@@ -1454,6 +1513,7 @@ void MainWindow::stopMusic()
     m_mediaManager->stop();
     m_playlistManager->stopPlayback();
     m_currentTrackTitle.clear();
+    m_currentVideoPath.clear();
 
     // ★追加: 動画パスの表示をクリア
     ui->videoFilePathLineEdit->clear();
@@ -1892,12 +1952,15 @@ void MainWindow::onPlaylistDataChanged(int playlistIndex)
 
     listWidget->clear(); // UIをクリア
 
-    // アイテム再追加
+    // アイテム再追加 (調べ済みならタグと長さも表示)
     for (const QString& filePath : files) {
-        QListWidgetItem* item = new QListWidgetItem(QFileInfo(filePath).fileName());
+        QListWidgetItem* item = new QListWidgetItem();
         item->setToolTip(filePath); // ToolTipはフルパス
+        applyMetadataToItem(item, filePath);
         listWidget->addItem(item);
     }
+    // ★ 未確認のファイルはバックグラウンドで調べる (届いたら refreshPlaylistMetadata で反映)
+    m_metadataIndex->request(files);
 
     qDebug() << "  Item Count After Refill:" << listWidget->count();
     if (listWidget->count() > 0) {
@@ -2408,19 +2471,35 @@ void MainWindow::updatePlaylistButtonStates()
         bool isEmpty = (itemCount == 0);
         bool isPlayingThisPlaylist = (m_playingPlaylistIndex == i);
 
+        // 合計時間 (調べ終わっていない曲があれば "以上" を付ける)
+        qint64 totalMs = 0;
+        bool isTotalPartial = false;
+        for (int row = 0; row < itemCount; ++row) {
+            const qint64 durationMs = list->item(row)->data(MediaItemDelegate::DurationRole).toLongLong();
+            if (durationMs > 0) totalMs += durationMs;
+            else isTotalPartial = true;
+        }
+        QString totalText;
+        if (totalMs > 0) {
+            const qint64 seconds = totalMs / 1000;
+            totalText = QString(" (合計 %1:%2:%3%4)")
+                            .arg(seconds / 3600).arg((seconds / 60) % 60, 2, 10, QChar('0')).arg(seconds % 60, 2, 10, QChar('0'))
+                            .arg(isTotalPartial ? " 以上" : "");
+        }
+
         // ツールチップのテキスト生成
         QString tooltip;
         if (isPlayingThisPlaylist) {
             // 再生中: "再生中: 3 / 10" のような形式
             // 現在の行を取得。もし選択行がなければ0とするが、再生中なら通常はあるはず
             int currentIndex = list->currentRow() + 1;
-            tooltip = QString("再生中: %1 / %2").arg(currentIndex).arg(itemCount);
+            tooltip = QString("再生中: %1 / %2").arg(currentIndex).arg(itemCount) + totalText;
         } else {
             // 非再生中: "10曲" または "空"
             if (isEmpty) {
                 tooltip = "空のプレイリスト";
             } else {
-                tooltip = QString("待機中: %1曲").arg(itemCount);
+                tooltip = QString("待機中: %1曲").arg(itemCount) + totalText;
             }
         }
 
@@ -2434,6 +2513,36 @@ void MainWindow::updatePlaylistButtonStates()
     }
 }
 
+void MainWindow::applyMetadataToItem(QListWidgetItem* item, const QString& filePath)
+{
+    MetadataIndex::Metadata metadata;
+    if (m_metadataIndex->lookup(filePath, &metadata)) {
+        item->setText(MetadataIndex::displayName(filePath, metadata));
+        item->setData(MediaItemDelegate::DurationRole, metadata.durationMs);
+    } else {
+        item->setText(QFileInfo(filePath).fileName());
+    }
+}
+
+void MainWindow::refreshPlaylistMetadata()
+{
+    m_metadataRefreshScheduled = false;
+    if (m_pendingMetadataPaths.isEmpty()) return;
+
+    // ToolTip にフルパスを持たせているので、それで該当行を探す
+    for (int i = 0; i < m_musicPlaylistWidget->count(); ++i) {
+        QListWidget* list = m_musicPlaylistWidget->listWidget(i);
+        if (!list) continue;
+        for (int row = 0; row < list->count(); ++row) {
+            QListWidgetItem* item = list->item(row);
+            const QString filePath = item->toolTip();
+            if (m_pendingMetadataPaths.contains(filePath)) applyMetadataToItem(item, filePath);
+        }
+    }
+    m_pendingMetadataPaths.clear();
+    updatePlaylistButtonStates(); // 合計時間
+}
+
 void MainWindow::updatePreviews()
 {
     // まず、全てのプレビューグループを非表示にする
@@ -2736,6 +2845,9 @@ void MainWindow::applySettings(const AppSettings& newSettings)
     m_settingsManager->settings() = newSettings;
 
     updateDockWidgetBehavior();
+    m_imageViewController->setContinueToSiblingDirectory(newSettings.continueToSiblingFolder);
+    m_imageViewController->setAutoScrollSpeed(newSettings.panoramaAutoScrollSpeed);
+    m_mediaManager->setAudioOutputOptions(newSettings.audioNativeRate, newSettings.audioLowLatency);
     if (m_settingsManager->settings().syncUiStateAcrossLists && !oldSyncState) {
         syncAllListsUiState(m_playlistOptions->value(), m_playlistOptions->isChecked());
     }
@@ -31,6 +31,7 @@
 #include <QPropertyAnimation>
 #include <QPushButton>
 #include <QResizeEvent>
+#include <QSet>
 #include <QStringList>
 #include <QToolButton>
 
@@ -40,6 +41,8 @@ class QButtonGroup;
 class QLabel;
 class QShortcut;
 class MediaManager;
+class VideoThumbnailer;
+class MetadataIndex;
 class PlaylistManager;
 class ThemeManager;
 class SettingsManager;
@@ -48,6 +51,7 @@ class FolderTreeWidget;
 class ViewUpdateGuard;
 class BookshelfWidget;
 class FileScanner;
+class DirectorySnapshotCache;
 class MusicPlaylistWidget;
 namespace Ui { class MainWindow; }
 class ListOptionsWidget;
@@ -193,6 +197,8 @@ private:
     void updateDockWidgetBehavior();
     void updateMediaViewStates();
     void updatePlaylistButtonStates();
+    void applyMetadataToItem(QListWidgetItem* item, const QString& filePath);
+    void refreshPlaylistMetadata();
     void updateSlideshowPlayPauseButton();
     void updateTitleBarStyle();
 
@@ -224,6 +230,8 @@ private:
     ControlBar* m_controlBar;
     CompactWindow* m_compactWindow;
     MediaManager* m_mediaManager;
+    VideoThumbnailer* m_videoThumbnailer;
+    MetadataIndex* m_metadataIndex;
     PlaylistManager* m_playlistManager;
     ThemeManager *m_themeManager;
     ImageViewController* m_imageViewController;
@@ -231,6 +239,7 @@ private:
     BookshelfWidget *m_bookshelfWidget;
     MusicPlaylistWidget *m_musicPlaylistWidget;
     FileScanner *m_fileScanner;
+    DirectorySnapshotCache *m_directoryCache;
     SlideshowWidget *m_slideshowWidget;
     QWidget* m_titleBarWidget = nullptr;
     QToolButton *m_minBtn = nullptr; // メンバ変数に昇格
@@ -251,6 +260,9 @@ private:
     int m_playingPlaylistIndex;
     QListWidgetItem* m_currentlyDisplayedSlideItem = nullptr;
     QString m_currentTrackTitle;
+    QString m_currentVideoPath; // シークプレビューの対象 (動画の再生中だけ)
+    QSet<QString> m_pendingMetadataPaths; // 情報が届いて、行の表示に反映待ちのファイル
+    bool m_metadataRefreshScheduled = false;
 
     // プレビュー関連
     QList<QWidget*> previewGroups;
@@ -328,5 +340,6 @@ private:
     static const int SCROLL_UPDATE_INTERVAL = 40;
     static const int RESIZE_DEBOUNCE_INTERVAL = 80;
     static const int FILE_ADD_CHUNK_SIZE = 50;
+    static const int METADATA_REFRESH_DELAY_MS = 200; // 届いた曲情報をまとめて反映する間隔
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,102 @@
+#include "bookshelfitemdelegate.h"
+#include "bookshelfmodel.h"
+#include <QApplication>
+#include <QPainter>
+#include <QStyle>
+
+BookshelfItemDelegate::BookshelfItemDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+    , m_fontSize(10)
+    , m_thumbnailsVisible(true)
+    , m_syncDateFont(true)
+{
+}
+
+QFont BookshelfItemDelegate::nameFont(const QFont &base) const
+{
+    QFont f = base;
+    f.setBold(true);
+    f.setPointSize(m_fontSize);
+    return f;
+}
+
+QFont BookshelfItemDelegate::dateFont(const QFont &base) const
+{
+    QFont f = base;
+    if (m_syncDateFont) {
+        f.setPointSize(qMax(8, m_fontSize - 2));
+    }
+    return f;
+}
+
+QSize BookshelfItemDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    Q_UNUSED(index);
+    // ★ 全行同じ高さ (uniformItemSizes 前提)。フォントとサムネイル表示の有無だけで決まる
+    const int textHeight = QFontMetrics(nameFont(option.font)).height() + QFontMetrics(dateFont(option.font)).height();
+    const int contentHeight = m_thumbnailsVisible ? qMax(ICON_SIZE, textHeight) : textHeight;
+    return QSize(option.rect.width() > 0 ? option.rect.width() : 200, contentHeight + MARGIN * 2);
+}
+
+void BookshelfItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+
+    painter->save();
+
+    // 1. 背景 (選択・ホバー) はスタイルに任せる
+    opt.text.clear();
+    opt.icon = QIcon();
+    QStyle *style = opt.widget ? opt.widget->style() : QApplication::style();
+    style->drawPrimitive(QStyle::PE_PanelItemViewItem, &opt, painter, opt.widget);
+
+    QRect content = opt.rect.adjusted(MARGIN, MARGIN, -MARGIN, -MARGIN);
+
+    // 2. アイコン / サムネイル
+    if (m_thumbnailsVisible) {
+        const QRect iconRect(content.left(), content.top() + (content.height() - ICON_SIZE) / 2, ICON_SIZE, ICON_SIZE);
+        const QVariant decoration = index.data(Qt::DecorationRole);
+        QPixmap pixmap;
+        if (decoration.typeId() == QMetaType::QPixmap) {
+            pixmap = decoration.value<QPixmap>();
+        } else {
+            pixmap = decoration.value<QIcon>().pixmap(iconRect.size());
+        }
+        if (!pixmap.isNull()) {
+            const QSize drawSize = pixmap.size().scaled(iconRect.size(), Qt::KeepAspectRatio);
+            const QRect target(iconRect.left() + (iconRect.width() - drawSize.width()) / 2,
+                               iconRect.top() + (iconRect.height() - drawSize.height()) / 2,
+                               drawSize.width(), drawSize.height());
+            painter->setRenderHint(QPainter::SmoothPixmapTransform);
+            painter->drawPixmap(target, pixmap);
+        }
+        content.setLeft(iconRect.right() + 1 + MARGIN);
+    }
+
+    // 3. 名前と更新日時
+    const QColor textColor = (opt.state & QStyle::State_Selected)
+                                 ? opt.palette.highlightedText().color()
+                                 : opt.palette.text().color();
+    painter->setPen(textColor);
+
+    const QFont nFont = nameFont(opt.font);
+    const QFont dFont = dateFont(opt.font);
+    const int nameHeight = QFontMetrics(nFont).height();
+    const int dateHeight = QFontMetrics(dFont).height();
+    const int top = content.top() + (content.height() - nameHeight - dateHeight) / 2;
+
+    painter->setFont(nFont);
+    const QRect nameRect(content.left(), top, content.width(), nameHeight);
+    painter->drawText(nameRect, Qt::AlignLeft | Qt::AlignVCenter,
+                      QFontMetrics(nFont).elidedText(index.data(Qt::DisplayRole).toString(), Qt::ElideRight, nameRect.width()));
+
+    const QString dateText = index.data(BookshelfModel::DateTextRole).toString();
+    if (!dateText.isEmpty()) {
+        painter->setFont(dFont);
+        painter->drawText(QRect(content.left(), top + nameHeight, content.width(), dateHeight),
+                          Qt::AlignLeft | Qt::AlignVCenter, dateText);
+    }
+
+    painter->restore();
+}
@@ -0,0 +1,34 @@
+#ifndef BOOKSHELFITEMDELEGATE_H
+#define BOOKSHELFITEMDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+// 本棚の1行 (アイコン + 名前 + 更新日時) を直接描画するデリゲート
+// 表示オプションの変更は再描画だけで反映される
+class BookshelfItemDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    explicit BookshelfItemDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+    void setFontSize(int size) { m_fontSize = size; }
+    void setThumbnailsVisible(bool visible) { m_thumbnailsVisible = visible; }
+    void setSyncDateFont(bool sync) { m_syncDateFont = sync; }
+
+    static const int ICON_SIZE = 64;
+
+private:
+    QFont nameFont(const QFont &base) const;
+    QFont dateFont(const QFont &base) const;
+
+    int m_fontSize;
+    bool m_thumbnailsVisible;
+    bool m_syncDateFont;
+
+    static const int MARGIN = 5;
+};
+
+#endif // BOOKSHELFITEMDELEGATE_H
@@ -0,0 +1,144 @@
+#include "bookshelfmodel.h"
+
+BookshelfModel::BookshelfModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_thumbnailsEnabled(true)
+{
+    m_thumbnails.setMaxCost(THUMBNAIL_CACHE_BYTES);
+}
+
+int BookshelfModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_entries.size();
+}
+
+QVariant BookshelfModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_entries.size()) return QVariant();
+
+    const Entry &entry = m_entries.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        return entry.name;
+    case Qt::ToolTipRole:
+        return entry.path;
+    case PathRole:
+        return entry.path;
+    case IsImageRole:
+        return entry.isImage;
+    case IsParentRole:
+        return entry.isParent;
+    case DateTextRole:
+        return entry.isParent ? QString() : entry.lastModified.toString("yyyy/MM/dd hh:mm");
+    case Qt::DecorationRole: {
+        if (entry.isParent) return m_parentIcon;
+
+        if (const QPixmap *cached = m_thumbnails.object(entry.path)) return *cached;
+
+        // ★ 描画されて初めてサムネイルを要求する (画面外の行は何もしない)
+        if (m_thumbnailsEnabled && !m_requestedThumbnails.contains(entry.path)) {
+            // 保存済みのサムネイルがあれば最初の描画から使う
+            if (m_thumbnailLookup) {
+                const QPixmap stored = m_thumbnailLookup(entry);
+                if (!stored.isNull()) {
+                    cacheThumbnail(entry.path, stored);
+                    return stored;
+                }
+            }
+            m_requestedThumbnails.insert(entry.path);
+            emit thumbnailRequested(entry.path, entry.isImage);
+        }
+        return entry.isImage ? m_imageIcon : m_folderIcon;
+    }
+    default:
+        return QVariant();
+    }
+}
+
+void BookshelfModel::setEntries(const QList<Entry> &entries)
+{
+    beginResetModel();
+    m_entries = entries;
+    m_thumbnails.clear();
+    m_requestedThumbnails.clear();
+    rebuildRowIndex();
+    endResetModel();
+}
+
+void BookshelfModel::insertEntry(int row, const Entry &entry)
+{
+    row = qBound(0, row, m_entries.size());
+    beginInsertRows(QModelIndex(), row, row);
+    m_entries.insert(row, entry);
+    reindexRowsFrom(row);
+    endInsertRows();
+}
+
+void BookshelfModel::removeEntryAt(int row)
+{
+    if (row < 0 || row >= m_entries.size()) return;
+    beginRemoveRows(QModelIndex(), row, row);
+    const QString path = m_entries.at(row).path;
+    m_entries.removeAt(row);
+    m_thumbnails.remove(path);
+    m_requestedThumbnails.remove(path);
+    if (m_rowByPath.value(path, -1) == row) m_rowByPath.remove(path);
+    reindexRowsFrom(row);
+    endRemoveRows();
+}
+
+int BookshelfModel::rowForPath(const QString &path) const
+{
+    return m_rowByPath.value(path, -1);
+}
+
+void BookshelfModel::rebuildRowIndex()
+{
+    m_rowByPath.clear();
+    m_rowByPath.reserve(m_entries.size());
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (!m_entries.at(i).isParent) m_rowByPath.insert(m_entries.at(i).path, i);
+    }
+}
+
+void BookshelfModel::reindexRowsFrom(int row)
+{
+    // 前の行はずれないので、ハッシュ全体は作り直さない
+    for (int i = row; i < m_entries.size(); ++i) {
+        if (!m_entries.at(i).isParent) m_rowByPath.insert(m_entries.at(i).path, i);
+    }
+}
+
+void BookshelfModel::cacheThumbnail(const QString &path, const QPixmap &pixmap) const
+{
+    const qsizetype cost = qMax<qsizetype>(1, qsizetype(pixmap.width()) * pixmap.height() * pixmap.depth() / 8);
+    m_thumbnails.insert(path, new QPixmap(pixmap), cost);
+}
+
+void BookshelfModel::setDefaultIcons(const QIcon &parentIcon, const QIcon &folderIcon, const QIcon &imageIcon)
+{
+    m_parentIcon = parentIcon;
+    m_folderIcon = folderIcon;
+    m_imageIcon = imageIcon;
+    if (!m_entries.isEmpty()) {
+        emit dataChanged(index(0), index(m_entries.size() - 1), {Qt::DecorationRole});
+    }
+}
+
+void BookshelfModel::setThumbnail(const QString &path, const QPixmap &pixmap)
+{
+    const int row = rowForPath(path);
+    if (row < 0) return;
+
+    cacheThumbnail(path, pixmap);
+    m_requestedThumbnails.remove(path); // 届いた後に追い出されたら、改めて引けるように
+    const QModelIndex idx = index(row);
+    emit dataChanged(idx, idx, {Qt::DecorationRole});
+}
+
+void BookshelfModel::setThumbnailsEnabled(bool enabled)
+{
+    m_thumbnailsEnabled = enabled;
+    // 再表示時に改めて要求できるようにする
+    if (enabled) m_requestedThumbnails.clear();
+}
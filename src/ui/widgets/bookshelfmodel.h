@@ -0,0 +1,82 @@
+#ifndef BOOKSHELFMODEL_H
+#define BOOKSHELFMODEL_H
+
+#include <QAbstractListModel>
+#include <QCache>
+#include <QDateTime>
+#include <QHash>
+#include <QIcon>
+#include <QPixmap>
+#include <QSet>
+#include <functional>
+
+// 本棚の一覧モデル
+// 行ごとの QWidget を作らず、表示に必要なデータだけを保持する (描画は BookshelfItemDelegate)
+class BookshelfModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    // 既存の QListWidget 版と同じロールを使う (UserRole = パス, UserRole + 1 = 画像ファイルか)
+    enum Roles {
+        PathRole = Qt::UserRole,
+        IsImageRole = Qt::UserRole + 1,
+        DateTextRole = Qt::UserRole + 2,
+        IsParentRole = Qt::UserRole + 3
+    };
+
+    struct Entry {
+        QString name;
+        QString path;
+        QDateTime lastModified;
+        qint64 size = 0;
+        bool isImage = false;
+        bool isParent = false; // ".."
+    };
+
+    explicit BookshelfModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    // 一覧の差し替え / 差分更新
+    void setEntries(const QList<Entry> &entries);
+    void insertEntry(int row, const Entry &entry);
+    void removeEntryAt(int row);
+    const Entry &entryAt(int row) const { return m_entries.at(row); }
+    int rowForPath(const QString &path) const;
+
+    // アイコン・サムネイル
+    void setDefaultIcons(const QIcon &parentIcon, const QIcon &folderIcon, const QIcon &imageIcon);
+    void setThumbnail(const QString &path, const QPixmap &pixmap);
+    bool hasThumbnail(const QString &path) const { return m_thumbnails.contains(path); }
+    void setThumbnailsEnabled(bool enabled);
+    // 描画時に同期で引けるサムネイル (ディスクのストアなど、デコード不要なもの)
+    // 見つからなければ null を返し、thumbnailRequested で非同期読み込みに回る
+    void setThumbnailLookup(const std::function<QPixmap(const Entry &)> &lookup) { m_thumbnailLookup = lookup; }
+
+signals:
+    // 描画時にサムネイルが必要になった行 (表示されている行だけが要求される)
+    void thumbnailRequested(const QString &path, bool isImageFile) const;
+
+private:
+    void rebuildRowIndex();
+    void reindexRowsFrom(int row); // row 以降の行番号を振り直す (挿入・削除でずれた分だけ)
+    void cacheThumbnail(const QString &path, const QPixmap &pixmap) const;
+
+    QList<Entry> m_entries;
+    QHash<QString, int> m_rowByPath;
+    // ★ 表示したサムネイルは上限付きの LRU で持つ (コスト = バイト数)。
+    //    追い出された行は、次の描画でストアから引き直すか読み込み直す
+    mutable QCache<QString, QPixmap> m_thumbnails;
+    std::function<QPixmap(const Entry &)> m_thumbnailLookup;
+    mutable QSet<QString> m_requestedThumbnails;
+    bool m_thumbnailsEnabled;
+
+    QIcon m_parentIcon;
+    QIcon m_folderIcon;
+    QIcon m_imageIcon;
+
+    static const int THUMBNAIL_CACHE_BYTES = 64 * 1024 * 1024;
+};
+
+#endif // BOOKSHELFMODEL_H
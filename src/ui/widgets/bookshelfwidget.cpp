@@ -1,12 +1,20 @@
 #include "bookshelfwidget.h"
+#include "bookshelfitemdelegate.h"
+#include "filesorter.h"
+#include "exifpreview.h"
+#include "videothumbnailer.h"
 #include <QVBoxLayout>
-#include <QLabel>
 #include <QScrollBar>
 #include <QtConcurrent/qtconcurrentrun.h>
+#include <QFutureWatcher>
+#include <QThreadPool>
 #include <QImageReader>
 #include <QFileInfo>
 #include <QDateTime>
 #include <QRandomGenerator>
+#include <QSet>
+#include <QTimer>
+#include <algorithm>
 
 BookshelfWidget::BookshelfWidget(QWidget *parent)
     : QWidget(parent)
@@ -14,34 +22,66 @@ BookshelfWidget::BookshelfWidget(QWidget *parent)
     , m_showImages(false)
     , m_syncDateFont(true)
     , m_currentFontSize(10)
+    , m_runningThumbnailJobs(0)
+    , m_thumbnailDispatchScheduled(false)
+    , m_thumbnailGeneration(new QAtomicInt(0))
+    , m_thumbnailStore(new ThumbnailStore)
+    , m_coverIndex(new CoverIndex)
+    , m_videoThumbnailer(nullptr)
     , m_currentSortMode(SortName) // ★ デフォルトは名前順
     , m_sortAscending(true)
+    , m_directoryCache(nullptr)
 {
     // レイアウトとリストウィジェットの初期化
     QVBoxLayout *layout = new QVBoxLayout(this);
     layout->setContentsMargins(0, 0, 0, 0);
     layout->setSpacing(0);
 
-    m_listWidget = new QListWidget(this);
-    m_listWidget->setDragDropMode(QAbstractItemView::NoDragDrop);
-    layout->addWidget(m_listWidget);
-
-    connect(m_listWidget, &QListWidget::itemDoubleClicked, this, &BookshelfWidget::onItemDoubleClicked);
+    // ★ 行ごとの QWidget は作らず、モデル + 描画デリゲートで表示する (見えている行だけが描画コストを持つ)
+    m_model = new BookshelfModel(this);
+    m_delegate = new BookshelfItemDelegate(this);
+
+    m_listView = new QListView(this);
+    m_listView->setModel(m_model);
+    m_listView->setItemDelegate(m_delegate);
+    m_listView->setUniformItemSizes(true);
+    m_listView->setDragDropMode(QAbstractItemView::NoDragDrop);
+    m_listView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_listView->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    layout->addWidget(m_listView);
+
+    connect(m_listView, &QListView::doubleClicked, this, &BookshelfWidget::onItemDoubleClicked);
+
+    // 描画時に要求されたサムネイルだけを読み込む (描画中に処理しないようキュー接続)
+    connect(m_model, &BookshelfModel::thumbnailRequested, this, &BookshelfWidget::requestThumbnail, Qt::QueuedConnection);
+    // スクロールしたら待ち行列の優先度を付け直す
+    connect(m_listView->verticalScrollBar(), &QScrollBar::valueChanged, this, [this]() {
+        if (!m_thumbnailQueue.isEmpty()) scheduleThumbnailDispatch();
+    });
 
-    // サムネイルキャッシュの設定 (例: 最大100MB)
-    m_thumbnailCache.setMaxCost(1024 * 100);
+    // ★ ディスクに保存済みのサムネイルはデコードせずに描画時にそのまま使う
+    m_model->setThumbnailLookup([this](const BookshelfModel::Entry &entry) {
+        if (entry.isImage) {
+            return QPixmap::fromImage(m_thumbnailStore->find(entry.path, entry.lastModified, entry.size));
+        }
+        // フォルダは表紙の索引から表紙画像を引く (フォルダの中身は読まない)
+        // ★ 表紙は一覧しているディレクトリのパックに入れてある (フォルダごとのパックは開かない)
+        CoverIndex::Cover cover;
+        if (!m_coverIndex->lookup(entry.path, entry.lastModified, m_currentSortMode, m_sortAscending, &cover)
+            || cover.path.isEmpty()) {
+            return QPixmap();
+        }
+        return QPixmap::fromImage(m_thumbnailStore->find(cover.path, cover.lastModified, cover.size, m_currentPath));
+    });
 
-    m_collator.setNumericMode(true);
-    m_collator.setCaseSensitivity(Qt::CaseInsensitive);
+    m_collator = FileSorter::createCollator();
 }
 
 BookshelfWidget::~BookshelfWidget()
 {
-    // 実行中のウォッチャーがあればキャンセル待機などをここで行う
-    for(auto watcher : m_activeWatchers) {
-        if(!watcher->isFinished()) watcher->waitForFinished();
-        delete watcher;
-    }
+    // 実行中のジョブは待たずに中断させる (ストアは共有ポインタでジョブ側も保持している)
+    // ウォッチャーは子オブジェクトとして破棄されるので、完了通知はもう届かない
+    m_thumbnailGeneration->ref();
 }
 
 void BookshelfWidget::navigateToPath(const QString &path)
@@ -61,7 +101,7 @@ void BookshelfWidget::navigateToPath(const QString &path)
 
     // 前のパスのスクロール位置を保存
     if (!m_currentPath.isEmpty()) {
-        m_scrollHistory[m_currentPath] = m_listWidget->verticalScrollBar()->value();
+        m_scrollHistory[m_currentPath] = m_listView->verticalScrollBar()->value();
     }
 
     m_currentPath = dir.absolutePath(); // absolutePath() で正規化しておくのが無難
@@ -73,7 +113,8 @@ void BookshelfWidget::navigateToPath(const QString &path)
 void BookshelfWidget::setIcons(const QMap<QString, QIcon> &icons)
 {
     m_icons = icons;
-    updateView(); // 再描画
+    // 既定アイコンの差し替えは再描画だけで済む
+    m_model->setDefaultIcons(getIcon("arrow_upward"), getIcon("no_image"), getIcon("image"));
 }
 
 void BookshelfWidget::setImageExtensions(const QStringList &extensions)
@@ -81,6 +122,20 @@ void BookshelfWidget::setImageExtensions(const QStringList &extensions)
     m_imageExtensions = extensions;
 }
 
+void BookshelfWidget::setVideoExtensions(const QStringList &extensions)
+{
+    m_videoExtensions = extensions;
+}
+
+void BookshelfWidget::setVideoThumbnailer(VideoThumbnailer *thumbnailer)
+{
+    if (m_videoThumbnailer) disconnect(m_videoThumbnailer, nullptr, this, nullptr);
+    m_videoThumbnailer = thumbnailer;
+    if (m_videoThumbnailer) {
+        connect(m_videoThumbnailer, &VideoThumbnailer::thumbnailsReady, this, &BookshelfWidget::onVideoCoverReady);
+    }
+}
+
 void BookshelfWidget::refresh()
 {
     updateView();
@@ -97,20 +152,23 @@ void BookshelfWidget::setFontSize(int size)
 {
     m_currentFontSize = size;
     // リスト全体のフォント設定
-    QFont f = m_listWidget->font();
+    QFont f = m_listView->font();
     f.setPointSize(size);
-    m_listWidget->setFont(f);
+    m_listView->setFont(f);
 
-    // 各アイテムウィジェットの更新が必要ならここで行う
-    // (簡易的に再描画を呼ぶか、itemsをループして更新する)
-    updateView();
+    // 行の高さが変わるので再レイアウト (一覧の作り直しはしない)
+    m_delegate->setFontSize(size);
+    relayoutRows();
 }
 
 void BookshelfWidget::setThumbnailsVisible(bool visible)
 {
     if (m_thumbnailsVisible == visible) return;
     m_thumbnailsVisible = visible;
-    updateView();
+    m_delegate->setThumbnailsVisible(visible);
+    m_model->setThumbnailsEnabled(visible);
+    if (!visible) cancelThumbnailJobs();
+    relayoutRows();
 }
 
 void BookshelfWidget::setShowImages(bool show)
@@ -133,253 +191,336 @@ void BookshelfWidget::setSortOrder(SortMode mode, bool ascending)
 void BookshelfWidget::setSyncDateFont(bool sync)
 {
     m_syncDateFont = sync;
-    updateView();
+    m_delegate->setSyncDateFont(sync);
+    relayoutRows();
 }
 
-void BookshelfWidget::sortFileInfos(QFileInfoList &list)
+void BookshelfWidget::relayoutRows()
 {
-    if (m_currentSortMode == SortShuffle) {
-        // シャッフル (C++17以降なら std::shuffle も可ですが、Qtでの簡易実装)
-        auto *generator = QRandomGenerator::global();
-        // 単純なランダムスワップ
-        for (int i = 0; i < list.size(); ++i) {
-            int j = generator->bounded(list.size());
-            list.swapItemsAt(i, j);
-        }
-        return; // シャッフルの場合、昇順・降順は無視
-    }
-
-    // std::sort とラムダ式を使ってソート
-    std::sort(list.begin(), list.end(), [this](const QFileInfo &a, const QFileInfo &b) -> bool {
-        bool result = true;
-
-        switch (m_currentSortMode) {
-        case SortName:
-            // QCollatorを使って自然順比較 (1.png < 2.png < 10.png)
-            result = (m_collator.compare(a.fileName(), b.fileName()) < 0);
-            break;
-
-        case SortDate:
-            // 更新日時で比較
-            result = (a.lastModified() < b.lastModified());
-            break;
-
-        case SortSize:
-            // ファイルサイズで比較
-            result = (a.size() < b.size());
-            break;
+    // uniformItemSizes のキャッシュを捨てて、行の高さを計算し直させる (スクロール位置は維持)
+    const int scrollValue = m_listView->verticalScrollBar()->value();
+    m_listView->reset();
+    m_listView->doItemsLayout();
+    m_listView->verticalScrollBar()->setValue(scrollValue);
+    m_listView->viewport()->update();
+}
 
-        default:
-            break;
-        }
+void BookshelfWidget::sortFileInfos(QFileInfoList &list)
+{
+    FileSorter::sort(list, m_currentSortMode, m_sortAscending);
+}
 
-        // 降順なら結果を反転
-        return m_sortAscending ? result : !result;
-    });
+bool BookshelfWidget::lessThan(const QFileInfo &a, const QFileInfo &b) const
+{
+    return FileSorter::lessThan(a, b, m_currentSortMode, m_sortAscending, m_collator);
 }
 
 // --- Private Logic ---
 
 void BookshelfWidget::updateView()
 {
-    m_listWidget->clear();
+    // 一覧を作り直すので、前の一覧のサムネイル要求は捨てる
+    cancelThumbnailJobs();
+
+    QList<BookshelfModel::Entry> entries;
     QDir dir(m_currentPath);
 
     // 1. 親ディレクトリ (..) - ソート対象外で常に先頭
     if (dir.cdUp()) {
-        QWidget* widget = createItemWidget("..", dir.path(), getIcon("arrow_upward"), false);
-        QListWidgetItem* item = new QListWidgetItem(m_listWidget);
-        item->setData(Qt::UserRole, dir.path());
-        item->setData(Qt::UserRole + 1, false);
-        item->setSizeHint(widget->sizeHint());
-        m_listWidget->setItemWidget(item, widget);
+        BookshelfModel::Entry parentEntry;
+        parentEntry.name = "..";
+        parentEntry.path = dir.path();
+        parentEntry.isParent = true;
+        entries << parentEntry;
         dir.cd(m_currentPath);
     }
 
     // ★ 変更: QFileInfoListを取得してソートする方式に変更
+    // ★ 一覧はキャッシュ (監視付き) から取得し、なければ読み込んで登録する
+    const DirectorySnapshotCache::Snapshot snapshot = currentSnapshot();
 
     // 2. サブディレクトリ
     // ディレクトリは常に名前順が良い場合が多いですが、設定に従うなら以下のようにします
-    QFileInfoList subDirInfos = dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    QFileInfoList subDirInfos = snapshot.subDirs;
     sortFileInfos(subDirInfos); // ★ ソート実行
 
-    QIcon folderIcon = getIcon("no_image");
-
-    for (const QFileInfo& info : subDirInfos) {
-        QString fullPath = info.absoluteFilePath();
-        // 名前表示用 (フォルダ名はそのまま)
-        QWidget* widget = createItemWidget(info.fileName(), fullPath, folderIcon, false);
-
-        QListWidgetItem* item = new QListWidgetItem(m_listWidget);
-        item->setData(Qt::UserRole, fullPath);
-        item->setData(Qt::UserRole + 1, false);
-        item->setSizeHint(widget->sizeHint());
-        m_listWidget->setItemWidget(item, widget);
-    }
-
     // 3. 画像ファイル
+    QFileInfoList fileInfos;
     if (m_showImages) {
-        QStringList filters;
-        for(const QString &ext : m_imageExtensions) filters << "*." + ext;
-
-        // ★ ファイル情報を取得
-        QFileInfoList fileInfos = dir.entryInfoList(filters, QDir::Files);
+        fileInfos = snapshot.imageFiles;
         sortFileInfos(fileInfos); // ★ ソート実行 (ここで自然順ソートなどが適用される)
+    }
 
-        QIcon imgIcon = getIcon("image");
-
-        for (const QFileInfo& info : fileInfos) {
-            QString fullPath = info.absoluteFilePath();
-            QWidget* widget = createItemWidget(info.fileName(), fullPath, imgIcon, true);
+    entries.reserve(entries.size() + subDirInfos.size() + fileInfos.size());
+    for (const QFileInfo& info : std::as_const(subDirInfos)) entries << makeEntry(info, false);
+    for (const QFileInfo& info : std::as_const(fileInfos)) entries << makeEntry(info, true);
 
-            QListWidgetItem* item = new QListWidgetItem(m_listWidget);
-            item->setData(Qt::UserRole, fullPath);
-            item->setData(Qt::UserRole + 1, true);
-            item->setSizeHint(widget->sizeHint());
-            m_listWidget->setItemWidget(item, widget);
-        }
-    }
+    m_model->setEntries(entries);
 
     // スクロール位置の復元
     if (m_scrollHistory.contains(m_currentPath)) {
-        m_listWidget->verticalScrollBar()->setValue(m_scrollHistory.value(m_currentPath));
+        m_listView->verticalScrollBar()->setValue(m_scrollHistory.value(m_currentPath));
     } else {
-        m_listWidget->verticalScrollBar()->setValue(0);
+        m_listView->verticalScrollBar()->setValue(0);
     }
 }
 
-QWidget* BookshelfWidget::createItemWidget(const QString &name, const QString &path, const QIcon &defaultIcon, bool isImageFile)
+DirectorySnapshotCache::Snapshot BookshelfWidget::currentSnapshot()
 {
-    QWidget* widget = new QWidget();
-
-    // アイコン
-    QLabel* iconLabel = new QLabel(widget);
-    iconLabel->setObjectName("iconLabel"); // 後で検索するために名前を付ける
-    iconLabel->setVisible(m_thumbnailsVisible);
-    QSize iconSize(64, 64);
-    iconLabel->setFixedSize(iconSize);
-    iconLabel->setAlignment(Qt::AlignCenter);
-    iconLabel->setPixmap(defaultIcon.pixmap(iconSize));
-
-    // テキスト
-    QLabel* nameLabel = new QLabel(name, widget);
-    QFont nameFont = nameLabel->font();
-    nameFont.setBold(true);
-    nameFont.setPointSize(m_currentFontSize);
-    nameLabel->setFont(nameFont);
-
-    QLabel* dateLabel = new QLabel(widget);
-    QFont dateFont = dateLabel->font();
-    if (m_syncDateFont) {
-        dateFont.setPointSize(qMax(8, m_currentFontSize - 2));
-    }
-    dateLabel->setFont(dateFont);
-
-    if (!path.isEmpty() && name != "..") {
-        QFileInfo fi(path);
-        dateLabel->setText(fi.lastModified().toString("yyyy/MM/dd hh:mm"));
-        // サムネイル読み込み開始
-        if (m_thumbnailsVisible) {
-            loadThumbnailAsync(path, iconSize, isImageFile);
+    QStringList filters;
+    for (const QString &ext : m_imageExtensions) filters << "*." + ext;
+
+    if (m_directoryCache && m_directoryCache->nameFilters() == filters) {
+        if (!m_directoryCache->contains(m_currentPath)) {
+            m_directoryCache->store(m_currentPath, DirectorySnapshotCache::scan(m_currentPath, filters));
         }
+        return m_directoryCache->snapshot(m_currentPath);
     }
+    return DirectorySnapshotCache::scan(m_currentPath, filters);
+}
 
-    QVBoxLayout* textLayout = new QVBoxLayout();
-    textLayout->addWidget(nameLabel);
-    textLayout->addWidget(dateLabel);
-    textLayout->setSpacing(0);
-    textLayout->setContentsMargins(m_thumbnailsVisible ? 5 : 0, 0, 0, 0);
-
-    QHBoxLayout* mainLayout = new QHBoxLayout(widget);
-    mainLayout->addWidget(iconLabel);
-    mainLayout->addLayout(textLayout);
-    mainLayout->setContentsMargins(5, 5, 5, 5);
-    widget->setLayout(mainLayout);
+BookshelfModel::Entry BookshelfWidget::makeEntry(const QFileInfo &info, bool isImageFile)
+{
+    BookshelfModel::Entry entry;
+    entry.name = info.fileName(); // 名前表示用 (フォルダ名はそのまま)
+    entry.path = info.absoluteFilePath();
+    entry.lastModified = info.lastModified();
+    entry.size = info.size();
+    entry.isImage = isImageFile;
+    return entry;
+}
 
-    return widget;
+void BookshelfWidget::setDirectoryCache(DirectorySnapshotCache *cache)
+{
+    if (m_directoryCache) disconnect(m_directoryCache, nullptr, this, nullptr);
+    m_directoryCache = cache;
+    if (m_directoryCache) {
+        connect(m_directoryCache, &DirectorySnapshotCache::directoryUpdated, this, &BookshelfWidget::onDirectoryUpdated);
+    }
 }
 
-void BookshelfWidget::loadThumbnailAsync(const QString &path, const QSize &size, bool isImageFile)
+void BookshelfWidget::onDirectoryUpdated(const QString &dirPath,
+                                         const QFileInfoList &addedFiles, const QStringList &removedFiles,
+                                         const QFileInfoList &addedDirs, const QStringList &removedDirs)
 {
-    // 非同期処理 (MainWindowの実装を移植)
-    // 実際の実装では、ここで QtConcurrent::run を呼び出し、
-    // 完了シグナルで onThumbnailLoaded を呼んで iconLabel に setPixmap する
-    // (詳細は元の mainwindow.cpp の loadThumbnailAsync を参照し、
-    //  findChild<QLabel*>("iconLabel") を使用して更新する)
-
-    auto future = QtConcurrent::run([this, path, size, isImageFile]() -> QPixmap {
-        QString targetPath = isImageFile ? path : findFirstImageIn(path);
-        if (targetPath.isEmpty()) return QPixmap();
-
-        // キャッシュ確認 (スレッドセーフに行う)
-        QMutexLocker locker(&m_thumbnailCacheMutex);
-        if (auto cached = m_thumbnailCache.object(targetPath)) {
-            return *cached;
+    if (dirPath != DirectorySnapshotCache::normalizedPath(m_currentPath)) return;
+
+    // 1. 削除 (".." は対象外)
+    for (const QString &p : removedFiles + removedDirs) {
+        m_model->removeEntryAt(m_model->rowForPath(p));
+    }
+
+    // 2. 追加 (フォルダ群 / 画像群それぞれのソート済み位置へ)
+    // 行の並び: [..] [フォルダ...] [画像...]
+    auto insertSorted = [this](const QFileInfo &info, bool isImageFile) {
+        const int count = m_model->rowCount();
+        // 同じ種類のグループの範囲 [first, last) を求める
+        int first = (count > 0 && m_model->entryAt(0).isParent) ? 1 : 0;
+        if (isImageFile) {
+            while (first < count && !m_model->entryAt(first).isImage) ++first;
+        }
+        int last = first;
+        while (last < count && m_model->entryAt(last).isImage == isImageFile) ++last;
+
+        int row = last;
+        if (m_currentSortMode == SortShuffle) {
+            row = first + QRandomGenerator::global()->bounded(last - first + 1);
+        } else {
+            // 二分探索で挿入位置を決める
+            int lo = first, hi = last;
+            while (lo < hi) {
+                const int mid = (lo + hi) / 2;
+                if (lessThan(QFileInfo(m_model->entryAt(mid).path), info)) lo = mid + 1;
+                else hi = mid;
+            }
+            row = lo;
         }
-        locker.unlock();
+        m_model->insertEntry(row, makeEntry(info, isImageFile));
+    };
 
-        QImageReader reader(targetPath);
-        if (!reader.canRead()) return QPixmap();
+    for (const QFileInfo &info : addedDirs) insertSorted(info, false);
+    if (m_showImages) {
+        for (const QFileInfo &info : addedFiles) insertSorted(info, true);
+    }
+}
 
-        reader.setScaledSize(reader.size().scaled(size, Qt::KeepAspectRatio));
-        QImage img = reader.read();
-        if (img.isNull()) return QPixmap();
+void BookshelfWidget::requestThumbnail(const QString &path, bool isImageFile)
+{
+    if (m_queuedThumbnails.contains(path)) return;
+    m_queuedThumbnails.insert(path);
+    m_thumbnailQueue.append({path, isImageFile});
+    scheduleThumbnailDispatch();
+}
 
-        QPixmap pix = QPixmap::fromImage(img);
+void BookshelfWidget::scheduleThumbnailDispatch()
+{
+    // 同じイベントループ内の要求 (1回の描画分) をまとめてから優先度を決める
+    if (m_thumbnailDispatchScheduled) return;
+    m_thumbnailDispatchScheduled = true;
+    QTimer::singleShot(0, this, &BookshelfWidget::dispatchThumbnailJobs);
+}
 
-        locker.relock();
-        m_thumbnailCache.insert(targetPath, new QPixmap(pix));
-        return pix;
+void BookshelfWidget::dispatchThumbnailJobs()
+{
+    m_thumbnailDispatchScheduled = false;
+    if (m_thumbnailQueue.isEmpty() || m_runningThumbnailJobs >= MAX_THUMBNAIL_JOBS) return;
+
+    // 現在の表示範囲 (行)
+    const int rowCount = m_model->rowCount();
+    int firstVisible = m_listView->indexAt(QPoint(0, 0)).row();
+    int lastVisible = m_listView->indexAt(QPoint(0, m_listView->viewport()->height() - 1)).row();
+    if (firstVisible < 0) firstVisible = 0;
+    if (lastVisible < 0) lastVisible = rowCount - 1;
+
+    auto distanceOf = [firstVisible, lastVisible](int row) {
+        if (row < firstVisible) return firstVisible - row;
+        if (row > lastVisible) return row - lastVisible;
+        return 0;
+    };
+
+    // 一覧から消えた行を捨て、表示範囲からの距離で並べ替える
+    QList<QPair<int, ThumbnailJob>> ordered;
+    ordered.reserve(m_thumbnailQueue.size());
+    for (const ThumbnailJob &job : std::as_const(m_thumbnailQueue)) {
+        const int row = m_model->rowForPath(job.path);
+        if (row < 0) {
+            m_queuedThumbnails.remove(job.path);
+            continue;
+        }
+        ordered.append({distanceOf(row), job});
+    }
+    std::stable_sort(ordered.begin(), ordered.end(), [](const auto &a, const auto &b) {
+        return a.first < b.first;
     });
 
-    auto watcher = new QFutureWatcher<QPixmap>(this);
-    connect(watcher, &QFutureWatcher<QPixmap>::finished, this, [this, watcher, path, size](){
-        QPixmap res = watcher->result();
-        if (!res.isNull()) {
-            // リスト内を検索して該当アイテムのアイコンを更新
-            // (本来は ItemWidget 側で受ける設計の方が良いが、現状のロジックを維持)
-            for(int i=0; i<m_listWidget->count(); ++i) {
-                QListWidgetItem* item = m_listWidget->item(i);
-                if (item->data(Qt::UserRole).toString() == path) {
-                    QWidget* w = m_listWidget->itemWidget(item);
-                    if (w) {
-                        QLabel* icon = w->findChild<QLabel*>("iconLabel");
-                        if (icon) icon->setPixmap(res.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation));
-                    }
-                    break;
+    m_thumbnailQueue.clear();
+    for (const auto &pair : std::as_const(ordered)) {
+        if (m_runningThumbnailJobs < MAX_THUMBNAIL_JOBS) {
+            m_queuedThumbnails.remove(pair.second.path);
+            loadThumbnailAsync(pair.second.path, QSize(BookshelfItemDelegate::ICON_SIZE, BookshelfItemDelegate::ICON_SIZE),
+                               pair.second.isImageFile);
+        } else {
+            m_thumbnailQueue.append(pair.second);
+        }
+    }
+}
+
+void BookshelfWidget::cancelThumbnailJobs()
+{
+    // 未着手の要求は捨て、実行中のジョブには世代の変化で中断/破棄させる
+    m_thumbnailGeneration->ref();
+    m_thumbnailQueue.clear();
+    m_queuedThumbnails.clear();
+    m_videoCoverFolders.clear();
+}
+
+void BookshelfWidget::loadThumbnailAsync(const QString &path, const QSize &size, bool isImageFile)
+{
+    // 非同期処理 (MainWindowの実装を移植)
+    // 完了時はモデルへサムネイルを渡し、該当行だけを再描画させる
+    // ★ ワーカーは this に触れない (ウィジェットが先に破棄されても安全なように、必要なものはコピー/共有で渡す)
+    const int generation = m_thumbnailGeneration->loadRelaxed();
+    QSharedPointer<QAtomicInt> generationToken = m_thumbnailGeneration;
+    QSharedPointer<ThumbnailStore> store = m_thumbnailStore;
+    QSharedPointer<CoverIndex> coverIndex = m_coverIndex;
+    const SortMode sortMode = m_currentSortMode;
+    const bool ascending = m_sortAscending;
+    const QString packDir = isImageFile ? QString() : m_currentPath; // フォルダの表紙は一覧のパックへ
+    QStringList filters;
+    for (const QString &ext : m_imageExtensions) filters << "*." + ext;
+    QStringList videoFilters;
+    if (m_videoThumbnailer) {
+        for (const QString &ext : m_videoExtensions) videoFilters << "*." + ext;
+    }
+
+    // ★ ワーカーでは QImage のまま扱う (QPixmap への変換は GUI スレッドで行う)
+    auto future = QtConcurrent::run([path, size, isImageFile, generation, generationToken, store, coverIndex,
+                                     sortMode, ascending, packDir, filters, videoFilters]() -> QImage {
+        // 着手前に移動済みなら何もしない
+        if (generationToken->loadRelaxed() != generation) return QImage();
+
+        // 対象画像 (フォルダなら表紙) とストアのキー
+        QString targetPath = path;
+        QDateTime targetModified;
+        qint64 targetSize = 0;
+        if (isImageFile) {
+            const QFileInfo targetInfo(targetPath);
+            targetModified = targetInfo.lastModified();
+            targetSize = targetInfo.size();
+        } else {
+            // ★ 表紙は索引を優先し、なければ1回の走査で探して記録する
+            const QDateTime dirModified = QFileInfo(path).lastModified();
+            CoverIndex::Cover cover;
+            if (!coverIndex->lookup(path, dirModified, sortMode, ascending, &cover)) {
+                cover = CoverIndex::discover(path, filters, sortMode, ascending);
+                // 画像がなければ動画を表紙にする
+                if (cover.path.isEmpty() && !videoFilters.isEmpty()) {
+                    cover = CoverIndex::discover(path, videoFilters, sortMode, ascending);
                 }
+                coverIndex->store(path, dirModified, sortMode, ascending, cover);
+            }
+            targetPath = cover.path;
+            targetModified = cover.lastModified;
+            targetSize = cover.size;
+        }
+        if (targetPath.isEmpty()) return QImage();
+
+        // ディスクのストアを確認 (デコード不要)
+        QImage img = store->find(targetPath, targetModified, targetSize, packDir);
+        if (img.isNull()) {
+            if (generationToken->loadRelaxed() != generation) return QImage();
+            // 動画はここではデコードしない (GUI スレッドから VideoThumbnailer に頼む)
+            if (VideoThumbnailer::isVideoFile(targetPath)) return QImage();
+
+            // ★ 埋め込みプレビュー (EXIF サムネイルなど) が足りる大きさなら本体はデコードしない
+            img = ExifPreview::read(targetPath, qMax(size.width(), size.height()), size);
+            if (img.isNull()) {
+                QImageReader reader(targetPath);
+                if (!reader.canRead()) return QImage();
+
+                reader.setScaledSize(reader.size().scaled(size, Qt::KeepAspectRatio));
+                img = reader.read();
+                if (img.isNull()) return QImage();
             }
+
+            store->insert(targetPath, targetModified, targetSize, img, packDir);
         }
+        return img;
+    });
+
+    // ウォッチャーは this の子なので、ウィジェット破棄後に完了しても通知は届かない
+    auto watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, path, size, isImageFile, generation](){
+        --m_runningThumbnailJobs;
         watcher->deleteLater();
-        m_activeWatchers.removeAll(watcher);
+
+        QImage res = watcher->result();
+        if (!res.isNull() && generation == m_thumbnailGeneration->loadRelaxed()) {
+            // ★ パス→行のハッシュで該当行だけを更新 (別フォルダへ移動済みなら何もしない)
+            m_model->setThumbnail(path, QPixmap::fromImage(res.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation)));
+        } else if (res.isNull() && !isImageFile && generation == m_thumbnailGeneration->loadRelaxed()) {
+            requestVideoCover(path);
+        }
+        scheduleThumbnailDispatch();
+
+        // 一段落したら表紙の索引を書き出しておく
+        if (m_runningThumbnailJobs == 0 && m_thumbnailQueue.isEmpty()) m_coverIndex->save();
     });
-    m_activeWatchers.append(watcher);
+    ++m_runningThumbnailJobs;
     watcher->setFuture(future);
 }
 
-QString BookshelfWidget::findFirstImageIn(const QString &dirPath)
-{
-    QDir dir(dirPath);
-    QStringList filters;
-    for(const QString &ext : m_imageExtensions) filters << "*." + ext;
-    QStringList files = dir.entryList(filters, QDir::Files, QDir::Name);
-    return files.isEmpty() ? QString() : dir.filePath(files.first());
-}
-
-void BookshelfWidget::onItemDoubleClicked(QListWidgetItem *item)
+void BookshelfWidget::onItemDoubleClicked(const QModelIndex &index)
 {
-    if (!item) return;
-    QString path = item->data(Qt::UserRole).toString();
-    bool isImage = item->data(Qt::UserRole + 1).toBool();
+    if (!index.isValid()) return;
+    QString path = index.data(BookshelfModel::PathRole).toString();
+    bool isImage = index.data(BookshelfModel::IsImageRole).toBool();
 
     if (isImage) {
         // 画像なら選択通知 -> MainWindowがMediaViewで表示
         emit imageFileSelected(path);
     } else {
-        // フォルダなら移動
-        if (path == "..") {
-            // navigateToPath内で処理される
-        }
+        // フォルダなら移動 (".." も親ディレクトリのパスを持っている)
         navigateToPath(path);
     }
 }
@@ -389,3 +530,41 @@ QIcon BookshelfWidget::getIcon(const QString &name) const
     // マップに登録されていればそれを返し、なければ空のアイコンを返す
     return m_icons.value(name, QIcon());
 }
+
+void BookshelfWidget::requestVideoCover(const QString &dirPath)
+{
+    // 表紙が動画のフォルダだけ (表紙の索引はワーカーが記録済み)
+    const int row = m_model->rowForPath(dirPath);
+    if (!m_videoThumbnailer || row < 0) return;
+    CoverIndex::Cover cover;
+    if (!m_coverIndex->lookup(dirPath, m_model->entryAt(row).lastModified, m_currentSortMode, m_sortAscending, &cover)
+        || !VideoThumbnailer::isVideoFile(cover.path)) {
+        return;
+    }
+    m_videoCoverFolders.insert(cover.path, dirPath);
+    m_videoThumbnailer->requestCover(cover.path);
+}
+
+void BookshelfWidget::onVideoCoverReady(const QString &videoPath)
+{
+    const QString dirPath = m_videoCoverFolders.take(videoPath);
+    const int row = m_model->rowForPath(dirPath);
+    if (dirPath.isEmpty() || row < 0) return;
+
+    const QImage image = m_videoThumbnailer->cover(videoPath);
+    if (image.isNull()) return;
+    const QSize size(BookshelfItemDelegate::ICON_SIZE, BookshelfItemDelegate::ICON_SIZE);
+    m_model->setThumbnail(dirPath, QPixmap::fromImage(image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation)));
+
+    // 次からは描画時に引けるよう、一覧しているディレクトリのパックにも入れておく (書き込みはワーカーで)
+    CoverIndex::Cover cover;
+    if (!m_coverIndex->lookup(dirPath, m_model->entryAt(row).lastModified, m_currentSortMode, m_sortAscending, &cover)
+        || cover.path != videoPath) {
+        return;
+    }
+    QSharedPointer<ThumbnailStore> store = m_thumbnailStore;
+    const QString packDir = m_currentPath;
+    QThreadPool::globalInstance()->start([store, cover, image, packDir]() {
+        store->insert(cover.path, cover.lastModified, cover.size, image, packDir);
+    });
+}
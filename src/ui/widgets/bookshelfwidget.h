@@ -2,14 +2,22 @@
 #define BOOKSHELFWIDGET_H
 
 #include <QWidget>
-#include <QListWidget>
+#include <QListView>
 #include <QDir>
-#include <QMutex>
-#include <QCache>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QSet>
+#include <QHash>
 #include <QCollator>
-#include <QFutureWatcher>
 
 #include "utils/common_types.h"
+#include "directorysnapshotcache.h"
+#include "bookshelfmodel.h"
+#include "thumbnailstore.h"
+#include "coverindex.h"
+
+class BookshelfItemDelegate;
+class VideoThumbnailer;
 
 class BookshelfWidget : public QWidget
 {
@@ -25,6 +33,10 @@ public:
     void navigateToPath(const QString &path);
     void setIcons(const QMap<QString, QIcon> &icons);
     void setImageExtensions(const QStringList &extensions);
+    // 画像のないフォルダは動画の表紙を使う (表紙のフレームは VideoThumbnailer が作る)
+    void setVideoExtensions(const QStringList &extensions);
+    void setVideoThumbnailer(VideoThumbnailer *thumbnailer);
+    void setDirectoryCache(DirectorySnapshotCache *cache); // 一覧キャッシュ (MainWindow から共有)
     void refresh(); // 表示更新
     QString currentPath() const;
 
@@ -42,15 +54,21 @@ signals:
     void folderSelected(const QString &path);         // フォルダ選択時（ナビゲーション用）
 
 private slots:
-    void onItemDoubleClicked(QListWidgetItem *item);
+    void onItemDoubleClicked(const QModelIndex &index);
+    void onDirectoryUpdated(const QString &dirPath,
+                            const QFileInfoList &addedFiles, const QStringList &removedFiles,
+                            const QFileInfoList &addedDirs, const QStringList &removedDirs);
 
 private:
     // UIコンポーネント
-    QListWidget *m_listWidget;
+    QListView *m_listView;
+    BookshelfModel *m_model;
+    BookshelfItemDelegate *m_delegate;
 
     // データ・設定
     QString m_currentPath;
     QStringList m_imageExtensions;
+    QStringList m_videoExtensions;
     bool m_thumbnailsVisible;
     bool m_showImages;
     bool m_syncDateFont;
@@ -61,9 +79,22 @@ private:
     QMap<QString, int> m_scrollHistory;
 
     // サムネイル処理関連
-    QCache<QString, QPixmap> m_thumbnailCache;
-    QMutex m_thumbnailCacheMutex;
-    QList<QFutureWatcher<QPixmap>*> m_activeWatchers;
+    // ★ 要求はキューに積み、表示範囲に近い行から同時実行数を絞って読み込む
+    struct ThumbnailJob {
+        QString path;
+        bool isImageFile;
+    };
+    QList<ThumbnailJob> m_thumbnailQueue;
+    QSet<QString> m_queuedThumbnails;
+    int m_runningThumbnailJobs;
+    bool m_thumbnailDispatchScheduled;
+    QSharedPointer<QAtomicInt> m_thumbnailGeneration; // 移動のたびに進め、古い要求を捨てる
+    // ディスク上のサムネイル (再起動後も有効)。実行中のジョブも参照するので共有ポインタで持つ
+    QSharedPointer<ThumbnailStore> m_thumbnailStore;
+    QSharedPointer<CoverIndex> m_coverIndex; // フォルダ -> 表紙画像 (フォルダの更新日時で無効化)
+    VideoThumbnailer *m_videoThumbnailer;
+    QHash<QString, QString> m_videoCoverFolders; // 表紙を作ってもらっている動画 -> フォルダ
+    static const int MAX_THUMBNAIL_JOBS = 4;
 
     // --- ★ 追加: ソート用メンバ ---
     QCollator m_collator;       // 自然順ソート用クラス
@@ -71,12 +102,23 @@ private:
     bool m_sortAscending;       // 昇順(true)か降順(false)か
     // --- ★ 追加: ソート実行ヘルパー関数 ---
     void sortFileInfos(QFileInfoList &list);
+    bool lessThan(const QFileInfo &a, const QFileInfo &b) const;
+
+    // ディレクトリ一覧のキャッシュ
+    DirectorySnapshotCache *m_directoryCache;
+    DirectorySnapshotCache::Snapshot currentSnapshot();
+    static BookshelfModel::Entry makeEntry(const QFileInfo &info, bool isImageFile);
 
     // 内部ヘルパー関数
     void updateView();
-    QWidget* createItemWidget(const QString &name, const QString &path, const QIcon &icon, bool isImageFile);
+    void relayoutRows(); // 行の高さが変わる設定変更後の再レイアウト
+    void requestThumbnail(const QString &path, bool isImageFile);
+    void scheduleThumbnailDispatch();
+    void dispatchThumbnailJobs();
+    void cancelThumbnailJobs();
     void loadThumbnailAsync(const QString &dirPath, const QSize &size, bool isImageFile);
-    QString findFirstImageIn(const QString &dirPath);
+    void requestVideoCover(const QString &dirPath);
+    void onVideoCoverReady(const QString &videoPath);
     QIcon getIcon(const QString &name) const;
 };
 
@@ -4,6 +4,8 @@
 #include <qstyle.h>
 #include <QHBoxLayout> // 追加
 #include <QTime>
+#include <QMouseEvent>
+#include <QPainter>
 
 ControlBar::ControlBar(QWidget *parent) :
     QWidget(parent),
@@ -16,7 +18,8 @@ ControlBar::ControlBar(QWidget *parent) :
     m_isCompact(false),
     m_currentPosition(0),
     m_totalDuration(0),
-    m_showRemainingTime(false)
+    m_showRemainingTime(false),
+    m_seekPreview(nullptr)
 {
     ui->setupUi(this);
 
@@ -75,6 +78,12 @@ ControlBar::ControlBar(QWidget *parent) :
     connect(ui->progressSlider, &QSlider::sliderPressed, this, &ControlBar::positionSliderPressed);
     connect(ui->progressSlider, &QSlider::sliderReleased, this, &ControlBar::positionSliderReleased);
 
+    // ホバー位置のプレビュー (ウィンドウの外にはみ出せるよう、ツールチップと同じ種類の小さなウィンドウにする)
+    m_seekPreview = new QLabel(this, Qt::ToolTip | Qt::FramelessWindowHint);
+    m_seekPreview->setAttribute(Qt::WA_TransparentForMouseEvents);
+    ui->progressSlider->setMouseTracking(true);
+    ui->progressSlider->installEventFilter(this);
+
     // --- ボリューム操作（スライダーとスピンボックスの同期）---
     // スライダーが動いたら、シグナルを発信し、スピンボックスも更新
     connect(ui->volumeSlider, &QSlider::valueChanged, this, [this](int value){
@@ -342,6 +351,19 @@ void ControlBar::setTimeLabel(const QString &text)
     ui->timeLabel->setText(text);
 }
 
+void ControlBar::setAudioOutputInfo(int frequency, int bufferSamples)
+{
+    // 出力デバイスの状態はツールチップで表示 (バッファ1つ分が出力の遅延になる)
+    QString info;
+    if (frequency > 0) {
+        const double latencyMs = bufferSamples * 1000.0 / frequency;
+        info = QString("出力: %1 Hz / バッファ %2 サンプル (%3 ms)")
+                   .arg(frequency).arg(bufferSamples).arg(latencyMs, 0, 'f', 1);
+    }
+    ui->trackInfoLabel->setToolTip(info);
+    ui->timeLabel->setToolTip(info);
+}
+
 void ControlBar::setPlaylistButtonState(int id, bool isEmpty, bool isPlaying, const QString &tooltip)
 {
     QAbstractButton* btn = m_playlistButtons->button(id);
@@ -541,3 +563,56 @@ void ControlBar::wheelEvent(QWheelEvent *event)
     // イベントを受け取ったことを通知
     event->accept();
 }
+
+bool ControlBar::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == ui->progressSlider) {
+        switch (event->type()) {
+        case QEvent::MouseMove:
+            showSeekPreview(static_cast<QMouseEvent*>(event)->position().toPoint().x());
+            break;
+        case QEvent::Leave:
+        case QEvent::Hide:
+            m_seekPreview->hide();
+            break;
+        default:
+            break;
+        }
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void ControlBar::showSeekPreview(int x)
+{
+    QSlider* slider = ui->progressSlider;
+    if (!m_seekPreviewLookup || m_totalDuration <= 0 || slider->width() <= 0) {
+        m_seekPreview->hide();
+        return;
+    }
+
+    // クリック時 (ClickableSlider) と同じ計算で位置を出す
+    const double ratio = qBound(0.0, static_cast<double>(x) / slider->width(), 1.0);
+    const int position = slider->minimum() + qRound(ratio * (slider->maximum() - slider->minimum()));
+    const QImage image = m_seekPreviewLookup(position, int(m_totalDuration));
+    if (image.isNull()) {
+        m_seekPreview->hide();
+        return;
+    }
+
+    // 画像の下端に時刻を重ねる
+    QPixmap pixmap = QPixmap::fromImage(image);
+    QPainter painter(&pixmap);
+    const QString text = formatTime(position);
+    QRect textRect = painter.fontMetrics().boundingRect(text).adjusted(-3, -1, 3, 1);
+    textRect.moveCenter(QPoint(pixmap.width() / 2, pixmap.height() - textRect.height() / 2 - 2));
+    painter.fillRect(textRect, QColor(0, 0, 0, 160));
+    painter.setPen(Qt::white);
+    painter.drawText(textRect, Qt::AlignCenter, text);
+    painter.end();
+
+    m_seekPreview->setPixmap(pixmap);
+    m_seekPreview->resize(pixmap.size());
+    const QPoint anchor = slider->mapToGlobal(QPoint(x, 0));
+    m_seekPreview->move(anchor.x() - pixmap.width() / 2, anchor.y() - pixmap.height() - 4);
+    m_seekPreview->show();
+}
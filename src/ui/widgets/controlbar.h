@@ -4,11 +4,13 @@
 #include <QAction>
 #include <QButtonGroup>
 #include <QIcon>
+#include <QImage>
 #include <QLabel>
 #include <QMenu>
 #include <QPushButton>
 #include <QWheelEvent>
 #include <QWidget>
+#include <functional>
 
 // クラスの前方宣言
 namespace Ui {
@@ -25,6 +27,9 @@ public:
     int position() const;
     int volume() const;
 
+    // シークバーのホバー時に表示するプレビュー画像を引く関数 (位置, 長さ) -> 画像 (なければ null)
+    void setSeekPreviewLookup(const std::function<QImage(int, int)> &lookup) { m_seekPreviewLookup = lookup; }
+
     // LoopModeとShuffleModeをMainWindowと共有するためのenum
     // MainWindow.hからコピーしてきても、ここで再定義しても良い
     enum LoopMode { NoLoop, RepeatOne, RepeatAll };
@@ -62,6 +67,7 @@ public slots:
     void setProgressPosition(int position);
     void setTrackInfo(const QString &info);
     void setTimeLabel(const QString &text);
+    void setAudioOutputInfo(int frequency, int bufferSamples);
     void setVolume(int percent, const QIcon& zeroIcon, const QIcon& downIcon, const QIcon& upIcon);
     void toggleTimeDisplayMode();
     void updateButtonStates(bool canGoNext, bool canGoPrev, const QIcon& nextIcon, const QIcon& prevIcon, const QIcon& stopIcon);
@@ -72,6 +78,7 @@ public slots:
 
 protected:
     void wheelEvent(QWheelEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private slots:
     void showContextMenu(const QPoint &pos);
@@ -104,6 +111,11 @@ private:
 
     QString formatTime(qint64 ms) const;
     void updateTimeLabels(); // 表示更新用
+
+    // シークプレビュー (ストアに保存済みの画像を表示するだけ。デコードはしない)
+    void showSeekPreview(int x);
+    std::function<QImage(int, int)> m_seekPreviewLookup;
+    QLabel* m_seekPreview;
 };
 
 #endif // CONTROLBAR_H
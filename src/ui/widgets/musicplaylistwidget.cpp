@@ -187,6 +187,21 @@ QString MusicPlaylistWidget::tabText(int index) const { return m_tabWidget->tabT
 void MusicPlaylistWidget::setTabText(int index, const QString &text) { m_tabWidget->setTabText(index, text); }
 QList<QListWidget*> MusicPlaylistWidget::allListWidgets() const { return m_listWidgets; }
 
+void MusicPlaylistWidget::setThumbnailLookup(const std::function<QImage(const QString &)> &lookup)
+{
+    m_thumbnailLookup = lookup;
+    for (QListWidget* list : std::as_const(m_listWidgets)) {
+        if (auto *delegate = qobject_cast<MediaItemDelegate*>(list->itemDelegate())) delegate->setThumbnailLookup(lookup);
+        list->viewport()->update();
+    }
+}
+
+void MusicPlaylistWidget::refreshThumbnails()
+{
+    // 表示されている行だけが描き直される
+    for (QListWidget* list : std::as_const(m_listWidgets)) list->viewport()->update();
+}
+
 // --- Internal Logic ---
 
 QListWidget* MusicPlaylistWidget::createListWidget()
@@ -198,7 +213,9 @@ QListWidget* MusicPlaylistWidget::createListWidget()
     list->setAcceptDrops(true);
     list->setDropIndicatorShown(true);
     list->setDragDropMode(QAbstractItemView::InternalMove); // デフォルト
-    list->setItemDelegate(new MediaItemDelegate(this));
+    MediaItemDelegate *delegate = new MediaItemDelegate(this);
+    delegate->setThumbnailLookup(m_thumbnailLookup);
+    list->setItemDelegate(delegate);
 
     setupListConnections(list);
     return list;
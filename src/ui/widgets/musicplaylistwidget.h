@@ -4,6 +4,8 @@
 #include <QWidget>
 #include <QTabWidget>
 #include <QListWidget>
+#include <QImage>
+#include <functional>
 #include "playlistmanager.h"
 
 class MusicPlaylistWidget : public QWidget
@@ -30,6 +32,10 @@ public:
     void setTabText(int index, const QString &text);
     QList<QListWidget*> allListWidgets() const; // UI同期用
 
+    // 行の左端に描くサムネイル (動画の表紙)。後から作ったタブにも適用する
+    void setThumbnailLookup(const std::function<QImage(const QString &)> &lookup);
+    void refreshThumbnails(); // サムネイルが届いたら再描画する
+
 public slots:
     void applyUiSettings(int fontSize, bool reorderEnabled); // フォント等の適用
     void saveCurrentPlaylist();
@@ -58,6 +64,7 @@ private:
     QTabWidget *m_tabWidget;
     PlaylistManager *m_playlistManager;
     QList<QListWidget*> m_listWidgets;
+    std::function<QImage(const QString &)> m_thumbnailLookup;
 
     // ヘルパー
     QListWidget* createListWidget();
@@ -0,0 +1,91 @@
+#include "audioprobe.h"
+#include <QByteArray>
+#include <QFile>
+#include <algorithm>
+
+namespace {
+quint32 readLE32(const uchar *p)
+{
+    return quint32(p[0]) | (quint32(p[1]) << 8) | (quint32(p[2]) << 16) | (quint32(p[3]) << 24);
+}
+
+// ID3v2 タグの長さ (なければ 0)
+qint64 id3v2Size(const QByteArray &data)
+{
+    if (data.size() < 10 || !data.startsWith("ID3")) return 0;
+    const uchar *p = reinterpret_cast<const uchar *>(data.constData());
+    const qint64 size = (qint64(p[6] & 0x7F) << 21) | ((p[7] & 0x7F) << 14) | ((p[8] & 0x7F) << 7) | (p[9] & 0x7F);
+    const bool hasFooter = p[5] & 0x10;
+    return 10 + size + (hasFooter ? 10 : 0);
+}
+
+int wavSampleRate(const QByteArray &data)
+{
+    // RIFF ヘッダの後ろのチャンクから "fmt " を探す
+    const uchar *p = reinterpret_cast<const uchar *>(data.constData());
+    qint64 pos = 12;
+    while (pos + 8 <= data.size()) {
+        const quint32 length = readLE32(p + pos + 4);
+        if (std::equal(p + pos, p + pos + 4, reinterpret_cast<const uchar *>("fmt "))) {
+            return (length >= 8 && pos + 16 <= data.size()) ? int(readLE32(p + pos + 12)) : 0;
+        }
+        pos += 8 + length + (length & 1);
+    }
+    return 0;
+}
+
+int flacSampleRate(const QByteArray &data, qint64 start)
+{
+    // "fLaC" + ブロックヘッダ (4) + STREAMINFO: 10バイト目から 20bit
+    if (start + 4 + 4 + 18 > data.size() || data.mid(start, 4) != "fLaC") return 0;
+    const uchar *info = reinterpret_cast<const uchar *>(data.constData()) + start + 8;
+    return (info[10] << 12) | (info[11] << 4) | (info[12] >> 4);
+}
+
+int oggSampleRate(const QByteArray &data)
+{
+    // Opus は常に 48kHz でデコードされる
+    if (data.indexOf("OpusHead") >= 0) return 48000;
+
+    // Vorbis 識別ヘッダ: "\x01vorbis" + version(4) + channels(1) + rate(4)
+    const int at = data.indexOf(QByteArray("\x01vorbis", 7));
+    if (at < 0 || at + 16 > data.size()) return 0;
+    return int(readLE32(reinterpret_cast<const uchar *>(data.constData()) + at + 12));
+}
+
+int mp3SampleRate(const QByteArray &data, qint64 start)
+{
+    static const int rates[3] = { 44100, 48000, 32000 };
+    const uchar *p = reinterpret_cast<const uchar *>(data.constData());
+
+    // フレーム同期を探し、ヘッダとして妥当な最初のものを使う
+    for (qint64 i = start; i + 4 <= data.size(); ++i) {
+        if (p[i] != 0xFF || (p[i + 1] & 0xE0) != 0xE0) continue;
+        const int version = (p[i + 1] >> 3) & 3; // 3: MPEG1, 2: MPEG2, 0: MPEG2.5
+        const int layer = (p[i + 1] >> 1) & 3;
+        const int bitrateIndex = p[i + 2] >> 4;
+        const int rateIndex = (p[i + 2] >> 2) & 3;
+        if (version == 1 || layer == 0 || bitrateIndex == 15 || rateIndex == 3) continue;
+
+        const int rate = rates[rateIndex];
+        return version == 3 ? rate : (version == 2 ? rate / 2 : rate / 4);
+    }
+    return 0;
+}
+}
+
+int AudioProbe::sampleRate(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return 0;
+    const QByteArray data = file.read(PROBE_BYTES);
+    if (data.size() < 12) return 0;
+
+    if (data.startsWith("RIFF") && data.mid(8, 4) == "WAVE") return wavSampleRate(data);
+    if (data.startsWith("OggS")) return oggSampleRate(data);
+
+    // FLAC / MP3 は先頭に ID3v2 タグが付いていることがある
+    const qint64 start = id3v2Size(data);
+    if (const int rate = flacSampleRate(data, start)) return rate;
+    return mp3SampleRate(data, start);
+}
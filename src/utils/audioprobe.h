@@ -0,0 +1,19 @@
+#ifndef AUDIOPROBE_H
+#define AUDIOPROBE_H
+
+#include <QString>
+
+// 音声ファイルのヘッダだけを読んで形式を調べる (デコードはしない)
+// - WAV (fmt チャンク) / FLAC (STREAMINFO) / Ogg Vorbis・Opus (識別ヘッダ) / MP3 (最初のフレームヘッダ)
+// ※ スレッドセーフ (状態を持たない)
+class AudioProbe
+{
+public:
+    // サンプリングレート (Hz)。分からなければ 0
+    static int sampleRate(const QString &filePath);
+
+private:
+    static const int PROBE_BYTES = 64 * 1024; // 先頭からこれだけ読んで探す
+};
+
+#endif // AUDIOPROBE_H
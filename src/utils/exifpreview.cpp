@@ -0,0 +1,203 @@
+#include "exifpreview.h"
+#include <QBuffer>
+#include <QFile>
+#include <QImageReader>
+#include <QList>
+#include <QSet>
+#include <QTransform>
+#include <algorithm>
+
+namespace {
+// TIFF 構造の読み取り (範囲外アクセスはすべて 0 を返す)
+struct TiffReader {
+    const uchar *data = nullptr;
+    qint64 size = 0;
+    bool littleEndian = true;
+
+    bool contains(qint64 offset, qint64 length) const {
+        return offset >= 0 && length >= 0 && offset <= size && length <= size - offset;
+    }
+    quint16 u16(qint64 offset) const {
+        if (!contains(offset, 2)) return 0;
+        const uchar *p = data + offset;
+        return littleEndian ? quint16(p[0] | (p[1] << 8)) : quint16((p[0] << 8) | p[1]);
+    }
+    quint32 u32(qint64 offset) const {
+        if (!contains(offset, 4)) return 0;
+        const uchar *p = data + offset;
+        return littleEndian ? (quint32(p[0]) | (quint32(p[1]) << 8) | (quint32(p[2]) << 16) | (quint32(p[3]) << 24))
+                            : ((quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | quint32(p[3]));
+    }
+    // IFD エントリの値 (SHORT / LONG の1つ目)
+    quint32 value(qint64 entry) const {
+        return u16(entry + 2) == 3 ? u16(entry + 8) : u32(entry + 8);
+    }
+};
+
+struct Candidate {
+    qint64 offset; // ファイル先頭からのオフセット
+    qint64 length;
+};
+
+// 見つかった JPEG の位置 (TIFF 先頭からの相対) を候補に追加
+void addCandidate(QList<Candidate> &candidates, const TiffReader &tiff, qint64 tiffBase, quint32 offset, quint32 length)
+{
+    if (length < 4 || !tiff.contains(offset, length)) return;
+    // JPEG の SOI で始まるものだけ
+    if (tiff.data[offset] != 0xFF || tiff.data[offset + 1] != 0xD8) return;
+    candidates.append({tiffBase + offset, length});
+}
+
+// APP1 の "Exif\0\0" を探して TIFF ヘッダの位置を返す (なければ -1)
+qint64 findExifInJpeg(const uchar *data, qint64 size, qint64 *tiffSize)
+{
+    qint64 pos = 2;
+    while (pos + 4 <= size) {
+        if (data[pos] != 0xFF) return -1;
+        const uchar marker = data[pos + 1];
+        if (marker == 0xFF) { ++pos; continue; }        // フィルバイト
+        if (marker == 0xDA || marker == 0xD9) return -1; // 画像データ開始 / 終了
+        const qint64 length = (data[pos + 2] << 8) | data[pos + 3];
+        if (length < 2) return -1;
+        if (marker == 0xE1 && length >= 8 && pos + 10 <= size
+            && std::equal(data + pos + 4, data + pos + 10, reinterpret_cast<const uchar *>("Exif\0\0"))) {
+            *tiffSize = qMin(length - 8, size - (pos + 10));
+            return pos + 10;
+        }
+        pos += 2 + length;
+    }
+    return -1;
+}
+}
+
+QImage ExifPreview::read(const QString &filePath, int minEdge, const QSize &scaledSize)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < 16) return QImage();
+
+    const qint64 fileSize = file.size();
+    uchar *map = file.map(0, fileSize);
+    if (!map) return QImage();
+
+    // 1. TIFF ヘッダの位置 (JPEG なら APP1 の中、RAW/TIFF ならファイル先頭)
+    qint64 tiffBase = -1;
+    qint64 tiffSize = 0;
+    if (map[0] == 0xFF && map[1] == 0xD8) {
+        tiffBase = findExifInJpeg(map, fileSize, &tiffSize);
+    } else if ((map[0] == 'I' && map[1] == 'I') || (map[0] == 'M' && map[1] == 'M')) {
+        tiffBase = 0;
+        tiffSize = fileSize;
+    }
+    if (tiffBase < 0 || tiffSize < 8) {
+        file.unmap(map);
+        return QImage();
+    }
+
+    TiffReader tiff;
+    tiff.data = map + tiffBase;
+    tiff.size = tiffSize;
+    tiff.littleEndian = map[tiffBase] == 'I';
+
+    // 42: TIFF, 0x55: RW2, "RO"/"RS": ORF
+    const quint16 magic = tiff.u16(2);
+    if (magic != 42 && magic != 0x55 && magic != 0x4F52 && magic != 0x5352) {
+        file.unmap(map);
+        return QImage();
+    }
+
+    // 2. IFD をたどってプレビュー JPEG を集める (IFD0 -> IFD1 ... / SubIFDs)
+    QList<Candidate> candidates;
+    QList<quint32> pendingIfds = { tiff.u32(4) };
+    QSet<quint32> visited;
+    int orientation = 1;
+    bool isFirstIfd = true;
+
+    while (!pendingIfds.isEmpty() && visited.size() < MAX_IFD_COUNT) {
+        const quint32 ifd = pendingIfds.takeFirst();
+        if (ifd == 0 || visited.contains(ifd) || !tiff.contains(ifd, 2)) continue;
+        visited.insert(ifd);
+
+        const int count = tiff.u16(ifd);
+        if (!tiff.contains(ifd + 2, qint64(count) * 12 + 4)) continue;
+
+        quint32 jpegOffset = 0, jpegLength = 0;
+        quint32 stripOffset = 0, stripLength = 0, compression = 0;
+        for (int i = 0; i < count; ++i) {
+            const qint64 entry = ifd + 2 + qint64(i) * 12;
+            const quint16 tag = tiff.u16(entry);
+            const quint32 n = tiff.u32(entry + 4);
+            switch (tag) {
+            case 0x0103: compression = tiff.value(entry); break;
+            case 0x0111: if (n == 1) stripOffset = tiff.value(entry); break;
+            case 0x0117: if (n == 1) stripLength = tiff.value(entry); break;
+            case 0x0112: if (isFirstIfd) orientation = tiff.value(entry); break;
+            case 0x0201: jpegOffset = tiff.value(entry); break;
+            case 0x0202: jpegLength = tiff.value(entry); break;
+            case 0x014A: {
+                // SubIFDs (LONG / IFD の配列。1つならインライン)
+                const qint64 array = n == 1 ? entry + 8 : tiff.u32(entry + 8);
+                for (quint32 k = 0; k < n && k < quint32(MAX_IFD_COUNT); ++k) pendingIfds.append(tiff.u32(array + k * 4));
+                break;
+            }
+            default: break;
+            }
+        }
+
+        if (jpegOffset && jpegLength) addCandidate(candidates, tiff, tiffBase, jpegOffset, jpegLength);
+        // 1ストリップの JPEG 圧縮 (6: 旧JPEG, 7: JPEG) もプレビューの可能性がある
+        if ((compression == 6 || compression == 7) && stripOffset && stripLength) {
+            addCandidate(candidates, tiff, tiffBase, stripOffset, stripLength);
+        }
+
+        pendingIfds.append(tiff.u32(ifd + 2 + qint64(count) * 12)); // 次の IFD
+        isFirstIfd = false;
+    }
+
+    // 3. 長辺が minEdge 以上で最小のものを選ぶ (ヘッダだけ読む)
+    int bestIndex = -1;
+    QSize bestSize;
+    for (int i = 0; i < candidates.size(); ++i) {
+        QByteArray bytes = QByteArray::fromRawData(reinterpret_cast<const char *>(map + candidates[i].offset), candidates[i].length);
+        QBuffer buffer(&bytes);
+        buffer.open(QIODevice::ReadOnly);
+        QImageReader reader(&buffer, "jpeg");
+        const QSize size = reader.size();
+        if (!size.isValid() || qMax(size.width(), size.height()) < minEdge) continue;
+        if (bestIndex < 0 || qint64(size.width()) * size.height() < qint64(bestSize.width()) * bestSize.height()) {
+            bestIndex = i;
+            bestSize = size;
+        }
+    }
+
+    QImage image;
+    if (bestIndex >= 0) {
+        QByteArray bytes = QByteArray::fromRawData(reinterpret_cast<const char *>(map + candidates[bestIndex].offset),
+                                                   candidates[bestIndex].length);
+        QBuffer buffer(&bytes);
+        buffer.open(QIODevice::ReadOnly);
+        QImageReader reader(&buffer, "jpeg");
+        reader.setAutoTransform(false); // 向きは本体の値で合わせる
+        if (scaledSize.isValid() && (bestSize.width() > scaledSize.width() || bestSize.height() > scaledSize.height())) {
+            reader.setScaledSize(bestSize.scaled(scaledSize, Qt::KeepAspectRatio));
+        }
+        image = reader.read();
+    }
+
+    file.unmap(map);
+    return image.isNull() ? QImage() : applyOrientation(image, orientation);
+}
+
+QImage ExifPreview::applyOrientation(const QImage &image, int orientation)
+{
+    // EXIF Orientation (1: そのまま)
+    switch (orientation) {
+    case 2: return image.mirrored(true, false);
+    case 3: return image.transformed(QTransform().rotate(180));
+    case 4: return image.mirrored(false, true);
+    case 5: return image.mirrored(true, false).transformed(QTransform().rotate(270));
+    case 6: return image.transformed(QTransform().rotate(90));
+    case 7: return image.mirrored(true, false).transformed(QTransform().rotate(90));
+    case 8: return image.transformed(QTransform().rotate(270));
+    default: return image;
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef EXIFPREVIEW_H
+#define EXIFPREVIEW_H
+
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+// 埋め込みプレビューの取り出し
+// - JPEG の EXIF (APP1) サムネイル、TIFF ベースの RAW (CR2/NEF/ARW/DNG など) のプレビュー JPEG を探す
+// - 本体をデコードせずに済むので、サムネイルや表示開始直後の仮表示に使う
+// - 向き (Orientation) は本体の IFD0 の値を適用して返す
+// ※ スレッドセーフ (状態を持たない)
+class ExifPreview
+{
+public:
+    // 長辺が minEdge 以上のプレビューのうち最小のものをデコードして返す (なければ null)
+    // scaledSize が有効なら、そのサイズに収まるよう縮小しながらデコードする
+    static QImage read(const QString &filePath, int minEdge, const QSize &scaledSize = QSize());
+
+private:
+    static QImage applyOrientation(const QImage &image, int orientation);
+
+    static const int MAX_IFD_COUNT = 32; // 壊れたファイルで巡回しないための上限
+};
+
+#endif // EXIFPREVIEW_H
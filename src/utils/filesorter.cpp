@@ -0,0 +1,131 @@
+#include "filesorter.h"
+#include <QDateTime>
+#include <QRandomGenerator>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+namespace {
+
+// ソート用に前計算した要素
+struct SortEntry {
+    QFileInfo info;
+    std::optional<QCollatorSortKey> nameKey; // SortName のみ
+    qint64 value = 0;                        // SortDate: 更新日時(ms) / SortSize: バイト数
+};
+
+bool entryLessThan(const SortEntry &a, const SortEntry &b, SortMode mode, bool ascending)
+{
+    const SortEntry &l = ascending ? a : b;
+    const SortEntry &r = ascending ? b : a;
+    if (mode == SortName) return l.nameKey->compare(*r.nameKey) < 0;
+    return l.value < r.value;
+}
+
+// [begin, end) の要素からキーを作ってソートする (チャンク単位でワーカーから呼ばれる)
+std::vector<SortEntry> buildSortedChunk(const QFileInfoList &list, int begin, int end, SortMode mode, bool ascending)
+{
+    // QCollator はスレッド間で共有できないので、チャンクごとに作る
+    const QCollator collator = FileSorter::createCollator();
+
+    std::vector<SortEntry> entries;
+    entries.reserve(end - begin);
+    for (int i = begin; i < end; ++i) {
+        SortEntry entry;
+        entry.info = list.at(i);
+        switch (mode) {
+        case SortName:
+            entry.nameKey = collator.sortKey(entry.info.fileName());
+            break;
+        case SortDate:
+            entry.value = entry.info.lastModified().toMSecsSinceEpoch();
+            break;
+        case SortSize:
+            entry.value = entry.info.size();
+            break;
+        default:
+            break;
+        }
+        entries.push_back(std::move(entry));
+    }
+
+    std::sort(entries.begin(), entries.end(), [mode, ascending](const SortEntry &a, const SortEntry &b) {
+        return entryLessThan(a, b, mode, ascending);
+    });
+    return entries;
+}
+
+} // namespace
+
+QCollator FileSorter::createCollator()
+{
+    QCollator collator;
+    collator.setNumericMode(true);
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+    return collator;
+}
+
+void FileSorter::sort(QFileInfoList &list, SortMode mode, bool ascending)
+{
+    if (list.size() < 2) return;
+
+    if (mode == SortShuffle) {
+        // Fisher-Yates (偏りのないシャッフル)。昇順・降順は無視
+        std::shuffle(list.begin(), list.end(), *QRandomGenerator::global());
+        return;
+    }
+
+    const int count = list.size();
+    const int threads = qMax(1, QThread::idealThreadCount());
+    const int chunkCount = (count < PARALLEL_THRESHOLD) ? 1 : qMin(threads, count / (PARALLEL_THRESHOLD / 2));
+
+    std::vector<std::vector<SortEntry>> chunks(chunkCount);
+    if (chunkCount == 1) {
+        chunks[0] = buildSortedChunk(list, 0, count, mode, ascending);
+    } else {
+        // チャンクごとにキー生成 + ソートを並列実行
+        QList<int> chunkIndexes;
+        for (int c = 0; c < chunkCount; ++c) chunkIndexes << c;
+        QtConcurrent::blockingMap(chunkIndexes, [&](int c) {
+            const int begin = int(qint64(count) * c / chunkCount);
+            const int end = int(qint64(count) * (c + 1) / chunkCount);
+            chunks[c] = buildSortedChunk(list, begin, end, mode, ascending);
+        });
+    }
+
+    // ソート済みチャンクを順にマージ
+    std::vector<SortEntry> merged = std::move(chunks[0]);
+    merged.reserve(count);
+    for (int c = 1; c < chunkCount; ++c) {
+        const auto middle = merged.size();
+        std::move(chunks[c].begin(), chunks[c].end(), std::back_inserter(merged));
+        std::inplace_merge(merged.begin(), merged.begin() + middle, merged.end(),
+                           [mode, ascending](const SortEntry &a, const SortEntry &b) {
+                               return entryLessThan(a, b, mode, ascending);
+                           });
+    }
+
+    for (int i = 0; i < count; ++i) {
+        list[i] = std::move(merged[i].info);
+    }
+}
+
+bool FileSorter::lessThan(const QFileInfo &a, const QFileInfo &b, SortMode mode, bool ascending, const QCollator &collator)
+{
+    const QFileInfo &l = ascending ? a : b;
+    const QFileInfo &r = ascending ? b : a;
+    switch (mode) {
+    case SortName:
+        // QCollator で "1.jpg, 2.jpg, 10.jpg" の順序を実現
+        return collator.compare(l.fileName(), r.fileName()) < 0;
+    case SortDate:
+        return l.lastModified() < r.lastModified();
+    case SortSize:
+        return l.size() < r.size();
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef FILESORTER_H
+#define FILESORTER_H
+
+#include <QCollator>
+#include <QFileInfo>
+
+#include "common_types.h"
+
+// ファイル一覧のソート (本棚とビューワーで共通)
+// - 名前順は QCollatorSortKey を要素ごとに一度だけ作り、比較はキー同士で行う
+// - 日付・サイズは要素ごとに一度だけ取得しておく
+// - 要素数が多い場合はチャンクごとに並列ソートしてからマージする
+class FileSorter
+{
+public:
+    // 数値考慮・大文字小文字無視の QCollator を作る
+    static QCollator createCollator();
+
+    static void sort(QFileInfoList &list, SortMode mode, bool ascending);
+
+    // 単発比較用 (差分挿入の二分探索など)。collator は呼び出し側のスレッドのものを渡すこと
+    static bool lessThan(const QFileInfo &a, const QFileInfo &b, SortMode mode, bool ascending, const QCollator &collator);
+
+private:
+    static const int PARALLEL_THRESHOLD = 4096; // これ未満は単一スレッドでソート
+};
+
+#endif // FILESORTER_H
@@ -0,0 +1,126 @@
+#include "gainkernels.h"
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GAINKERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+// S32 を float で扱うときの範囲 (2^31 - 1 は float で表せないので、その手前の値で抑える)
+const float S32_MAX_AS_FLOAT = 2147483520.0f;
+const float S32_MIN_AS_FLOAT = -2147483648.0f;
+
+inline float rampStep(int frames, float gainFrom, float gainTo)
+{
+    return frames > 0 ? (gainTo - gainFrom) / frames : 0.0f;
+}
+
+// i 番目のサンプルのゲイン (SIMD 側も同じ式で計算するので、位置によって結果が変わらない)
+inline float sampleGain(int i, int channels, float gainFrom, float step)
+{
+    return gainFrom + step * float(i / channels);
+}
+
+#ifdef GAINKERNELS_SSE2
+// first から4サンプル分の、フレーム番号の差 (first はフレームの区切り)
+inline __m128 frameOffsets(int first, int channels)
+{
+    return _mm_setr_ps(float(first / channels), float((first + 1) / channels),
+                       float((first + 2) / channels), float((first + 3) / channels));
+}
+
+inline __m128 laneGains(int i, int channels, __m128 offsets, __m128 gainFrom, __m128 step)
+{
+    const __m128 frame = _mm_add_ps(_mm_set1_ps(float(i / channels)), offsets);
+    return _mm_add_ps(gainFrom, _mm_mul_ps(step, frame));
+}
+#endif
+}
+
+void GainKernels::applyS16(qint16 *samples, int count, int channels, float gainFrom, float gainTo)
+{
+    channels = qMax(1, channels);
+    const float step = rampStep(count / channels, gainFrom, gainTo);
+    int i = 0;
+
+#ifdef GAINKERNELS_SSE2
+    // 8サンプルずつ: 32bit に符号拡張 -> float で乗算 -> 丸めて飽和パックで 16bit に戻す
+    // (8サンプルがフレームの区切りに揃うチャンネル数のときだけ)
+    if (8 % channels == 0) {
+        const __m128 offsetsLo = frameOffsets(0, channels);
+        const __m128 offsetsHi = frameOffsets(4, channels);
+        const __m128 from = _mm_set1_ps(gainFrom);
+        const __m128 stepVec = _mm_set1_ps(step);
+        for (; i + 8 <= count; i += 8) {
+            const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i));
+            const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16);
+            const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16);
+            const __m128 gainLo = laneGains(i, channels, offsetsLo, from, stepVec);
+            const __m128 gainHi = laneGains(i, channels, offsetsHi, from, stepVec);
+            const __m128i scaledLo = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(lo), gainLo));
+            const __m128i scaledHi = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(hi), gainHi));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(samples + i), _mm_packs_epi32(scaledLo, scaledHi));
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        const float value = samples[i] * sampleGain(i, channels, gainFrom, step);
+        samples[i] = qint16(std::lrint(qBound(-32768.0f, value, 32767.0f)));
+    }
+}
+
+void GainKernels::applyS32(qint32 *samples, int count, int channels, float gainFrom, float gainTo)
+{
+    channels = qMax(1, channels);
+    const float step = rampStep(count / channels, gainFrom, gainTo);
+    int i = 0;
+
+#ifdef GAINKERNELS_SSE2
+    // 範囲外の float -> int 変換は 0x80000000 になるので、変換前に抑える
+    if (4 % channels == 0) {
+        const __m128 offsets = frameOffsets(0, channels);
+        const __m128 from = _mm_set1_ps(gainFrom);
+        const __m128 stepVec = _mm_set1_ps(step);
+        const __m128 upper = _mm_set1_ps(S32_MAX_AS_FLOAT);
+        const __m128 lower = _mm_set1_ps(S32_MIN_AS_FLOAT);
+        for (; i + 4 <= count; i += 4) {
+            const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i));
+            __m128 value = _mm_mul_ps(_mm_cvtepi32_ps(in), laneGains(i, channels, offsets, from, stepVec));
+            value = _mm_max_ps(_mm_min_ps(value, upper), lower);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(samples + i), _mm_cvtps_epi32(value));
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        const float value = samples[i] * sampleGain(i, channels, gainFrom, step);
+        samples[i] = qint32(std::lrint(qBound(S32_MIN_AS_FLOAT, value, S32_MAX_AS_FLOAT)));
+    }
+}
+
+void GainKernels::applyF32(float *samples, int count, int channels, float gainFrom, float gainTo)
+{
+    channels = qMax(1, channels);
+    const float step = rampStep(count / channels, gainFrom, gainTo);
+    int i = 0;
+
+#ifdef GAINKERNELS_SSE2
+    if (4 % channels == 0) {
+        const __m128 offsets = frameOffsets(0, channels);
+        const __m128 from = _mm_set1_ps(gainFrom);
+        const __m128 stepVec = _mm_set1_ps(step);
+        const __m128 upper = _mm_set1_ps(1.0f);
+        const __m128 lower = _mm_set1_ps(-1.0f);
+        for (; i + 4 <= count; i += 4) {
+            const __m128 value = _mm_mul_ps(_mm_loadu_ps(samples + i), laneGains(i, channels, offsets, from, stepVec));
+            _mm_storeu_ps(samples + i, _mm_max_ps(_mm_min_ps(value, upper), lower));
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        samples[i] = qBound(-1.0f, samples[i] * sampleGain(i, channels, gainFrom, step), 1.0f);
+    }
+}
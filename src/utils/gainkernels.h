@@ -0,0 +1,21 @@
+#ifndef GAINKERNELS_H
+#define GAINKERNELS_H
+
+#include <QtGlobal>
+
+// ポストミックスのゲイン処理 (S16 / S32 / F32)
+// - バッファの先頭の gainFrom から末尾の gainTo へ直線で変化させる (音量変更・ミュートでクリックが出ない)
+// - ゲインはフレーム (全チャンネルの1サンプル) ごとに進めるので、同じフレームの左右には同じゲインが掛かる
+// - 整数形式は四捨五入 (偶数丸め) してから飽和させる (F32 は -1.0 〜 1.0 に収める)
+// - SSE2 が使える環境では4〜8サンプルずつまとめて処理し、端数はスカラーで処理する (結果は同じ)
+// ※ 状態を持たないので、オーディオスレッドから直接呼んでよい
+class GainKernels
+{
+public:
+    // count はサンプル数 (フレーム数 × channels)
+    static void applyS16(qint16 *samples, int count, int channels, float gainFrom, float gainTo);
+    static void applyS32(qint32 *samples, int count, int channels, float gainFrom, float gainTo);
+    static void applyF32(float *samples, int count, int channels, float gainFrom, float gainTo);
+};
+
+#endif // GAINKERNELS_H
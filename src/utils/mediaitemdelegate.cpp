@@ -2,6 +2,7 @@
 #include <QPainter>
 #include <QApplication>
 #include <QStyle>
+#include <QTime>
 
 MediaItemDelegate::MediaItemDelegate(QObject *parent)
     : QStyledItemDelegate(parent)
@@ -95,6 +96,33 @@ void MediaItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &opt
     opt.state &= ~QStyle::State_Selected;
     opt.state &= ~QStyle::State_MouseOver;
 
+    // 再生時間があれば右端に描き、その分だけ本文の幅を詰める
+    const qint64 durationMs = index.data(DurationRole).toLongLong();
+    if (durationMs > 0) {
+        const QTime t = QTime(0, 0).addMSecs(durationMs);
+        const QString durationText = t.toString(durationMs >= 3600000 ? "h:mm:ss" : "m:ss");
+        const QFontMetrics metrics(painter->font());
+        QRect durationRect = opt.rect.adjusted(0, 0, -4, 0);
+        durationRect.setLeft(durationRect.right() - metrics.horizontalAdvance(durationText));
+
+        painter->setPen(textColor);
+        painter->drawText(durationRect, Qt::AlignRight | Qt::AlignVCenter, durationText);
+        opt.rect.setRight(durationRect.left() - 8);
+    }
+
+    // サムネイルがあれば左端に描き、その分だけ本文を右へ寄せる (行の高さは変えない)
+    if (m_thumbnailLookup) {
+        const QImage thumbnail = m_thumbnailLookup(index.data(Qt::ToolTipRole).toString());
+        if (!thumbnail.isNull()) {
+            const int height = qMax(1, opt.rect.height() - 2);
+            QRect thumbnailRect(QPoint(0, 0), thumbnail.size().scaled(height * 16 / 9, height, Qt::KeepAspectRatio));
+            thumbnailRect.moveCenter(QPoint(opt.rect.left() + 2 + thumbnailRect.width() / 2, opt.rect.center().y()));
+            painter->setRenderHint(QPainter::SmoothPixmapTransform);
+            painter->drawImage(thumbnailRect, thumbnail);
+            opt.rect.setLeft(thumbnailRect.right() + 5);
+        }
+    }
+
     // 標準描画 (テキストやアイコン)
     QStyle* style = opt.widget ? opt.widget->style() : QApplication::style();
     style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, opt.widget);
@@ -1,7 +1,9 @@
 #ifndef MEDIAITEMDELEGATE_H
 #define MEDIAITEMDELEGATE_H
 
+#include <QImage>
 #include <QStyledItemDelegate>
+#include <functional>
 
 class MediaItemDelegate : public QStyledItemDelegate
 {
@@ -10,10 +12,18 @@ class MediaItemDelegate : public QStyledItemDelegate
 public:
     // 「再生中/表示中」状態を保存するためのカスタムデータロール
     static const int IsActiveRole = Qt::UserRole + 10;
+    // 行の右端に表示する再生時間 (ms, 不明なら設定しない)
+    static const int DurationRole = Qt::UserRole + 11;
 
     explicit MediaItemDelegate(QObject *parent = nullptr);
 
     void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+    // 行の左端に描くサムネイル (動画の表紙など) を引く関数。引数は ToolTip のフルパス、なければ null を返す
+    void setThumbnailLookup(const std::function<QImage(const QString &)> &lookup) { m_thumbnailLookup = lookup; }
+
+private:
+    std::function<QImage(const QString &)> m_thumbnailLookup;
 };
 
 #endif // MEDIAITEMDELEGATE_H
@@ -0,0 +1,113 @@
+#include "sdlfilestream.h"
+#include <QDebug>
+#include <QFile>
+#include <cstring>
+
+namespace {
+struct StreamState {
+    QFile file;
+    qint64 startOffset = 0; // 見せるファイルの先頭 (実際のファイルでの位置)
+    QByteArray head;        // 見せるファイルの先頭から、ファイルの代わりに読ませるバイト列
+};
+
+StreamState *stateOf(SDL_RWops *context)
+{
+    return static_cast<StreamState *>(context->hidden.unknown.data1);
+}
+}
+
+SDL_RWops *SdlFileStream::open(const QString &filePath, qint64 startOffset, const QByteArray &head)
+{
+    StreamState *state = new StreamState;
+    state->file.setFileName(filePath);
+    // バッファ付きで開く (デコーダの細かい読み込みをまとめる)
+    if (!state->file.open(QIODevice::ReadOnly)) {
+        qDebug() << "SdlFileStream: failed to open" << filePath << state->file.errorString();
+        delete state;
+        return nullptr;
+    }
+    state->startOffset = qBound<qint64>(0, startOffset, state->file.size());
+    state->head = head.left(int(qMin<qint64>(head.size(), state->file.size() - state->startOffset)));
+    if (!state->file.seek(state->startOffset)) {
+        delete state;
+        return nullptr;
+    }
+
+    SDL_RWops *rw = SDL_AllocRW();
+    if (!rw) {
+        delete state;
+        return nullptr;
+    }
+    rw->type = SDL_RWOPS_UNKNOWN;
+    rw->size = &SdlFileStream::size;
+    rw->seek = &SdlFileStream::seek;
+    rw->read = &SdlFileStream::read;
+    rw->write = &SdlFileStream::write;
+    rw->close = &SdlFileStream::close;
+    rw->hidden.unknown.data1 = state;
+    return rw;
+}
+
+Sint64 SdlFileStream::size(SDL_RWops *context)
+{
+    StreamState *s = stateOf(context);
+    return s->file.size() - s->startOffset;
+}
+
+Sint64 SdlFileStream::seek(SDL_RWops *context, Sint64 offset, int whence)
+{
+    StreamState *s = stateOf(context);
+    qint64 target = offset;
+    switch (whence) {
+    case RW_SEEK_SET: break;
+    case RW_SEEK_CUR: target += s->file.pos() - s->startOffset; break;
+    case RW_SEEK_END: target += s->file.size() - s->startOffset; break;
+    default: return SDL_SetError("SdlFileStream: unknown whence %d", whence);
+    }
+    if (target < 0 || !s->file.seek(s->startOffset + target)) return SDL_SetError("SdlFileStream: seek failed");
+    return s->file.pos() - s->startOffset;
+}
+
+size_t SdlFileStream::read(SDL_RWops *context, void *ptr, size_t size, size_t maxnum)
+{
+    if (size == 0 || maxnum == 0) return 0;
+
+    StreamState *s = stateOf(context);
+    QFile &file = s->file;
+    const qint64 wanted = qint64(size * maxnum);
+    qint64 got = 0;
+
+    // 置き換えた範囲は head から読み、ファイルの位置も同じだけ進める (位置は常にファイルで持つ)
+    const qint64 pos = file.pos() - s->startOffset;
+    if (pos < s->head.size()) {
+        got = qMin<qint64>(wanted, s->head.size() - pos);
+        std::memcpy(ptr, s->head.constData() + pos, size_t(got));
+        file.seek(file.pos() + got);
+    }
+    if (got < wanted) {
+        const qint64 rest = file.read(static_cast<char *>(ptr) + got, wanted - got);
+        if (rest < 0) {
+            SDL_SetError("SdlFileStream: read failed");
+            return 0;
+        }
+        got += rest;
+    }
+    // 端数のオブジェクトは読まなかったことにする (SDL の規約)
+    const qint64 partial = got % qint64(size);
+    if (partial) file.seek(file.pos() - partial);
+    return size_t(got / qint64(size));
+}
+
+size_t SdlFileStream::write(SDL_RWops *, const void *, size_t, size_t)
+{
+    SDL_SetError("SdlFileStream: read only");
+    return 0;
+}
+
+int SdlFileStream::close(SDL_RWops *context)
+{
+    if (!context) return 0;
+    delete stateOf(context);
+    SDL_FreeRW(context);
+    return 0;
+}
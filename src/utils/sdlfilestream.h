@@ -0,0 +1,28 @@
+#ifndef SDLFILESTREAM_H
+#define SDLFILESTREAM_H
+
+#include <QByteArray>
+#include <QString>
+#include <SDL.h>
+
+// ファイルを少しずつ読む SDL_RWops
+// - 曲全体をメモリに読み込まないので、巨大なファイルでも再生開始が速くメモリも増えない
+// - QFile を使うので、SDL_RWFromFile と違い Windows の Unicode パスもそのまま扱える
+// - 読み込みは SDL のオーディオスレッドから呼ばれる (同時に別スレッドから触らないこと)
+// - startOffset を渡すと、その位置から始まるファイルとして見せる (MP3 を途中のフレームから開く用)
+// - head を渡すと、見せるファイルの先頭をそのバイト列に置き換える (書き換えた MP3 のフレームを読ませる用)
+class SdlFileStream
+{
+public:
+    // 開けなければ nullptr。Mix_LoadMUS_RW(rw, 1) などで渡せば close 時に解放される
+    static SDL_RWops *open(const QString &filePath, qint64 startOffset = 0, const QByteArray &head = QByteArray());
+
+private:
+    static Sint64 size(SDL_RWops *context);
+    static Sint64 seek(SDL_RWops *context, Sint64 offset, int whence);
+    static size_t read(SDL_RWops *context, void *ptr, size_t size, size_t maxnum);
+    static size_t write(SDL_RWops *context, const void *ptr, size_t size, size_t num);
+    static int close(SDL_RWops *context);
+};
+
+#endif // SDLFILESTREAM_H